@@ -69,6 +69,7 @@ config_pri_source_group1 {
         $$quote($$BASEDIR/src/activeFrameQML.cpp) \
         $$quote($$BASEDIR/src/bbm/BBMHandler.cpp) \
         $$quote($$BASEDIR/src/main.cpp) \
+        $$quote($$BASEDIR/src/netimageindex.cpp) \
         $$quote($$BASEDIR/src/netimagemanager.cpp) \
         $$quote($$BASEDIR/src/netimagetracker.cpp) \
         $$quote($$BASEDIR/src/tldrapp.cpp)
@@ -76,6 +77,7 @@ config_pri_source_group1 {
     HEADERS += \
         $$quote($$BASEDIR/src/activeFrameQML.h) \
         $$quote($$BASEDIR/src/bbm/BBMHandler.hpp) \
+        $$quote($$BASEDIR/src/netimageindex.h) \
         $$quote($$BASEDIR/src/netimagemanager.h) \
         $$quote($$BASEDIR/src/netimagetracker.h) \
         $$quote($$BASEDIR/src/tldrapp.h)
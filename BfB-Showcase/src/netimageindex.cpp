@@ -0,0 +1,221 @@
+/* Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "netimageindex.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QWeakPointer>
+
+const char* const NetImageIndex::mIndexFileName = "index";
+
+// Identifies the index file and its format version
+static const quint32 IndexMagic = 0x4e494458; // "NIDX"
+static const quint32 IndexVersion = 1;
+
+// The time to wait after a change before the index file is written, so that
+// a page full of downloaded images only writes the file once
+static const int SaveDelay = 2000;
+
+QSharedPointer<NetImageIndex> NetImageIndex::forFolder(const QString &path)
+{
+    static QHash<QString, QWeakPointer<NetImageIndex> > indexes;
+
+    QSharedPointer<NetImageIndex> index = indexes.value(path).toStrongRef();
+    if (index.isNull()) {
+        index = QSharedPointer<NetImageIndex>(new NetImageIndex(path));
+        indexes.insert(path, index);
+    }
+    return index;
+}
+
+NetImageIndex::NetImageIndex(const QString &path) :
+        mPath(path), mBytes(0), mDirty(false)
+{
+    mSaveTimer.setSingleShot(true);
+    mSaveTimer.setInterval(SaveDelay);
+    connect(&mSaveTimer, SIGNAL(timeout()), this, SLOT(save()));
+
+    if (!load()) {
+        rebuild();
+    }
+}
+
+NetImageIndex::~NetImageIndex()
+{
+    save();
+}
+
+bool NetImageIndex::contains(const QString &fileName) const
+{
+    return mEntries.contains(fileName);
+}
+
+void NetImageIndex::touch(const QString &fileName)
+{
+    QHash<QString, Entry>::iterator entry = mEntries.find(fileName);
+    if (entry != mEntries.end()) {
+        mOrder.erase(entry->position);
+        entry->position = mOrder.insert(mOrder.end(), fileName);
+        entry->accessTime = QDateTime::currentMSecsSinceEpoch();
+        changed();
+    }
+}
+
+void NetImageIndex::insert(const QString &fileName, qint64 size)
+{
+    remove(fileName);
+
+    Entry entry;
+    entry.size = size;
+    entry.accessTime = QDateTime::currentMSecsSinceEpoch();
+    entry.position = mOrder.insert(mOrder.end(), fileName);
+    mEntries.insert(fileName, entry);
+    mBytes += size;
+    changed();
+}
+
+void NetImageIndex::remove(const QString &fileName)
+{
+    QHash<QString, Entry>::iterator entry = mEntries.find(fileName);
+    if (entry != mEntries.end()) {
+        mBytes -= entry->size;
+        mOrder.erase(entry->position);
+        mEntries.erase(entry);
+        changed();
+    }
+}
+
+void NetImageIndex::evict(int maxFiles, qint64 maxBytes)
+{
+    while (mOrder.size() > 1
+            && ((maxFiles > 0 && mEntries.count() > maxFiles) || (maxBytes > 0 && mBytes > maxBytes))) {
+        // The least recently used file is first in the list.
+        const QString fileName = mOrder.first();
+        QFile::remove(mPath + "/" + fileName);
+        remove(fileName);
+    }
+}
+
+int NetImageIndex::count() const
+{
+    return mEntries.count();
+}
+
+qint64 NetImageIndex::bytes() const
+{
+    return mBytes;
+}
+
+void NetImageIndex::changed()
+{
+    mDirty = true;
+    if (!mSaveTimer.isActive()) {
+        mSaveTimer.start();
+    }
+}
+
+void NetImageIndex::save()
+{
+    if (!mDirty) {
+        return;
+    }
+    mSaveTimer.stop();
+    mDirty = false;
+
+    // Write to a temporary file first so that a crash never leaves a broken index.
+    const QString indexPath = mPath + "/" + mIndexFileName;
+    QFile file(indexPath + ".tmp");
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write the image cache index" << file.fileName();
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << IndexMagic << IndexVersion << qint32(mEntries.count());
+
+    // The entries are written in least recently used order, so the order is restored on load.
+    QLinkedList<QString>::const_iterator it = mOrder.constBegin();
+    for (; it != mOrder.constEnd(); ++it) {
+        const Entry &entry = mEntries[*it];
+        stream << *it << entry.size << entry.accessTime;
+    }
+    file.close();
+
+    QFile::remove(indexPath);
+    file.rename(indexPath);
+}
+
+bool NetImageIndex::load()
+{
+    QFile file(mPath + "/" + mIndexFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    qint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != IndexMagic || version != IndexVersion || count < 0) {
+        return false;
+    }
+
+    for (int i = 0; i < count; i++) {
+        QString fileName;
+        Entry entry;
+        stream >> fileName >> entry.size >> entry.accessTime;
+        if (stream.status() != QDataStream::Ok) {
+            mEntries.clear();
+            mOrder.clear();
+            mBytes = 0;
+            return false;
+        }
+        entry.position = mOrder.insert(mOrder.end(), fileName);
+        mEntries.insert(fileName, entry);
+        mBytes += entry.size;
+    }
+    return true;
+}
+
+void NetImageIndex::rebuild()
+{
+    // The oldest file first, the same order as the least recently used list.
+    QDir directory(mPath);
+    const QFileInfoList list = directory.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+
+    for (int i = 0; i < list.size(); i++) {
+        const QFileInfo &info = list.at(i);
+        if (info.fileName().startsWith(mIndexFileName) || info.suffix() == "part") {
+            continue;
+        }
+        Entry entry;
+        entry.size = info.size();
+        entry.accessTime = info.lastModified().toMSecsSinceEpoch();
+        entry.position = mOrder.insert(mOrder.end(), info.fileName());
+        mEntries.insert(info.fileName(), entry);
+        mBytes += entry.size;
+    }
+
+    if (!mEntries.isEmpty()) {
+        changed();
+    }
+}
@@ -0,0 +1,123 @@
+/* Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef _NETIMAGEINDEX_H_
+#define _NETIMAGEINDEX_H_
+
+#include <QObject>
+#include <QHash>
+#include <QLinkedList>
+#include <QSharedPointer>
+#include <QTimer>
+
+/**
+ * NetImageIndex keeps track of the files in an image cache folder, with their
+ * sizes and the time they were last used, in least recently used order.
+ *
+ * Looking up, using and adding a file and evicting the least recently used
+ * file are all constant time operations, so the cache folder never has to be
+ * listed. The index is stored in a file in the cache folder, it is written
+ * shortly after a change and when the index is destroyed.
+ *
+ * There is one index per cache folder, shared by all NetImageManagers that
+ * use the same cacheId.
+ */
+class NetImageIndex: public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Returns the index of the cache folder, it is loaded if no manager uses it yet.
+     *
+     * @param path The path to the cache folder.
+     */
+    static QSharedPointer<NetImageIndex> forFolder(const QString &path);
+
+    ~NetImageIndex();
+
+    /**
+     * Check if the file is in the cache.
+     */
+    bool contains(const QString &fileName) const;
+
+    /**
+     * Marks the file as the most recently used one.
+     */
+    void touch(const QString &fileName);
+
+    /**
+     * Adds a file that has been written to the cache folder, or updates its size.
+     */
+    void insert(const QString &fileName, qint64 size);
+
+    /**
+     * Removes a file from the index, e.g. when it has been deleted.
+     */
+    void remove(const QString &fileName);
+
+    /**
+     * Deletes the least recently used files until there are at most maxFiles
+     * files using at most maxBytes bytes. A limit of 0 or less is not checked.
+     * The most recently used file is always kept, even if it is larger than maxBytes.
+     */
+    void evict(int maxFiles, qint64 maxBytes);
+
+    /**
+     * The number of files and the total number of bytes in the cache.
+     */
+    int count() const;
+    qint64 bytes() const;
+
+public slots:
+    /**
+     * Writes the index file if the index has changed.
+     */
+    void save();
+
+private:
+    NetImageIndex(const QString &path);
+
+    // Reads the index file, returns false if there is no valid index file
+    bool load();
+
+    // Builds the index from the files in the cache folder, for folders without an index file
+    void rebuild();
+
+    void changed();
+
+    struct Entry
+    {
+        qint64 size;
+        qint64 accessTime;
+        QLinkedList<QString>::iterator position;
+    };
+
+    QString mPath;
+    QHash<QString, Entry> mEntries;
+
+    // The file names from the least to the most recently used one
+    QLinkedList<QString> mOrder;
+
+    qint64 mBytes;
+
+    // Set when the index has changed since it was last written
+    bool mDirty;
+    QTimer mSaveTimer;
+
+    // The name of the index file in the cache folder
+    static const char* const mIndexFileName;
+};
+
+#endif // ifndef _NETIMAGEINDEX_H_
@@ -18,7 +18,10 @@
 #include <QtNetwork/QNetworkAccessManager>
 #include <QtNetwork/QNetworkRequest>
 
+#include <QBuffer>
 #include <QDir>
+#include <QFileInfo>
+#include <QImageReader>
 
 using namespace bb::cascades;
 
@@ -29,6 +32,12 @@ NetImageManager::NetImageManager(QObject *parent) :
 		QObject(parent) {
 	mCacheId = mDefaultId;
 	mCacheSize = 125;
+	mCacheBytes = 8 * 1024 * 1024;
+	mMaxDownloads = 4;
+	mHits = 0;
+	mMisses = 0;
+	mCompletedDownloads = 0;
+	mTotalLatency = 0;
 
 	QString diskPath = QDir::homePath() + "/" + mCacheId;
 
@@ -36,6 +45,8 @@ NetImageManager::NetImageManager(QObject *parent) :
 		QDir().mkdir(diskPath);
 	}
 
+	mIndex = NetImageIndex::forFolder(diskPath);
+
 	// Connect to the sslErrors signal to the onSslErrors() function. This will help us see what errors
 	// we get when connecting to the address given by mWeatherAdress.
 	connect(&mAccessManager,
@@ -51,31 +62,58 @@ NetImageManager::NetImageManager(QObject *parent) :
 NetImageManager::~NetImageManager() {
 }
 
+QString NetImageManager::cacheFileName(const QUrl &url) {
+	// The qHash is a bucket type hash so the doubling is to remove possible collisions.
+	// The downloaded bytes are stored as they are, so the file keeps the suffix of the url.
+	QString suffix = QFileInfo(url.path()).suffix();
+	if (suffix.isEmpty() || suffix.length() > 4) {
+		suffix = "JPG";
+	}
+	return QString::number(qHash(url.host())) + "_"
+			+ QString::number(qHash(url.path())) + "." + suffix;
+}
+
 void NetImageManager::lookUpImage(const QString imageName) {
 	QUrl url = QUrl(imageName);
 	// Check if image is stored on disc
-	// The qHash is a bucket type hash so the doubling is to remove possible collisions.
-	QString diskPath = QDir::homePath() + "/" + mCacheId + "/"
-			+ QString::number(qHash(url.host())) + "_"
-			+ QString::number(qHash(url.path())) + ".JPG";
+	const QString fileName = cacheFileName(url);
+	QString diskPath = QDir::homePath() + "/" + mCacheId + "/" + fileName;
+
+	// If the file is in the cache, send a signal the image is ready
+	if (mIndex->contains(fileName)) {
+		if (QFile::exists(diskPath)) {
+			mIndex->touch(fileName);
+			mHits++;
+			emit statisticsChanged();
+			emit imageReady(diskPath, url.toString());
+			return;
+		}
 
-	QFile imageFile(diskPath);
+		// The file has been removed from the folder, download it again.
+		mIndex->remove(fileName);
+	}
 
-	// If the file exists, send a signal the image is ready
-	if (imageFile.exists()) {
-		emit imageReady(diskPath, url.toString());
-	} else {
-		// otherwise let's download the file, but first we show a loading image
-		emit imageReady(imageName, "loading");
+	mMisses++;
+	emit statisticsChanged();
 
-		QNetworkRequest request(url);
-		if (mQueue.isEmpty()) {
-			mAccessManager.get(request);
-		}
+	// otherwise let's download the file, but first we show a loading image
+	emit imageReady(imageName, "loading");
 
-		mQueue.append(request);
+	// If the image is already queued or downloading, the imageReady signal
+	// for that download will reach this request as well.
+	if (!mRequested.contains(url.toString())) {
+		mRequested.insert(url.toString());
+		mQueue.append(url);
+		startDownloads();
 	}
+}
 
+void NetImageManager::startDownloads() {
+	while (mDownloads.count() < mMaxDownloads && !mQueue.isEmpty()) {
+		QNetworkRequest request(mQueue.takeFirst());
+		QNetworkReply *reply = mAccessManager.get(request);
+		mDownloads[reply].start();
+	}
 }
 
 void NetImageManager::setCacheId(QString cacheId) {
@@ -88,6 +126,8 @@ void NetImageManager::setCacheId(QString cacheId) {
 			QDir().mkdir(diskPath);
 		}
 
+		mIndex = NetImageIndex::forFolder(diskPath);
+
 		emit cacheIdChanged(mCacheId);
 	}
 	houseKeep();
@@ -109,55 +149,110 @@ int NetImageManager::cacheSize() {
 	return mCacheSize;
 }
 
-void NetImageManager::houseKeep() {
-	QString diskPath = QDir::homePath() + "/" + mCacheId + "/";
+void NetImageManager::setCacheBytes(int cacheBytes) {
+	if (mCacheBytes != cacheBytes) {
+		mCacheBytes = cacheBytes;
+		emit cacheBytesChanged(mCacheBytes);
+	}
+	houseKeep();
+}
 
-	QDir directory(diskPath);
+int NetImageManager::cacheBytes() {
+	return mCacheBytes;
+}
 
-	if (directory.count() > (uint) mCacheSize) {
-		//Find the oldest file and delete it.
-		QFileInfoList list = directory.entryInfoList(QDir::Files, QDir::Time);
-		QFile::remove(list.at(list.size() - 1).absoluteFilePath());
-		//maybe there are more then the permitted amount of files here, let's call housekeeping again
-		houseKeep();
+void NetImageManager::setMaxDownloads(int maxDownloads) {
+	maxDownloads = qMax(1, maxDownloads);
+	if (mMaxDownloads != maxDownloads) {
+		mMaxDownloads = maxDownloads;
+		emit maxDownloadsChanged(mMaxDownloads);
+		startDownloads();
 	}
 }
 
-void NetImageManager::httpFinished(QNetworkReply * reply) {
-	if (reply->error() == QNetworkReply::NoError) {
-		QImage qImage;
-		qImage.loadFromData(reply->readAll());
+int NetImageManager::maxDownloads() {
+	return mMaxDownloads;
+}
 
-		if (qImage.isNull()) {
-			return;
-		}
+qreal NetImageManager::hitRate() {
+	const int lookUps = mHits + mMisses;
+	return lookUps > 0 ? qreal(mHits) / lookUps : 0;
+}
 
-		// When the download is finished we make a hash-tag for the image out of it's url so we can find it again,
-		// then we save it as a .JPG. The qHash is a bucket type hash so the doubling is to remove possible collisions.
-		QString diskPath = QDir::homePath() + "/" + mCacheId + "/"
-				+ QString::number(qHash(reply->url().host())) + "_"
-				+ QString::number(qHash(reply->url().path())) + ".JPG";
+int NetImageManager::averageLatency() {
+	return mCompletedDownloads > 0 ? mTotalLatency / mCompletedDownloads : 0;
+}
 
-		if (qImage.save(diskPath)) {
-			// houseKeep() is called to see that we don't save more then we are allowed in the cache
-			houseKeep();
-			emit imageReady(diskPath, reply->url().toString());
-		}
+void NetImageManager::houseKeep() {
+	// The index keeps the files in least recently used order, so removing
+	// the oldest ones does not need to list the cache folder.
+	mIndex->evict(mCacheSize, mCacheBytes);
+}
 
-		//we remove the first item in the download queue
-		if (!mQueue.isEmpty()) {
-			mQueue.removeFirst();
+void NetImageManager::httpFinished(QNetworkReply * reply) {
+	const qint64 latency = mDownloads.take(reply).elapsed();
+	const QString imageName = reply->url().toString();
+	mRequested.remove(imageName);
+	bool stored = false;
 
-			if (!mQueue.isEmpty()) {
-				QNetworkRequest request = mQueue.first();
-				mAccessManager.get(request);
+	if (reply->error() == QNetworkReply::NoError) {
+		const QByteArray data = reply->readAll();
+
+		// Only the image header is read to check that we got an image, the bytes are
+		// stored as they are, so the image is not decoded until it is shown.
+		QBuffer buffer;
+		buffer.setData(data);
+		buffer.open(QIODevice::ReadOnly);
+		QImageReader imageReader(&buffer);
+
+		if (imageReader.canRead()) {
+			// When the download is finished we make a hash-tag for the image out of it's url so we can find it again.
+			const QString fileName = cacheFileName(reply->url());
+			QString diskPath = QDir::homePath() + "/" + mCacheId + "/" + fileName;
+
+			// The bytes are written to a temporary file first, so a tracker never sees a partly written image.
+			QFile file(diskPath + ".part");
+			if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)
+					&& file.write(data) == data.size()) {
+				file.close();
+				QFile::remove(diskPath);
+
+				if (file.rename(diskPath)) {
+					// houseKeep() is called to see that we don't save more then we are allowed in the cache,
+					// the new image is the most recently used one so it is never the one that is removed.
+					mIndex->insert(fileName, data.size());
+					houseKeep();
+
+					mCompletedDownloads++;
+					mTotalLatency += latency;
+					emit statisticsChanged();
+
+					stored = true;
+					emit imageReady(diskPath, imageName);
+				} else {
+					qDebug() << "Could not rename image" << file.fileName();
+					file.remove();
+				}
+			} else {
+				qDebug() << "Could not store image" << diskPath;
+				file.remove();
 			}
+		} else {
+			qDebug() << "Not an image" << imageName;
 		}
 	} else {
 		//Handle error
-		qDebug() << "Could Not access image" << reply->url().toString();
+		qDebug() << "Could Not access image" << imageName << reply->errorString();
+	}
+
+	if (!stored) {
+		// Every tracker waiting for this image is told, so none of them keeps showing the loading image
+		emit imageFailed(imageName);
 	}
 	reply->deleteLater();
+
+	// Continue with the next image in the download queue
+	startDownloads();
 }
 void NetImageManager::onDialogFinished(bb::system::SystemUiResult::Type type)
 {
@@ -15,11 +15,17 @@
 #ifndef _NETIMAGECACHE_H_
 #define _NETIMAGECACHE_H_
 
+#include "netimageindex.h"
+
 #include <bb/cascades/Image>
 #include <bb/system/SystemDialog>
 #include <QtNetwork/QNetworkRequest>
 
+#include <QElapsedTimer>
+#include <QHash>
 #include <QObject>
+#include <QSet>
+#include <QSharedPointer>
 #include <QtGui/QImage>
 
 using namespace bb::cascades;
@@ -29,6 +35,12 @@ using namespace bb::system;
  * NetImageManager is a cache service for our Internet downloaded images.
  * You can set the size of the cache and an id for the cache.
  * If you want to reuse the cache between different pages it's possible.
+ *
+ * Several images are downloaded at the same time, and an image that is
+ * requested again while it is downloading is only downloaded once. The
+ * downloaded bytes are stored unchanged, and a NetImageIndex keeps track
+ * of the cached files so the least recently used ones can be removed
+ * without listing the cache folder.
  */
 class NetImageManager: public QObject
 {
@@ -46,6 +58,29 @@ class NetImageManager: public QObject
      */
     Q_PROPERTY(int cacheSize READ cacheSize WRITE setCacheSize NOTIFY cacheSizeChanged)
 
+    /**
+     * Sets the size of the cache in bytes, if not set, it defaults to 8 MB. The least
+     * recently used images are removed when either this or the cacheSize is exceeded.
+     */
+    Q_PROPERTY(int cacheBytes READ cacheBytes WRITE setCacheBytes NOTIFY cacheBytesChanged)
+
+    /**
+     * Sets the number of images that are downloaded at the same time, if not set, it
+     * defaults to 4.
+     */
+    Q_PROPERTY(int maxDownloads READ maxDownloads WRITE setMaxDownloads NOTIFY maxDownloadsChanged)
+
+    /**
+     * The share of image look ups that were found in the cache, between 0 and 1.
+     */
+    Q_PROPERTY(qreal hitRate READ hitRate NOTIFY statisticsChanged)
+
+    /**
+     * The average time in milliseconds from sending a download request until the image
+     * was stored in the cache.
+     */
+    Q_PROPERTY(int averageLatency READ averageLatency NOTIFY statisticsChanged)
+
 public:
     /**
      * This is our constructor which initializes the member variables.
@@ -83,6 +118,48 @@ public:
      */
     int cacheSize();
 
+    /**
+     * This function sets the cacheBytes property.
+     *
+     * @param cacheBytes The number of bytes the cache folder may use.
+     */
+    void setCacheBytes(int cacheBytes);
+
+    /**
+     * This function return the cacheBytes.
+     *
+     * @return The cacheBytes
+     */
+    int cacheBytes();
+
+    /**
+     * This function sets the maxDownloads property.
+     *
+     * @param maxDownloads The number of images downloaded at the same time.
+     */
+    void setMaxDownloads(int maxDownloads);
+
+    /**
+     * This function return the maxDownloads.
+     *
+     * @return The maxDownloads
+     */
+    int maxDownloads();
+
+    /**
+     * The share of look ups found in the cache.
+     *
+     * @return The hit rate between 0 and 1
+     */
+    qreal hitRate();
+
+    /**
+     * The average download time.
+     *
+     * @return The average latency in milliseconds
+     */
+    int averageLatency();
+
     /**
      * Check if the image exists in cache
      *
@@ -93,7 +170,7 @@ public:
     void lookUpImage(const QString imageName);
 
     /**
-     * Check if the cache is full and if so deletes the oldest
+     * Check if the cache is full and if so deletes the least recently used images
      */
     void houseKeep();
 
@@ -110,9 +187,24 @@ public:
      */
     void cacheIdChanged(QString cacheId);
     void cacheSizeChanged(int cacheSize);
+    void cacheBytesChanged(int cacheBytes);
+    void maxDownloadsChanged(int maxDownloads);
+
+    /**
+     * This signal is emitted when the hit rate or the average latency has changed
+     */
+    void statisticsChanged();
 
     void imageReady(const QString filePath, const QString imageName);
 
+    /**
+     * This signal is emitted when an image could not be downloaded or stored in the cache.
+     * The image is downloaded again the next time it is looked up.
+     *
+     * @param imageName the url of the image
+     */
+    void imageFailed(const QString imageName);
+
 private slots:
     /**
      * This Slot function is called when the network request is complete.
@@ -129,10 +221,24 @@ private slots:
     void onSslErrors(QNetworkReply * reply, const QList<QSslError> & errors);
 
 private:
+    /**
+     * Returns the name of the file an image is cached in.
+     */
+    static QString cacheFileName(const QUrl &url);
+
+    /**
+     * Starts downloading queued images until maxDownloads images are downloading.
+     */
+    void startDownloads();
 
     // Property variables
     QString mCacheId;
     int mCacheSize;
+    int mCacheBytes;
+    int mMaxDownloads;
+
+    // The index of the files in the cache folder
+    QSharedPointer<NetImageIndex> mIndex;
 
     // String constant for the default id of the image cache
     static const char* const mDefaultId;
@@ -140,7 +246,20 @@ private:
     // The network parameters; used for accessing a file from the Internet
     QNetworkAccessManager mAccessManager;
 
-    QList<QNetworkRequest> mQueue;
+    // The images waiting to be downloaded
+    QList<QUrl> mQueue;
+
+    // The images that are queued or downloading, so each one is only downloaded once
+    QSet<QString> mRequested;
+
+    // The time each download has taken so far
+    QHash<QNetworkReply*, QElapsedTimer> mDownloads;
+
+    // Statistics for the hit rate and latency
+    int mHits;
+    int mMisses;
+    int mCompletedDownloads;
+    qint64 mTotalLatency;
 };
 
 #endif //  _NETIMAGECACHE_H_
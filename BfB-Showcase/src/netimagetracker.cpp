@@ -58,6 +58,14 @@ void NetImageTracker::onImageReady(const QString filePath, const QString imageNa
     }
 }
 
+void NetImageTracker::onImageFailed(const QString imageName)
+{
+    if (imageName.compare(mSource) == 0) {
+        // Stop showing the loading image, there is nothing more to wait for.
+        setImageSource(QUrl());
+    }
+}
+
 void NetImageTracker::setSource(const QString source)
 {
     if (!source.isEmpty() && mSource.compare(source) != 0) {
@@ -90,6 +98,8 @@ void NetImageTracker::setManager(NetImageManager *manager)
         if (mManager) {
             disconnect(mManager, SIGNAL(imageReady(const QString , const QString )), this,
                     SLOT(onImageReady( const QString , const QString )));
+            disconnect(mManager, SIGNAL(imageFailed(const QString )), this,
+                    SLOT(onImageFailed( const QString )));
             delete (mManager);
         }
 
@@ -98,6 +108,8 @@ void NetImageTracker::setManager(NetImageManager *manager)
 
         connect(mManager, SIGNAL(imageReady(const QString , const QString )), this,
                 SLOT(onImageReady( const QString , const QString )));
+        connect(mManager, SIGNAL(imageFailed(const QString )), this,
+                SLOT(onImageFailed( const QString )));
     }
 }
 
@@ -105,6 +105,13 @@ private slots:
      */
     void onImageReady(const QString filePath, const QString imageName);
 
+    /**
+     * Emitted when an image could not be downloaded
+     *
+     * @param imageName the url of the image that failed
+     */
+    void onImageFailed(const QString imageName);
+
 private:
     QString mSource;
 
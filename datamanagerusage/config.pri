@@ -104,9 +104,13 @@ config_pri_source_group1 {
         $$quote($$BASEDIR/src/applicationui.cpp) \
         $$quote($$BASEDIR/src/default/NumericRevision.cpp) \
         $$quote($$BASEDIR/src/default/QueryExec.cpp) \
+        $$quote($$BASEDIR/src/default/SqlConnectionPool.cpp) \
         $$quote($$BASEDIR/src/default/SqlDataQuery.cpp) \
         $$quote($$BASEDIR/src/default/SqlHeaderDataQuery.cpp) \
+        $$quote($$BASEDIR/src/default/SqlPrefetcher.cpp) \
         $$quote($$BASEDIR/src/default/SqlQueryUtils.cpp) \
+        $$quote($$BASEDIR/src/default/SqlResultSet.cpp) \
+        $$quote($$BASEDIR/src/default/SqlStatementCache.cpp) \
         $$quote($$BASEDIR/src/default/SqlTransaction.cpp) \
         $$quote($$BASEDIR/src/main.cpp)
 
@@ -114,9 +118,13 @@ config_pri_source_group1 {
         $$quote($$BASEDIR/src/applicationui.hpp) \
         $$quote($$BASEDIR/src/default/NumericRevision.hpp) \
         $$quote($$BASEDIR/src/default/QueryExec.hpp) \
+        $$quote($$BASEDIR/src/default/SqlConnectionPool.hpp) \
         $$quote($$BASEDIR/src/default/SqlDataQuery.hpp) \
         $$quote($$BASEDIR/src/default/SqlHeaderDataQuery.hpp) \
+        $$quote($$BASEDIR/src/default/SqlPrefetcher.hpp) \
         $$quote($$BASEDIR/src/default/SqlQueryUtils.hpp) \
+        $$quote($$BASEDIR/src/default/SqlResultSet.hpp) \
+        $$quote($$BASEDIR/src/default/SqlStatementCache.hpp) \
         $$quote($$BASEDIR/src/default/SqlTransaction.hpp)
 }
 
@@ -34,6 +34,10 @@ NumericRevision::NumericRevision(const NumericRevision& other) :
 NumericRevision::~NumericRevision() {
 }
 
+quint64 NumericRevision::revision() const {
+    return m_revision;
+}
+
 bool NumericRevision::equals(const Revision &other) const {
     const NumericRevision *otherRev =
             dynamic_cast<const NumericRevision *>(&other);
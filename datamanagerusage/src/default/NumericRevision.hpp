@@ -56,6 +56,14 @@ public:
      */
     virtual ~NumericRevision();
 
+    /*!
+     * Get the numeric revision number.
+     *
+     * @return The revision number as a 64-bit unsigned integer.
+     *
+     */
+    quint64 revision() const;
+
     /*!
      * @see Revision::equals
      *
@@ -14,9 +14,11 @@
  * limitations under the License.
  */
 #include "QueryExec.hpp"
-#include <bb/cascades/datamanager/SqlQueryUtils>
+#include "SqlConnectionPool.hpp"
+#include "SqlQueryUtils.hpp"
 #include <bb/UIToolkitSupport>
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlRecord>
 #include <QtSql/QSqlQuery>
@@ -31,6 +33,11 @@ static const int MINOR_VERSION = 2;
 //used for naming the query parameters
 static const char *QUERIES_KEY = "Q";
 static const char *VALUES_KEY = "V";
+static const char *BATCH_KEY = "B";
+
+//used for naming the reply parts
+static const char *RESULTS_KEY = "R";
+static const char *STATISTICS_KEY = "S";
 
 QueryExec::QueryExec(QObject *parent) :
         QObject(parent), m_times(1), m_interval(1000), m_executionCount(0), m_asyncSql(NULL), m_timer(NULL) {
@@ -72,6 +79,18 @@ void QueryExec::setValuesToBind(const QVariantMap &nameValueMap) {
     m_bindValues = nameValueMap;
 }
 
+QVariantList QueryExec::batchValues() const {
+    return m_batchValues;
+}
+
+void QueryExec::setBatchValues(const QVariantList &batchValues) {
+    m_batchValues = batchValues;
+}
+
+QVariantList QueryExec::statistics() const {
+    return m_statistics;
+}
+
 int QueryExec::times() const {
     return m_times;
 }
@@ -145,6 +164,7 @@ void QueryExec::executeQueries() {
         QVariantMap queriesAndValues;
         queriesAndValues[QUERIES_KEY] = m_queries;
         queriesAndValues[VALUES_KEY] = m_bindValues;
+        queriesAndValues[BATCH_KEY] = m_batchValues;
         m_asyncSql->execute(queriesAndValues);
     }
 }
@@ -157,7 +177,10 @@ void QueryExec::processResult(const bb::data::DataAccessReply &reply) {
         Q_EMIT error(reply.errorType(), reply.errorMessage());
     }
     else {
-        Q_EMIT executed(reply.result());
+        QVariantMap resultsAndStatistics = reply.result().toMap();
+        m_statistics = resultsAndStatistics[STATISTICS_KEY].toList();
+        Q_EMIT statisticsChanged(m_statistics);
+        Q_EMIT executed(resultsAndStatistics[RESULTS_KEY]);
     }
 }
 
@@ -177,9 +200,11 @@ QueryWorker::~QueryWorker() {
 void QueryWorker::execute(const QVariant &command, bb::data::DataAccessReply *replyData) {
     qDebug() << "QueryWorker::execute";
     // get the open db connection and start a transaction
-    bb::cascades::datamanager::SqlQueryUtils squ;
+    SqlQueryUtils squ;
     QSqlError error;
-    QSqlDatabase connection = squ.connection(m_source, &error);
+    // all writes go through the single writer connection of the pool
+    SqlPooledConnection pooled(m_source, SqlConnectionPool::Write, &error);
+    QSqlDatabase connection = pooled.connection();
     if (error.type() != QSqlError::NoError) {
         populateReply(QVariant(), error, replyData);
         return;
@@ -190,23 +215,61 @@ void QueryWorker::execute(const QVariant &command, bb::data::DataAccessReply *re
     QVariantMap queriesAndValues = command.toMap();
     QStringList queries = queriesAndValues[QUERIES_KEY].toStringList();
     QVariantMap bindingValues = queriesAndValues[VALUES_KEY].toMap();
+    QVariantList batchValues = queriesAndValues[BATCH_KEY].toList();
 
-    // execute the queries
+    // execute the queries, each one prepared once
     QVariantList combinedResults;
+    QVariantList statistics;
     for (int i=0; i < queries.size(); ++i) {
-        qDebug() << "executing query:  " << queries[i] << ", bindings: " << bindingValues;
-        QSqlQuery sqlQuery(connection);
-        squ.prepareQuery(queries[i], bindingValues, &sqlQuery);
-        if (!sqlQuery.exec()) {
-            populateReply(QVariant(), sqlQuery.lastError(), replyData);
-            connection.rollback();
-            return;
+        QElapsedTimer timer;
+        timer.start();
+        int executions = 1;
+        int rows = 0;
+        QVariant batch = i < batchValues.size() ? batchValues[i] : QVariant();
+        if (batch.type() == QVariant::List) {
+            QVariantList bindValueRows = batch.toList();
+            qDebug() << "executing batch query:  " << queries[i] << ", rows: " << bindValueRows.size();
+            executions = bindValueRows.size();
+            if (!squ.execBatch(connection, queries[i], bindingValues, bindValueRows, &rows, &error)) {
+                populateReply(QVariant(), error, replyData);
+                connection.rollback();
+                return;
+            }
+        } else {
+            qDebug() << "executing query:  " << queries[i] << ", bindings: " << bindingValues;
+            QSqlQuery *sqlQuery = squ.cachedQuery(connection, queries[i], bindingValues, &error);
+            if (sqlQuery == NULL || !sqlQuery->exec()) {
+                if (sqlQuery != NULL) {
+                    error = sqlQuery->lastError();
+                    sqlQuery->finish();
+                }
+                populateReply(QVariant(), error, replyData);
+                connection.rollback();
+                return;
+            }
+            if (sqlQuery->isSelect()) {
+                int resultCount = combinedResults.size();
+                populateQueryResults(*sqlQuery, &combinedResults);
+                rows = combinedResults.size() - resultCount;
+            } else {
+                rows = qMax(0, sqlQuery->numRowsAffected());
+            }
+            sqlQuery->finish();
         }
-        populateQueryResults(sqlQuery, &combinedResults);
+
+        QVariantMap statement;
+        statement["query"] = queries[i];
+        statement["executions"] = executions;
+        statement["rows"] = rows;
+        statement["elapsed"] = int(timer.elapsed());
+        statistics.append(statement);
     }
 
     if (connection.commit()) {
-        populateReply(combinedResults, error, replyData);
+        QVariantMap resultsAndStatistics;
+        resultsAndStatistics[RESULTS_KEY] = combinedResults;
+        resultsAndStatistics[STATISTICS_KEY] = statistics;
+        populateReply(resultsAndStatistics, error, replyData);
     }
     else {
         qWarning() << "Could not commit transaction for database " << connection.databaseName();
@@ -92,6 +92,28 @@ class QueryExec : public QObject {
      */
     Q_PROPERTY(QVariantMap bindValues READ valuesToBind WRITE setValuesToBind)
 
+    /*!
+     * @brief Rows of bind values for executing queries as a batch.
+     *
+     * The list has an entry for each query in #queries. If an entry is a list of maps,
+     * that query is prepared once and executed once for each map, with values in the map
+     * taking precedence over #bindValues. Any other entry (or a missing one) executes the
+     * query once with #bindValues. This allows bulk inserts in a single transaction:
+     *
+     *  queries:     [ "insert into artist (name, realname) values (:name, :realname)" ]
+     *  batchValues: [ [ { "name": "a", "realname": "A" }, { "name": "b", "realname": "B" } ] ]
+     */
+    Q_PROPERTY(QVariantList batchValues READ batchValues WRITE setBatchValues)
+
+    /*!
+     * @brief Statistics for each query of the last execution.
+     *
+     * A list with a map for each query in #queries holding the "query" text, the
+     * number of "executions", the "rows" changed or selected and the "elapsed" time
+     * in milliseconds.
+     */
+    Q_PROPERTY(QVariantList statistics READ statistics NOTIFY statisticsChanged)
+
     /*!
      * @brief Count of times to execute. Default is 1.
      *
@@ -171,6 +193,27 @@ public:
      */
     Q_SLOT void setValuesToBind(const QVariantMap& nameValueMap);
 
+    /*!
+     * Retrieve the rows of bind values for each query.
+     *
+     * @return a list with an entry for each query.
+     */
+    QVariantList batchValues() const;
+
+    /*!
+     * Set the rows of bind values for each query. See the #batchValues property.
+     *
+     * @param batchValues a list with an entry for each query.
+     */
+    Q_SLOT void setBatchValues(const QVariantList& batchValues);
+
+    /*!
+     * @brief Gets the current value of the #statistics property.
+     *
+     * @return The per query statistics of the last execution.
+     */
+    QVariantList statistics() const;
+
     /*!
      * @brief Gets the current value of the #times property.
      *
@@ -247,6 +290,13 @@ Q_SIGNALS:
      */
     void error(int errorType, const QString& errorMessage);
 
+    /*!
+     * @brief Emitted when the #statistics property has changed after an execution.
+     *
+     * @param statistics The per query statistics of the last execution.
+     */
+    void statisticsChanged(const QVariantList& statistics);
+
 private:
     /**
      * Internal query execution method.
@@ -264,6 +314,8 @@ private:
     QUrl m_source;
     QStringList m_queries;
     QVariantMap m_bindValues;
+    QVariantList m_batchValues;
+    QVariantList m_statistics;
     int m_times;
     int m_interval;
     int m_executionCount;
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SqlConnectionPool.hpp"
+#include "SqlQueryUtils.hpp"
+#include "SqlStatementCache.hpp"
+
+#include <bb/UIToolkitSupport>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutexLocker>
+#include <QThread>
+#include <QtSql/QSqlQuery>
+#include <QtCore/QDebug>
+
+// pools live until the application exits, the connections until their thread exits
+struct SqlConnectionPoolRegistry
+{
+    QMutex mutex;
+    QHash<QString, SqlConnectionPool *> pools;
+};
+Q_GLOBAL_STATIC(SqlConnectionPoolRegistry, s_registry)
+
+static const char *WRITER_SUFFIX = ":writer:";
+static const char *READER_SUFFIX = ":reader:";
+
+static QString threadSuffix() {
+    return QString::number((qulonglong) QThread::currentThreadId());
+}
+
+SqlConnectionPool *SqlConnectionPool::pool(const QUrl &source) {
+    QString sourcePath = bb::UIToolkitSupport::absolutePathFromUrl(source);
+    SqlConnectionPoolRegistry *registry = s_registry();
+    QMutexLocker locker(&registry->mutex);
+    SqlConnectionPool *pool = registry->pools.value(sourcePath);
+    if (pool == NULL) {
+        pool = new SqlConnectionPool(sourcePath);
+        registry->pools.insert(sourcePath, pool);
+    }
+    return pool;
+}
+
+SqlConnectionPool::SqlConnectionPool(const QString &sourcePath)
+    : m_sourcePath(sourcePath)
+    , m_busyReaders(0)
+    , m_maxReaders(DefaultMaxReaders)
+    , m_writerBusy(false)
+    , m_checkoutCount(0)
+    , m_waitCount(0)
+    , m_totalWaitTime(0)
+    , m_maxWaitTime(0) {
+}
+
+SqlConnectionPool::~SqlConnectionPool() {
+}
+
+QSqlDatabase SqlConnectionPool::acquire(Mode mode, QSqlError *error, bool wait) {
+    QMutexLocker locker(&m_mutex);
+    QElapsedTimer timer;
+    timer.start();
+    bool waited = false;
+
+    QSqlDatabase connection;
+    *error = QSqlError();
+    if (mode == Write) {
+        while (m_writerBusy) {
+            if (!wait) {
+                return connection;
+            }
+            waited = true;
+            m_writerReleased.wait(&m_mutex);
+        }
+        connection = open(m_sourcePath + WRITER_SUFFIX + threadSuffix(), error);
+        if (error->type() == QSqlError::NoError) {
+            m_writerBusy = true;
+        }
+    } else {
+        while (m_busyReaders >= m_maxReaders) {
+            if (!wait) {
+                return connection;
+            }
+            waited = true;
+            m_readerReleased.wait(&m_mutex);
+        }
+        connection = open(m_sourcePath + READER_SUFFIX + threadSuffix(), error);
+        if (error->type() == QSqlError::NoError) {
+            ++m_busyReaders;
+        }
+    }
+
+    if (error->type() == QSqlError::NoError) {
+        ++m_checkoutCount;
+        if (waited) {
+            qint64 waitTime = timer.elapsed();
+            ++m_waitCount;
+            m_totalWaitTime += waitTime;
+            m_maxWaitTime = qMax(m_maxWaitTime, waitTime);
+            qDebug() << "SqlConnectionPool waited " << waitTime << "ms for a "
+                     << (mode == Write ? "writer" : "reader") << " connection to " << m_sourcePath;
+        }
+    }
+    return connection;
+}
+
+void SqlConnectionPool::release(const QSqlDatabase &connection) {
+    QMutexLocker locker(&m_mutex);
+    if (connection.connectionName().contains(WRITER_SUFFIX)) {
+        m_writerBusy = false;
+        m_writerReleased.wakeOne();
+    } else {
+        --m_busyReaders;
+        m_readerReleased.wakeOne();
+    }
+}
+
+void SqlConnectionPool::setMaxReaders(int maxReaders) {
+    QMutexLocker locker(&m_mutex);
+    // readers checked out beyond the new maximum are given back as usual
+    m_maxReaders = qMax(1, maxReaders);
+    m_readerReleased.wakeAll();
+}
+
+int SqlConnectionPool::maxReaders() const {
+    QMutexLocker locker(&m_mutex);
+    return m_maxReaders;
+}
+
+int SqlConnectionPool::size() const {
+    QMutexLocker locker(&m_mutex);
+    return openCount();
+}
+
+int SqlConnectionPool::checkoutCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_checkoutCount;
+}
+
+int SqlConnectionPool::waitCount() const {
+    QMutexLocker locker(&m_mutex);
+    return m_waitCount;
+}
+
+qint64 SqlConnectionPool::totalWaitTime() const {
+    QMutexLocker locker(&m_mutex);
+    return m_totalWaitTime;
+}
+
+qint64 SqlConnectionPool::maxWaitTime() const {
+    QMutexLocker locker(&m_mutex);
+    return m_maxWaitTime;
+}
+
+QVariantMap SqlConnectionPool::statistics() const {
+    QMutexLocker locker(&m_mutex);
+    QVariantMap statistics;
+    statistics["size"] = openCount();
+    statistics["maxReaders"] = m_maxReaders;
+    statistics["busyReaders"] = m_busyReaders;
+    statistics["writerBusy"] = m_writerBusy;
+    statistics["checkouts"] = m_checkoutCount;
+    statistics["waits"] = m_waitCount;
+    // plain ints so the values can be used from QML
+    statistics["totalWaitTime"] = int(m_totalWaitTime);
+    statistics["maxWaitTime"] = int(m_maxWaitTime);
+    return statistics;
+}
+
+/**
+ * Return the calling thread's named connection, opening it in WAL mode the first time.
+ * Called with the mutex held.
+ */
+QSqlDatabase SqlConnectionPool::open(const QString &connectionName, QSqlError *error) {
+    QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+    if (connection.isOpen()) {
+        *error = QSqlError();
+        return connection;
+    }
+    connection = SqlQueryUtils().openConnection(m_sourcePath, connectionName, error);
+    if (error->type() == QSqlError::NoError) {
+        // removed on this thread, after its statements, when the thread exits
+        SqlStatementCache::instance()->adoptConnection(connectionName);
+        if (!m_connectionNames.contains(connectionName)) {
+            m_connectionNames.append(connectionName);
+        }
+        // readers and the writer no longer block each other in WAL mode
+        QSqlQuery pragma(connection);
+        if (!pragma.exec("PRAGMA journal_mode=WAL")) {
+            qWarning() << "SqlConnectionPool could not enable WAL mode: " << pragma.lastError();
+        }
+    }
+    return connection;
+}
+
+/**
+ * Count the open connections, forgetting those removed by exited threads. Called with the mutex held.
+ */
+int SqlConnectionPool::openCount() const {
+    for (int i = m_connectionNames.size() - 1; i >= 0; --i) {
+        if (!QSqlDatabase::contains(m_connectionNames.at(i))) {
+            m_connectionNames.removeAt(i);
+        }
+    }
+    return m_connectionNames.size();
+}
+
+SqlPooledConnection::SqlPooledConnection(const QUrl &source, SqlConnectionPool::Mode mode, QSqlError *error,
+        bool wait)
+    : m_pool(SqlConnectionPool::pool(source)) {
+    m_connection = m_pool->acquire(mode, error, wait);
+    if (error->type() != QSqlError::NoError || !m_connection.isValid()) {
+        m_pool = NULL;
+    }
+}
+
+SqlPooledConnection::~SqlPooledConnection() {
+    if (m_pool != NULL) {
+        m_pool->release(m_connection);
+    }
+}
+
+QSqlDatabase SqlPooledConnection::connection() const {
+    return m_connection;
+}
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SQLCONNECTIONPOOL_HPP
+#define SQLCONNECTIONPOOL_HPP
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QVariantMap>
+#include <QWaitCondition>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlError>
+
+/*!
+ * @brief A bounded pool of SQLite connections for one database.
+ *
+ * Connections are opened in WAL journal mode, so readers do not block the writer
+ * and the writer does not block readers. Up to maxReaders() reader checkouts are
+ * handed out concurrently and only one writer checkout at a time, so all writes
+ * are serialized. Callers wait when no checkout of the requested kind is free.
+ *
+ * A QSqlDatabase may only be used by the thread that created it, so each thread
+ * gets its own reader and writer connection, opened on that thread when it first
+ * checks one out. They are adopted by the thread's SqlStatementCache and removed
+ * together with its prepared statements when the thread exits, instead of being
+ * kept open for the lifetime of the application.
+ *
+ * Use SqlPooledConnection to check out a connection for the length of a scope.
+ *
+ * @see SqlPooledConnection
+ *
+ */
+class SqlConnectionPool
+{
+public:
+    /*!
+     * The kind of connection to check out.
+     *
+     */
+    enum Mode {
+        Read,
+        Write
+    };
+
+    /*!
+     * The default maximum number of concurrent reader connections.
+     *
+     */
+    static const int DefaultMaxReaders = 4;
+
+    /*!
+     * Return the pool for the database at the source URL, creating it if needed.
+     *
+     */
+    static SqlConnectionPool *pool(const QUrl &source);
+
+    /*!
+     * Constructor.
+     *
+     * @param sourcePath The absolute path to the local database.
+     *
+     */
+    explicit SqlConnectionPool(const QString &sourcePath);
+
+    /*!
+     * Destructor.
+     *
+     */
+    virtual ~SqlConnectionPool();
+
+    /*!
+     * Check out a connection, waiting until one of the requested kind is free.
+     *
+     * @param mode Whether a reader or the writer connection is needed.
+     * @param[out] error The error object to update with the status. Pointer must not be null.
+     * If OK, then QSqlError::type() will be QSqlError::NoError.
+     * @param wait If false, return an invalid connection with no error instead of
+     * waiting when no checkout of the requested kind is free.
+     * @return The open connection. It must be given back with release() by the same thread.
+     *
+     */
+    QSqlDatabase acquire(Mode mode, QSqlError *error, bool wait = true);
+
+    /*!
+     * Give back a connection returned by acquire().
+     *
+     */
+    void release(const QSqlDatabase &connection);
+
+    /*!
+     * Set the maximum number of concurrent reader checkouts. Must be at least 1.
+     *
+     */
+    void setMaxReaders(int maxReaders);
+
+    /*!
+     * Get the maximum number of concurrent reader checkouts.
+     *
+     */
+    int maxReaders() const;
+
+    /*!
+     * Get the number of open connections, readers and writers of all threads.
+     *
+     */
+    int size() const;
+
+    /*!
+     * Get the number of checkouts so far.
+     *
+     */
+    int checkoutCount() const;
+
+    /*!
+     * Get the number of checkouts which had to wait for a connection.
+     *
+     */
+    int waitCount() const;
+
+    /*!
+     * Get the total time in milliseconds spent waiting for connections.
+     *
+     */
+    qint64 totalWaitTime() const;
+
+    /*!
+     * Get the longest time in milliseconds a checkout waited for a connection.
+     *
+     */
+    qint64 maxWaitTime() const;
+
+    /*!
+     * Get all the metrics as a map with the keys "size", "maxReaders", "busyReaders",
+     * "writerBusy", "checkouts", "waits", "totalWaitTime" and "maxWaitTime".
+     *
+     */
+    QVariantMap statistics() const;
+
+private:
+    QSqlDatabase open(const QString &connectionName, QSqlError *error);
+    int openCount() const;
+
+    const QString m_sourcePath;
+    mutable QMutex m_mutex;
+    QWaitCondition m_readerReleased;
+    QWaitCondition m_writerReleased;
+    // the connections opened by all threads, some may have been removed since
+    mutable QStringList m_connectionNames;
+    int m_busyReaders;
+    int m_maxReaders;
+    bool m_writerBusy;
+    int m_checkoutCount;
+    int m_waitCount;
+    qint64 m_totalWaitTime;
+    qint64 m_maxWaitTime;
+
+    Q_DISABLE_COPY(SqlConnectionPool)
+};
+
+/*!
+ * A connection checked out of a SqlConnectionPool for the lifetime of this object.
+ *
+ * Example usage:
+ *     doWork() {
+ *         QSqlError error;
+ *         SqlPooledConnection pooled(source, SqlConnectionPool::Read, &error);
+ *         QSqlDatabase connection = pooled.connection();
+ *         SqlTransaction tx(connection);
+ *         ... read from the database ...
+ *     }
+ *
+ * The transaction is declared after the pooled connection so it ends before the
+ * connection is given back. The object must not be passed to another thread.
+ *
+ */
+class SqlPooledConnection
+{
+public:
+    /*!
+     * Constructor. Checks out a connection from the pool for the source.
+     *
+     * @param source The path to the local database.
+     * @param mode Whether a reader or the writer connection is needed.
+     * @param[out] error The error object to update with the status. Pointer must not be null.
+     * @param wait If false, the connection is invalid, with no error, when none is free.
+     *
+     */
+    SqlPooledConnection(const QUrl &source, SqlConnectionPool::Mode mode, QSqlError *error,
+            bool wait = true);
+
+    /*!
+     * Destructor. Gives the connection back to the pool.
+     *
+     */
+    virtual ~SqlPooledConnection();
+
+    /*!
+     * Get the checked out connection. Invalid if the checkout failed.
+     *
+     */
+    QSqlDatabase connection() const;
+
+private:
+    SqlConnectionPool *m_pool;
+    QSqlDatabase m_connection;
+
+    Q_DISABLE_COPY(SqlPooledConnection)
+};
+
+#endif /* SQLCONNECTIONPOOL_HPP */
@@ -18,22 +18,46 @@
 #include "SqlDataQuery.hpp"
 #include "SqlTransaction.hpp"
 #include "SqlQueryUtils.hpp"
+#include "SqlResultSet.hpp"
+#include "SqlConnectionPool.hpp"
+#include "SqlStatementCache.hpp"
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 using namespace bb::cascades::datamanager;
 
+// the placeholder name for the revision a delta query compares against
+static const char *SINCE_REVISION = "sinceRevision";
+
 SqlDataQuery::SqlDataQuery(QObject *parent)
     : DataQuery(parent)
     , m_startOffset(-1)
     , m_endOffset(-1)
     , m_totalCount(0)
     , m_scrollUpCount(0)
-    , m_scrollDownCount(0) {
+    , m_scrollDownCount(0)
+    , m_checkpointInterval(0)
+    , m_rowViewPayloads(false)
+    , m_prefetchDepth(0)
+    , m_lastOffset(-1)
+    , m_keysetSeekCount(0)
+    , m_keysetSkippedRows(0) {
 }
 
 SqlDataQuery::SqlDataQuery(const QString &query, QObject *parent)
-    : DataQuery(parent) {
+    : DataQuery(parent)
+    , m_startOffset(-1)
+    , m_endOffset(-1)
+    , m_totalCount(0)
+    , m_scrollUpCount(0)
+    , m_scrollDownCount(0)
+    , m_checkpointInterval(0)
+    , m_rowViewPayloads(false)
+    , m_prefetchDepth(0)
+    , m_lastOffset(-1)
+    , m_keysetSeekCount(0)
+    , m_keysetSkippedRows(0) {
     setQuery(query);
 }
 
@@ -92,6 +116,48 @@ QString SqlDataQuery::scrollDownQuery() const {
     return m_scrollDownQuery;
 }
 
+void SqlDataQuery::setCheckpointInterval(int checkpointInterval) {
+    if (m_checkpointInterval != 0) {
+        qWarning() << "checkpointInterval has already been set to "
+                    << m_checkpointInterval << ".  Can't reset to " << checkpointInterval;
+        return;
+    }
+    m_checkpointInterval = qMax(0, checkpointInterval);
+}
+
+int SqlDataQuery::checkpointInterval() const {
+    return m_checkpointInterval;
+}
+
+void SqlDataQuery::setRowViewPayloads(bool rowViewPayloads) {
+    m_rowViewPayloads = rowViewPayloads;
+}
+
+bool SqlDataQuery::rowViewPayloads() const {
+    return m_rowViewPayloads;
+}
+
+void SqlDataQuery::setPrefetchDepth(int prefetchDepth) {
+    if (m_prefetchDepth != 0) {
+        qWarning() << "prefetchDepth has already been set to "
+                    << m_prefetchDepth << ".  Can't reset to " << prefetchDepth;
+        return;
+    }
+    m_prefetchDepth = qMax(0, prefetchDepth);
+}
+
+int SqlDataQuery::prefetchDepth() const {
+    return m_prefetchDepth;
+}
+
+int SqlDataQuery::prefetchHits() const {
+    return m_prefetcher.hitCount();
+}
+
+int SqlDataQuery::prefetchMisses() const {
+    return m_prefetcher.missCount();
+}
+
 void SqlDataQuery::setKeyColumn(const QString& keyColumn) {
     if(!m_keyColumn.isEmpty()) {
         qWarning() << "keyColumn has already been set to " << m_keyColumn
@@ -144,6 +210,35 @@ QString SqlDataQuery::countQuery() const {
     return m_countQuery;
 }
 
+void SqlDataQuery::setDeltaQuery(const QString &deltaQuery) {
+    if (!m_deltaQuery.isEmpty()) {
+        qWarning() << "Delta query has already been set to " << m_deltaQuery
+                    << ".  Can't reset to " << deltaQuery;
+        return;
+    }
+    m_deltaQuery = deltaQuery;
+}
+
+QString SqlDataQuery::deltaQuery() const {
+    if (m_deltaQuery.isEmpty() && !m_query.isEmpty() && !m_revisionColumn.isEmpty()) {
+        return QString("select * from (%1) where %2 > :%3").arg(m_query, m_revisionColumn, SINCE_REVISION);
+    }
+    return m_deltaQuery;
+}
+
+void SqlDataQuery::setTombstoneQuery(const QString &tombstoneQuery) {
+    if (!m_tombstoneQuery.isEmpty()) {
+        qWarning() << "Tombstone query has already been set to " << m_tombstoneQuery
+                    << ".  Can't reset to " << tombstoneQuery;
+        return;
+    }
+    m_tombstoneQuery = tombstoneQuery;
+}
+
+QString SqlDataQuery::tombstoneQuery() const {
+    return m_tombstoneQuery;
+}
+
 void SqlDataQuery::setValuesToBind(const QVariantMap &nameValueMap) {
     if (!m_bindValues.isEmpty()) {
         qWarning() << "Values for bind operation already set!";
@@ -167,7 +262,8 @@ bool SqlDataQuery::getData(int offset, int limit, DataRevision *revision,
     // get the open db connection and start a transaction
     bool result = false;
     SqlQueryUtils utils;
-    QSqlDatabase connection = utils.connection(m_source, &m_error);
+    SqlPooledConnection pooled(m_source, SqlConnectionPool::Read, &m_error);
+    QSqlDatabase connection = pooled.connection();
     if (m_error.type() == QSqlError::NoError) {
         SqlTransaction tx(connection);
         // get the overall revision
@@ -218,7 +314,8 @@ bool SqlDataQuery::getDataForRevision(int offset, int limit,
     }
     // get the open db connection and start a transaction
     bool result = false;
-    QSqlDatabase connection = SqlQueryUtils().connection(m_source, &m_error);
+    SqlPooledConnection pooled(m_source, SqlConnectionPool::Read, &m_error);
+    QSqlDatabase connection = pooled.connection();
 
     if (m_error.type() == QSqlError::NoError) {
         SqlTransaction tx(connection);
@@ -236,6 +333,64 @@ bool SqlDataQuery::getDataForRevision(int offset, int limit,
     return result;
 }
 
+bool SqlDataQuery::getDataDelta(quint64 sinceRevision, DataRevision *revision,
+        QList<DataItem> *changed, QStringList *deletedKeys) {
+
+    if (revision == NULL || changed == NULL || deletedKeys == NULL) {
+        qCritical() << "Null pointer passed for return parameter.";
+        return false;
+    }
+    if (m_revisionColumn.isEmpty() && m_deltaQuery.isEmpty()) {
+        qWarning() << "Delta queries need a revisionColumn or a deltaQuery.";
+        return false;
+    }
+    changed->clear();
+    deletedKeys->clear();
+
+    QElapsedTimer timer;
+    timer.start();
+    bool result = false;
+    SqlQueryUtils utils;
+    SqlPooledConnection pooled(m_source, SqlConnectionPool::Read, &m_error);
+    QSqlDatabase connection = pooled.connection();
+    if (m_error.type() == QSqlError::NoError) {
+        SqlTransaction tx(connection);
+        if (getDatabaseRevision(connection, revision)) {
+            // bound as a signed integer so SQLite compares it numerically
+            QVariantMap valuesToUse = m_bindValues;
+            valuesToUse.insert(SINCE_REVISION, qlonglong(sinceRevision));
+
+            result = utils.getQueryData(connection, deltaQuery(), 0, -1, valuesToUse,
+                    m_keyColumn, m_revisionColumn, changed, &m_error);
+            if (result && !m_tombstoneQuery.isEmpty()) {
+                SqlResultSet tombstones;
+                result = utils.getQueryData(connection, m_tombstoneQuery, 0, -1, valuesToUse,
+                        &tombstones, &m_error);
+                int keyIndex = tombstones.indexOf(m_keyColumn);
+                if (result && keyIndex < 0) {
+                    m_error = QSqlError("", "tombstone query has no key column \"" + m_keyColumn + "\"",
+                            QSqlError::StatementError);
+                    qWarning() << "The tombstone query does not return the key column " << m_keyColumn;
+                    result = false;
+                }
+                for (int i = 0, n = tombstones.rowCount(); result && i < n; i++) {
+                    deletedKeys->append(tombstones.value(i, keyIndex).toString());
+                }
+            }
+            if (!result) {
+                qWarning() << "Failed to load the data delta.";
+            }
+        }
+    }
+    qDebug() << "Delta since revision " << sinceRevision << ": " << changed->size() << " changed, "
+             << deletedKeys->size() << " deleted in " << timer.elapsed() << "ms";
+
+    if (m_error.type() != QSqlError::NoError) {
+        Q_EMIT error(m_error.type(), m_error.databaseText());
+    }
+    return result;
+}
+
 QString SqlDataQuery::toString() const {
     return "SqlDataQuery(\"" + query() + "\")";
 }
@@ -263,6 +418,12 @@ bool SqlDataQuery::getDatabaseRevision(QSqlDatabase &connection,
             revisionOK ?
                     DataRevision(new NumericRevision(numericRevision)) :
                     DataRevision();
+    if (!revisionOK || !(m_lastRevision == *revision)) {
+        // item offsets may have moved so the keyset checkpoints can no longer be trusted;
+        // without a numeric revision a change can not be detected at all
+        m_checkpoints.clear();
+        m_lastRevision = *revision;
+    }
     return true;
 }
 
@@ -277,35 +438,79 @@ bool SqlDataQuery::getDataResults(QSqlDatabase &connection, int offset,
         int offsetToUse = offset;
         bool useCache = !m_scrollUpQuery.isEmpty()
                          && !m_scrollDownQuery.isEmpty();
-        if (useCache && 0 < m_endOffset) {
+        // checkpoints can only be invalidated by a revision change
+        bool useKeyset = useCache && 0 < m_checkpointInterval && !m_revisionQuery.isEmpty();
+        bool anchored = false;
+        // prefetched windows can only be checked against database changes with a revision
+        bool usePrefetch = 0 < m_prefetchDepth && !m_revisionQuery.isEmpty();
+        // was the window loaded ahead of time at the current revision?
+        bool prefetched = false;
+        if (usePrefetch) {
+            prefetched = m_prefetcher.take(offset, limit, m_lastRevision, results);
+            Q_EMIT prefetchStatisticsChanged();
+        }
+        if (!prefetched && useCache && 0 < m_endOffset) {
             // we have previously cached data
             if (offset < m_startOffset) {
                 // we're moving up the list
                 if (m_startOffset == (offset + limit)) {
                     // we have a cached anchor item we can use for optimized query
                     queryToUse = m_scrollUpQuery;
-                    valuesToUse.unite(m_startItem.payload().toMap());
+                    valuesToUse.unite(SqlRowView::toMap(m_startItem.payload()));
                     ++m_scrollUpCount;
+                    anchored = true;
                 }
             } else if (offset > m_startOffset) {
                 // moving down the list
                 if (m_endOffset == (offset - 1)) {
                     // we have a cached anchor item we can use for optimized query
                     queryToUse = m_scrollDownQuery;
-                    valuesToUse.unite(m_endItem.payload().toMap());
+                    valuesToUse.unite(SqlRowView::toMap(m_endItem.payload()));
                     offsetToUse = 0; // do not use offset
                     ++m_scrollDownCount;
+                    anchored = true;
                 }
             }
         }
+        if (!prefetched && useKeyset && !anchored && 0 < offset) {
+            // seek from the nearest checkpoint before the window instead of skipping offset rows
+            QMap<int, QVariantMap>::const_iterator checkpoint = m_checkpoints.lowerBound(offset);
+            if (checkpoint != m_checkpoints.constBegin()) {
+                --checkpoint;
+                queryToUse = m_scrollDownQuery;
+                valuesToUse.unite(checkpoint.value());
+                // the scrollDownQuery starts with the item after the checkpoint item
+                offsetToUse = offset - checkpoint.key() - 1;
+                ++m_keysetSeekCount;
+                m_keysetSkippedRows += checkpoint.key() + 1;
+            }
+        }
         qDebug() << "Current query statistics: total queries = " << ++m_totalCount
                  << ", queries using scrollUp optimization = " << m_scrollUpCount
-                 << ", queries using scrollDown optimization = " << m_scrollDownCount;
+                 << ", queries using scrollDown optimization = " << m_scrollDownCount
+                 << ", queries using keyset seek = " << m_keysetSeekCount
+                 << ", offset rows avoided by keyset seek = " << m_keysetSkippedRows
+                 << ", keyset checkpoints = " << m_checkpoints.size()
+                 << ", prepared statement cache hits = " << SqlStatementCache::instance()->hitCount()
+                 << ", misses = " << SqlStatementCache::instance()->missCount()
+                 << ", prefetch hits = " << m_prefetcher.hitCount()
+                 << ", prefetch misses = " << m_prefetcher.missCount();
 
         // Get the data.
-        if (!SqlQueryUtils().getQueryData(connection, queryToUse, offsetToUse,
-                limit, valuesToUse, m_keyColumn, m_revisionColumn, results,
-                &m_error)) {
+        bool loaded = prefetched;
+        if (prefetched) {
+            // nothing to query
+        } else if (m_rowViewPayloads) {
+            SqlResultSet resultSet;
+            loaded = SqlQueryUtils().getQueryData(connection, queryToUse, offsetToUse,
+                    limit, valuesToUse, &resultSet, &m_error);
+            *results = resultSet.dataItems(m_keyColumn, m_revisionColumn);
+        } else {
+            loaded = SqlQueryUtils().getQueryData(connection, queryToUse, offsetToUse,
+                    limit, valuesToUse, m_keyColumn, m_revisionColumn, results,
+                    &m_error);
+        }
+        if (!loaded) {
             qWarning() << "Failed to load the data.";
             qDebug() << "queryToUse=" << queryToUse << ",offsetToUse="
                      << offsetToUse << ",valuesToUse=" << valuesToUse
@@ -327,6 +532,13 @@ bool SqlDataQuery::getDataResults(QSqlDatabase &connection, int offset,
                     //TDEBUG << "Caching: end=" <<  m_endOffset << ", " << m_endItem;
                 }
             }
+            if (useKeyset) {
+                updateCheckpoints(offset, *results);
+            }
+            if (usePrefetch) {
+                startPrefetch(offset, limit, *results);
+            }
+            m_lastOffset = offset;
             return true;
         }
     } else {
@@ -335,3 +547,46 @@ bool SqlDataQuery::getDataResults(QSqlDatabase &connection, int offset,
     return false;
 }
 
+void SqlDataQuery::updateCheckpoints(int offset, const QList<DataItem> &results) {
+    // a negative offset is treated as zero by the query
+    offset = qMax(0, offset);
+    // checkpoints are kept at multiples of the interval so that reloading a window
+    // does not add new ones
+    int firstCheckpoint = ((offset + m_checkpointInterval - 1) / m_checkpointInterval) * m_checkpointInterval;
+    for (int checkpoint = firstCheckpoint, end = offset + results.size(); checkpoint < end;
+            checkpoint += m_checkpointInterval) {
+        m_checkpoints.insert(checkpoint, SqlRowView::toMap(results.at(checkpoint - offset).payload()));
+    }
+}
+
+void SqlDataQuery::startPrefetch(int offset, int limit, const QList<DataItem> &results) {
+    if (limit <= 0) {
+        return;
+    }
+    SqlPrefetchRequest request;
+    // predict the direction from the last window, the same way the scroll anchors are chosen
+    request.scrollDown = m_lastOffset <= offset;
+    if (request.scrollDown) {
+        if (results.size() < limit) {
+            // we're at the end of the result set
+            return;
+        }
+        request.offset = qMax(0, offset) + results.size();
+        if (!m_scrollUpQuery.isEmpty() && !m_scrollDownQuery.isEmpty()) {
+            request.anchor = SqlRowView::toMap(results.last().payload());
+        }
+    } else {
+        request.offset = offset - limit;
+    }
+    request.limit = limit;
+    request.depth = m_prefetchDepth;
+    request.source = m_source;
+    request.query = m_query;
+    request.scrollDownQuery = m_scrollDownQuery;
+    request.revisionQuery = m_revisionQuery;
+    request.keyColumn = m_keyColumn;
+    request.revisionColumn = m_revisionColumn;
+    request.bindValues = m_bindValues;
+    request.rowViewPayloads = m_rowViewPayloads;
+    m_prefetcher.start(request);
+}
@@ -18,8 +18,12 @@
 #define SQLDATAQUERY_HPP
 
 #include <bb/cascades/datamanager/DataQuery>
+#include <bb/cascades/datamanager/DataRevision>
+#include "SqlPrefetcher.hpp"
 
+#include <QMap>
 #include <QScopedPointer>
+#include <QStringList>
 #include <QUrl>
 #include <QtSql/QSqlError>
 #include <QtSql/QSqlDatabase>
@@ -63,6 +67,65 @@ class SqlDataQuery: public bb::cascades::datamanager::DataQuery {
     Q_PROPERTY(QString scrollUpQuery READ scrollUpQuery WRITE setScrollUpQuery)
     Q_PROPERTY(QString scrollDownQuery READ scrollDownQuery WRITE setScrollDownQuery)
 
+    /*!
+     * @brief The number of rows between keyset pagination checkpoints. Default is 0 (disabled).
+     *
+     * When set together with scrollUpQuery and scrollDownQuery, the payload of every
+     * checkpointInterval'th item that is loaded is remembered as a checkpoint. A window
+     * which does not abut the cached items is then loaded by running the scrollDownQuery
+     * from the nearest checkpoint before it, so SQLite only has to skip the rows between
+     * the checkpoint and the window instead of every row from the start of the result set.
+     *
+     * The main query must have a stable, unique order for this to be correct. Checkpoints
+     * are discarded whenever the overall revision (see revisionQuery) changes, so keyset
+     * pagination is only used when a revisionQuery returning a numeric revision is set.
+     *
+     * Once the property is set it cannot be changed.
+     *
+     */
+    Q_PROPERTY(int checkpointInterval READ checkpointInterval WRITE setCheckpointInterval)
+
+    /*!
+     * @brief Whether data items reference a column oriented result buffer. Default is false.
+     *
+     * When true, the rows of the main query are decoded into a SqlResultSet and the payload
+     * of each DataItem is a SqlRowView instead of a QVariantMap. This avoids building a map
+     * per row for large windows; C++ consumers read payloads with SqlRowView::toMap() or
+     * SqlRowView::value(). Leave it false when the payloads are consumed directly by QML.
+     *
+     * Set it before the query is first used.
+     *
+     */
+    Q_PROPERTY(bool rowViewPayloads READ rowViewPayloads WRITE setRowViewPayloads)
+
+    /*!
+     * @brief The number of windows to load ahead of the data model. Default is 0 (disabled).
+     *
+     * After each window is returned, the next prefetchDepth windows in the direction the
+     * list is being scrolled are loaded on a pooled thread. When the data model then asks
+     * for one of those windows at the same overall revision it is returned without running
+     * the data query again.
+     *
+     * A prefetched window is checked against later database changes with the revisionQuery,
+     * so prefetching is disabled when no revisionQuery is set.
+     *
+     * Set it before the query is first used.
+     *
+     */
+    Q_PROPERTY(int prefetchDepth READ prefetchDepth WRITE setPrefetchDepth)
+
+    /*!
+     * @brief The number of windows which were served from prefetched data.
+     *
+     */
+    Q_PROPERTY(int prefetchHits READ prefetchHits NOTIFY prefetchStatisticsChanged)
+
+    /*!
+     * @brief The number of windows which had to be queried while prefetching was enabled.
+     *
+     */
+    Q_PROPERTY(int prefetchMisses READ prefetchMisses NOTIFY prefetchStatisticsChanged)
+
     /*!
      * @brief The name of the key column in the main query which is returned for each item.
      *
@@ -140,6 +203,33 @@ class SqlDataQuery: public bb::cascades::datamanager::DataQuery {
      */
     Q_PROPERTY(QString revisionQuery READ revisionQuery WRITE setRevisionQuery)
 
+    /*!
+     * @brief An SQL query statement returning the items changed since a given revision.
+     *
+     * Used by getDataDelta(). The revision to compare against is bound to the named
+     * placeholder ":sinceRevision". If not set, the main query is wrapped as
+     * "SELECT * FROM (<query>) WHERE <revisionColumn> > :sinceRevision".
+     *
+     * Once the property is set it cannot be changed.
+     *
+     */
+    Q_PROPERTY(QString deltaQuery READ deltaQuery WRITE setDeltaQuery)
+
+    /*!
+     * @brief An SQL query statement returning the keys of items deleted since a given revision.
+     *
+     * Used by getDataDelta(). Deleting an item removes its row, so the application must
+     * record a tombstone (the key and the overall revision of the delete) for it to be
+     * reported. The revision to compare against is bound to ":sinceRevision". The key is
+     * read from the keyColumn, or from the first column if there is no such column.
+     *
+     * An example:  "SELECT id FROM artist_deleted WHERE revision_id > :sinceRevision"
+     *
+     * Once the property is set it cannot be changed.
+     *
+     */
+    Q_PROPERTY(QString tombstoneQuery READ tombstoneQuery WRITE setTombstoneQuery)
+
     /*!
      * @brief A map of name-to-value bindings.
      *
@@ -211,6 +301,66 @@ public:
     QString scrollUpQuery() const;
     QString scrollDownQuery() const;
 
+    /*!
+     * Set the number of rows between keyset pagination checkpoints.
+     *
+     * @param checkpointInterval The checkpoint interval, or 0 to disable keyset pagination.
+     *
+     */
+    void setCheckpointInterval(int checkpointInterval);
+
+    /*!
+     * Get the number of rows between keyset pagination checkpoints.
+     *
+     * @return The checkpoint interval.
+     *
+     */
+    int checkpointInterval() const;
+
+    /*!
+     * Set whether data item payloads are SqlRowView references instead of QVariantMaps.
+     *
+     * @param rowViewPayloads True to use row view payloads.
+     *
+     */
+    void setRowViewPayloads(bool rowViewPayloads);
+
+    /*!
+     * Get whether data item payloads are SqlRowView references.
+     *
+     * @return True if row view payloads are used.
+     *
+     */
+    bool rowViewPayloads() const;
+
+    /*!
+     * Set the number of windows to load ahead of the data model.
+     *
+     * @param prefetchDepth The prefetch depth, or 0 to disable prefetching.
+     *
+     */
+    void setPrefetchDepth(int prefetchDepth);
+
+    /*!
+     * Get the number of windows to load ahead of the data model.
+     *
+     * @return The prefetch depth.
+     *
+     */
+    int prefetchDepth() const;
+
+    /*!
+     * Get the number of windows which were served from prefetched data.
+     *
+     */
+    int prefetchHits() const;
+
+    /*!
+     * Get the number of windows which had to be queried while prefetching was enabled.
+     *
+     */
+    int prefetchMisses() const;
+
     /*!
      * Set the name of the key column in the main query.
      *
@@ -275,6 +425,38 @@ public:
      */
     QString revisionQuery() const;
 
+    /*!
+     * Set the delta query string.
+     *
+     * @param deltaQuery The delta query string.
+     *
+     */
+    void setDeltaQuery(const QString& deltaQuery);
+
+    /*!
+     * Get the delta query, or the query derived from the main query if none was set.
+     *
+     * @return The deltaQuery string.
+     *
+     */
+    QString deltaQuery() const;
+
+    /*!
+     * Set the tombstone query string.
+     *
+     * @param tombstoneQuery The tombstone query string.
+     *
+     */
+    void setTombstoneQuery(const QString& tombstoneQuery);
+
+    /*!
+     * Get the tombstone query.
+     *
+     * @return The tombstoneQuery string.
+     *
+     */
+    QString tombstoneQuery() const;
+
     /*!
      * Bind values to this query by placeholder name.
      *
@@ -307,6 +489,25 @@ public:
             const bb::cascades::datamanager::DataRevision& requestedRevision,
             QList<bb::cascades::datamanager::DataItem> *results);
 
+    /**
+     * Get only the items which changed after a known overall revision, instead of
+     * reloading whole windows. The cost is proportional to the number of changes.
+     *
+     * Requires a revisionColumn. Changed items are returned in the order of the delta
+     * query, so items can be patched in place by key. Keys of deleted items are only
+     * returned if a tombstoneQuery is set.
+     *
+     * @param sinceRevision The last overall revision seen by the caller. See NumericRevision::revision().
+     * @param[out] revision The current overall revision. Pointer must not be null.
+     * @param[out] changed The items with a revision greater than sinceRevision. Pointer must not be null.
+     * @param[out] deletedKeys The keys of items deleted after sinceRevision. Pointer must not be null.
+     * @return Returns true if the delta could be retrieved, else returns false.
+     */
+    bool getDataDelta(quint64 sinceRevision,
+            bb::cascades::datamanager::DataRevision *revision,
+            QList<bb::cascades::datamanager::DataItem> *changed,
+            QStringList *deletedKeys);
+
     /*!
      * @see DataQuery::toString
      *
@@ -331,12 +532,31 @@ public:
     bool getDataResults(QSqlDatabase &connection, int offset, int limit,
             QList<bb::cascades::datamanager::DataItem> *results);
 
+Q_SIGNALS:
+    /*!
+     * @brief Emitted when the #prefetchHits or #prefetchMisses property has changed.
+     *
+     */
+    void prefetchStatisticsChanged();
+
 private:
+    /**
+     * Remember the items of a loaded window which fall on a checkpoint offset.
+     */
+    void updateCheckpoints(int offset, const QList<bb::cascades::datamanager::DataItem> &results);
+
+    /**
+     * Start loading the windows expected to be requested after the given one.
+     */
+    void startPrefetch(int offset, int limit, const QList<bb::cascades::datamanager::DataItem> &results);
+
     QString m_query;
     QString m_countQuery;
     QString m_revisionQuery;
     QString m_scrollUpQuery;
     QString m_scrollDownQuery;
+    QString m_deltaQuery;
+    QString m_tombstoneQuery;
     QString m_keyColumn;
     QString m_revisionColumn;
     QUrl m_source;
@@ -349,6 +569,15 @@ private:
     int m_totalCount;
     int m_scrollUpCount;
     int m_scrollDownCount;
+    int m_checkpointInterval;
+    bool m_rowViewPayloads;
+    int m_prefetchDepth;
+    int m_lastOffset;
+    SqlPrefetcher m_prefetcher;
+    QMap<int, QVariantMap> m_checkpoints;
+    bb::cascades::datamanager::DataRevision m_lastRevision;
+    int m_keysetSeekCount;
+    qint64 m_keysetSkippedRows;
 
     Q_DECLARE_PRIVATE(SqlDataQuery)
     Q_DISABLE_COPY(SqlDataQuery)
@@ -18,6 +18,7 @@
 #include "SqlTransaction.hpp"
 #include "SqlHeaderDataQuery.hpp"
 #include "SqlQueryUtils.hpp"
+#include "SqlConnectionPool.hpp"
 
 #include <bb/cascades/datamanager/DataItem>
 #include <bb/cascades/datamanager/DataRevision>
@@ -96,6 +97,38 @@ QString SqlHeaderDataQuery::scrollDownQuery() const {
     return m_dataQuery->scrollDownQuery();
 }
 
+void SqlHeaderDataQuery::setCheckpointInterval(int checkpointInterval) {
+    m_dataQuery->setCheckpointInterval(checkpointInterval);
+}
+
+int SqlHeaderDataQuery::checkpointInterval() const {
+    return m_dataQuery->checkpointInterval();
+}
+
+void SqlHeaderDataQuery::setRowViewPayloads(bool rowViewPayloads) {
+    m_dataQuery->setRowViewPayloads(rowViewPayloads);
+}
+
+bool SqlHeaderDataQuery::rowViewPayloads() const {
+    return m_dataQuery->rowViewPayloads();
+}
+
+void SqlHeaderDataQuery::setPrefetchDepth(int prefetchDepth) {
+    m_dataQuery->setPrefetchDepth(prefetchDepth);
+}
+
+int SqlHeaderDataQuery::prefetchDepth() const {
+    return m_dataQuery->prefetchDepth();
+}
+
+int SqlHeaderDataQuery::prefetchHits() const {
+    return m_dataQuery->prefetchHits();
+}
+
+int SqlHeaderDataQuery::prefetchMisses() const {
+    return m_dataQuery->prefetchMisses();
+}
+
 void SqlHeaderDataQuery::setKeyColumn(const QString& keyColumn) {
     m_dataQuery->setKeyColumn(keyColumn);
 }
@@ -169,8 +202,9 @@ bool SqlHeaderDataQuery::getHeaderData(int offset, int limit,
     bool result = false;
     // get the open db connection and start a transaction
     SqlQueryUtils utils;
-    QSqlDatabase connection = utils.connection(m_dataQuery->source(),
+    SqlPooledConnection pooled(m_dataQuery->source(), SqlConnectionPool::Read,
             m_dataQuery->sqlError());
+    QSqlDatabase connection = pooled.connection();
     if (m_dataQuery->sqlError()->type() == QSqlError::NoError) {
         SqlTransaction tx(connection);
         if (m_dataQuery->getDatabaseRevision(connection, revision)) {
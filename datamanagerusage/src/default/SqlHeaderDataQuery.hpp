@@ -58,6 +58,44 @@ class SqlHeaderDataQuery: public bb::cascades::datamanager::HeaderDataQuery {
     Q_PROPERTY(QString scrollUpQuery READ scrollUpQuery WRITE setScrollUpQuery)
     Q_PROPERTY(QString scrollDownQuery READ scrollDownQuery WRITE setScrollDownQuery)
 
+    /*!
+     * @brief The number of rows between keyset pagination checkpoints. Default is 0 (disabled).
+     *
+     * @see SqlDataQuery::checkpointInterval
+     *
+     */
+    Q_PROPERTY(int checkpointInterval READ checkpointInterval WRITE setCheckpointInterval)
+
+    /*!
+     * @brief Whether data items reference a column oriented result buffer. Default is false.
+     *
+     * Only applies to the data items; header items always have QVariantMap payloads.
+     *
+     * @see SqlDataQuery::rowViewPayloads
+     *
+     */
+    Q_PROPERTY(bool rowViewPayloads READ rowViewPayloads WRITE setRowViewPayloads)
+
+    /*!
+     * @brief The number of windows to load ahead of the data model. Default is 0 (disabled).
+     *
+     * @see SqlDataQuery::prefetchDepth
+     *
+     */
+    Q_PROPERTY(int prefetchDepth READ prefetchDepth WRITE setPrefetchDepth)
+
+    /*!
+     * @brief The number of windows which were served from prefetched data.
+     *
+     */
+    Q_PROPERTY(int prefetchHits READ prefetchHits)
+
+    /*!
+     * @brief The number of windows which had to be queried while prefetching was enabled.
+     *
+     */
+    Q_PROPERTY(int prefetchMisses READ prefetchMisses)
+
     /*!
      * @brief The header data query for retrieving header items from the database. Mandatory.
      *
@@ -220,6 +258,66 @@ public:
     QString scrollUpQuery() const;
     QString scrollDownQuery() const;
 
+    /*!
+     * Set the number of rows between keyset pagination checkpoints.
+     *
+     * @param checkpointInterval The checkpoint interval, or 0 to disable keyset pagination.
+     *
+     */
+    void setCheckpointInterval(int checkpointInterval);
+
+    /*!
+     * Get the number of rows between keyset pagination checkpoints.
+     *
+     * @return The checkpoint interval.
+     *
+     */
+    int checkpointInterval() const;
+
+    /*!
+     * Set whether data item payloads are SqlRowView references instead of QVariantMaps.
+     *
+     * @param rowViewPayloads True to use row view payloads.
+     *
+     */
+    void setRowViewPayloads(bool rowViewPayloads);
+
+    /*!
+     * Get whether data item payloads are SqlRowView references.
+     *
+     * @return True if row view payloads are used.
+     *
+     */
+    bool rowViewPayloads() const;
+
+    /*!
+     * Set the number of windows to load ahead of the data model.
+     *
+     * @param prefetchDepth The prefetch depth, or 0 to disable prefetching.
+     *
+     */
+    void setPrefetchDepth(int prefetchDepth);
+
+    /*!
+     * Get the number of windows to load ahead of the data model.
+     *
+     * @return The prefetch depth.
+     *
+     */
+    int prefetchDepth() const;
+
+    /*!
+     * Get the number of windows which were served from prefetched data.
+     *
+     */
+    int prefetchHits() const;
+
+    /*!
+     * Get the number of windows which had to be queried while prefetching was enabled.
+     *
+     */
+    int prefetchMisses() const;
+
     /*!
      * Set the SQL header query statement. Mandatory.
      *
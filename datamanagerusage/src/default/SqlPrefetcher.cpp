@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SqlPrefetcher.hpp"
+#include "NumericRevision.hpp"
+#include "SqlConnectionPool.hpp"
+#include "SqlQueryUtils.hpp"
+#include "SqlResultSet.hpp"
+#include "SqlTransaction.hpp"
+
+#include <QtConcurrentRun>
+#include <QtSql/QSqlError>
+#include <QDebug>
+
+using namespace bb::cascades::datamanager;
+
+SqlPrefetcher::SqlPrefetcher()
+    : m_running(false)
+    , m_hitCount(0)
+    , m_missCount(0) {
+}
+
+SqlPrefetcher::~SqlPrefetcher() {
+}
+
+void SqlPrefetcher::start(const SqlPrefetchRequest &request) {
+    collect();
+    if (m_running || request.depth <= 0 || request.limit <= 0) {
+        return;
+    }
+
+    // keep the windows which are part of the new plan and skip loading them again
+    QList<SqlPrefetchWindow> planned;
+    for (int i = 0; i < request.depth; ++i) {
+        int index = indexOf(windowOffset(request, i), request.limit);
+        if (index >= 0) {
+            planned.append(m_windows.at(index));
+        }
+    }
+    SqlPrefetchRequest remaining = request;
+    int index;
+    while (0 < remaining.depth && (index = indexOf(remaining.offset, remaining.limit)) >= 0) {
+        const SqlPrefetchWindow &window = m_windows.at(index);
+        if (remaining.scrollDown && window.items.size() < remaining.limit) {
+            // the end of the result set is already loaded
+            remaining.depth = 0;
+            break;
+        }
+        if (remaining.scrollDown && !remaining.anchor.isEmpty()) {
+            remaining.anchor = SqlRowView::toMap(window.items.last().payload());
+        }
+        remaining.offset = windowOffset(remaining, 1);
+        --remaining.depth;
+    }
+    m_windows = planned;
+
+    if (0 < remaining.depth && 0 <= remaining.offset) {
+        m_future = QtConcurrent::run(&SqlPrefetcher::fetch, remaining);
+        m_running = true;
+    }
+}
+
+bool SqlPrefetcher::take(int offset, int limit, const DataRevision &revision, QList<DataItem> *results) {
+    // never wait for a window still being loaded: the caller holds a reader
+    // checkout which the prefetch may need to finish
+    collect();
+
+    // windows for an older revision can never be used, nor can windows whose
+    // revision is unknown since later changes would go unnoticed
+    for (int i = m_windows.size() - 1; i >= 0; --i) {
+        if (!(m_windows.at(i).revision == revision) || m_windows.at(i).revision == DataRevision()) {
+            m_windows.removeAt(i);
+        }
+    }
+
+    int index = indexOf(offset, limit);
+    if (index < 0) {
+        m_missCount.ref();
+        return false;
+    }
+    *results = m_windows.takeAt(index).items;
+    m_hitCount.ref();
+    return true;
+}
+
+void SqlPrefetcher::clear() {
+    collect();
+    m_windows.clear();
+}
+
+int SqlPrefetcher::hitCount() const {
+    return m_hitCount;
+}
+
+int SqlPrefetcher::missCount() const {
+    return m_missCount;
+}
+
+int SqlPrefetcher::windowOffset(const SqlPrefetchRequest &request, int window) {
+    return request.scrollDown ? request.offset + window * request.limit : request.offset - window * request.limit;
+}
+
+int SqlPrefetcher::indexOf(int offset, int limit) const {
+    for (int i = 0, n = m_windows.size(); i < n; ++i) {
+        if (m_windows.at(i).offset == offset && m_windows.at(i).limit == limit) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void SqlPrefetcher::collect() {
+    if (m_running && m_future.isFinished()) {
+        m_windows.append(m_future.result());
+        m_future = QFuture<QList<SqlPrefetchWindow> >();
+        m_running = false;
+    }
+}
+
+/**
+ * Runs on a pooled thread with that thread's reader connection from the pool, if a
+ * reader checkout is free. Only the request copy is used.
+ */
+QList<SqlPrefetchWindow> SqlPrefetcher::fetch(SqlPrefetchRequest request) {
+    QList<SqlPrefetchWindow> windows;
+    SqlQueryUtils utils;
+    QSqlError error;
+    SqlPooledConnection pooled(request.source, SqlConnectionPool::Read, &error, false);
+    QSqlDatabase connection = pooled.connection();
+    if (error.type() != QSqlError::NoError) {
+        return windows;
+    }
+    if (!connection.isValid()) {
+        // all readers are busy; a prefetch is not worth waiting for
+        qDebug() << "Prefetch skipped, no reader connection is free";
+        return windows;
+    }
+    SqlTransaction tx(connection);
+
+    // the overall revision, read the same way as SqlDataQuery::getDatabaseRevision
+    DataRevision revision;
+    if (!request.revisionQuery.isEmpty()) {
+        QVariant resultRevision;
+        if (!utils.getSingleQueryValue(connection, request.revisionQuery, request.bindValues, "",
+                &resultRevision, &error)) {
+            qWarning() << "Prefetch failed to fetch the database revision.";
+            return windows;
+        }
+        bool revisionOK = false;
+        quint64 numericRevision = resultRevision.toULongLong(&revisionOK);
+        if (revisionOK) {
+            revision = DataRevision(new NumericRevision(numericRevision));
+        }
+    }
+
+    QVariantMap anchor = request.anchor;
+    for (int i = 0; i < request.depth; ++i) {
+        SqlPrefetchWindow window;
+        window.offset = windowOffset(request, i);
+        window.limit = request.limit;
+        window.revision = revision;
+        if (window.offset < 0) {
+            break;
+        }
+
+        QString queryToUse = request.query;
+        QVariantMap valuesToUse = request.bindValues;
+        int offsetToUse = window.offset;
+        if (request.scrollDown && !anchor.isEmpty()) {
+            // continue from the last item before the window
+            queryToUse = request.scrollDownQuery;
+            valuesToUse.unite(anchor);
+            offsetToUse = 0;
+        }
+
+        bool loaded;
+        if (request.rowViewPayloads) {
+            SqlResultSet resultSet;
+            loaded = utils.getQueryData(connection, queryToUse, offsetToUse, request.limit, valuesToUse,
+                    &resultSet, &error);
+            window.items = resultSet.dataItems(request.keyColumn, request.revisionColumn);
+        } else {
+            loaded = utils.getQueryData(connection, queryToUse, offsetToUse, request.limit, valuesToUse,
+                    request.keyColumn, request.revisionColumn, &window.items, &error);
+        }
+        if (!loaded) {
+            qWarning() << "Prefetch failed to load the data: " << error;
+            break;
+        }
+        windows.append(window);
+
+        if (request.scrollDown) {
+            if (window.items.size() < request.limit) {
+                // the end of the result set
+                break;
+            }
+            if (!anchor.isEmpty()) {
+                anchor = SqlRowView::toMap(window.items.last().payload());
+            }
+        }
+    }
+    qDebug() << "Prefetched " << windows.size() << " windows from offset " << request.offset;
+    return windows;
+}
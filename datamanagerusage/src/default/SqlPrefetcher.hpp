@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SQLPREFETCHER_HPP
+#define SQLPREFETCHER_HPP
+
+#include <bb/cascades/datamanager/DataItem>
+#include <bb/cascades/datamanager/DataRevision>
+#include <QAtomicInt>
+#include <QFuture>
+#include <QList>
+#include <QString>
+#include <QUrl>
+#include <QVariant>
+
+/*!
+ * The description of the windows a SqlPrefetcher should load ahead of time.
+ *
+ */
+struct SqlPrefetchRequest
+{
+    SqlPrefetchRequest()
+        : offset(0)
+        , limit(0)
+        , depth(0)
+        , scrollDown(true)
+        , rowViewPayloads(false) {
+    }
+
+    QUrl source;
+    QString query;
+    QString scrollDownQuery;
+    QString revisionQuery;
+    QString keyColumn;
+    QString revisionColumn;
+    QVariantMap bindValues;
+    // the payload of the item just before offset, used with scrollDownQuery
+    QVariantMap anchor;
+    // the first window to load
+    int offset;
+    int limit;
+    // the number of consecutive windows to load
+    int depth;
+    // true if the windows follow offset, false if they precede it
+    bool scrollDown;
+    bool rowViewPayloads;
+};
+
+/*!
+ * A window of data items loaded by a SqlPrefetcher.
+ *
+ */
+struct SqlPrefetchWindow
+{
+    SqlPrefetchWindow()
+        : offset(0)
+        , limit(0) {
+    }
+
+    int offset;
+    int limit;
+    bb::cascades::datamanager::DataRevision revision;
+    QList<bb::cascades::datamanager::DataItem> items;
+};
+
+/*!
+ * @brief Loads the next windows of a SqlDataQuery on a pooled thread before they are requested.
+ *
+ * SqlDataQuery starts a prefetch after each window it returns, in the direction the list is
+ * being scrolled. When the data model then asks for one of the prefetched windows, and the
+ * database revision has not changed, the items are handed over without running the data
+ * query again. If the requested window is still being loaded the caller does not wait
+ * for it, since it may hold the reader connection the prefetch needs, and runs the
+ * query itself.
+ *
+ * The prefetch runs on the pooled thread's own reader connection from the
+ * SqlConnectionPool inside its own transaction, and only works on a copy of the
+ * request so it never touches the SqlDataQuery itself. It is skipped when no reader
+ * checkout is free, rather than waiting for one.
+ *
+ * @see SqlDataQuery::prefetchDepth
+ *
+ */
+class SqlPrefetcher
+{
+public:
+    /*!
+     * Constructor.
+     *
+     */
+    SqlPrefetcher();
+
+    /*!
+     * Destructor. A running prefetch is left to finish on its own.
+     *
+     */
+    virtual ~SqlPrefetcher();
+
+    /*!
+     * Start loading the windows described by request, unless a prefetch is still running.
+     * Windows which are already loaded are kept and not loaded again; other windows left
+     * over from an earlier prefetch are discarded.
+     *
+     */
+    void start(const SqlPrefetchRequest &request);
+
+    /*!
+     * Take a prefetched window. Never waits for the running prefetch; a window it is
+     * still loading is a miss.
+     *
+     * @param offset The offset of the requested window.
+     * @param limit The limit of the requested window.
+     * @param revision The current overall database revision. A window loaded for a
+     * different or an empty revision is not used.
+     * @param[out] results The items of the window if one was found. Pointer must not be null.
+     * @return Returns true on a hit, else returns false.
+     *
+     */
+    bool take(int offset, int limit, const bb::cascades::datamanager::DataRevision &revision,
+            QList<bb::cascades::datamanager::DataItem> *results);
+
+    /*!
+     * Discard all prefetched windows.
+     *
+     */
+    void clear();
+
+    /*!
+     * Get the number of requests served from a prefetched window.
+     *
+     */
+    int hitCount() const;
+
+    /*!
+     * Get the number of requests for which no prefetched window could be used.
+     *
+     */
+    int missCount() const;
+
+private:
+    static QList<SqlPrefetchWindow> fetch(SqlPrefetchRequest request);
+    static int windowOffset(const SqlPrefetchRequest &request, int window);
+    int indexOf(int offset, int limit) const;
+    void collect();
+
+    QFuture<QList<SqlPrefetchWindow> > m_future;
+    bool m_running;
+    QList<SqlPrefetchWindow> m_windows;
+    QAtomicInt m_hitCount;
+    QAtomicInt m_missCount;
+
+    Q_DISABLE_COPY(SqlPrefetcher)
+};
+
+#endif /* SQLPREFETCHER_HPP */
@@ -39,8 +39,15 @@ using namespace bb::cascades::datamanager;
 ///////////////////////// File scope helper functions//////////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 static QVariant valueLookup(const QVariantMap& bindValues, QString key);
+static QStringList createPositionalQuery(QString& baseSql);
 static QVariantList createPositionalQueryAndList(QString& baseSql, const QVariantMap& bindValues);
 static void bindParameters(const QVariantList& bindValues, QSqlQuery *sqlQuery);
+static void bindParameters(const QStringList& parameters, const QVariantMap& bindValues, QSqlQuery *sqlQuery);
+static void bindParameters(const QStringList& parameters, const QVariantMap& rowValues, const QVariantMap& bindValues,
+        QSqlQuery *sqlQuery);
+
+// appended to queries prepared by cachedPagedQuery(); limit and offset are bound like any other value
+static const char *PAGED_QUERY_SUFFIX = " limit ? offset ?";
 
 SqlQueryUtils::SqlQueryUtils() {
 }
@@ -61,28 +68,35 @@ QSqlDatabase SqlQueryUtils::connection(const QUrl &source, QSqlError *error) {
     QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
 
     if (!connection.isOpen()) {
-        if (sourcePath.isEmpty()) {
-            *error = QSqlError("", "missing database name", QSqlError::ConnectionError);
+        connection = openConnection(sourcePath, connectionName, error);
+    }
+    return connection;
+}
+
+QSqlDatabase SqlQueryUtils::openConnection(const QString &sourcePath, const QString &connectionName,
+        QSqlError *error) {
+    QSqlDatabase connection;
+    if (sourcePath.isEmpty()) {
+        *error = QSqlError("", "missing database name", QSqlError::ConnectionError);
+    } else {
+        connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+        connection.setDatabaseName(sourcePath);
+        if (!connection.isValid()) {
+            // invalid driver
+            *error = QSqlError("", "invalid database driver", QSqlError::ConnectionError);
         } else {
-            connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
-            connection.setDatabaseName(sourcePath);
-            if (!connection.isValid()) {
-                // invalid driver
-                *error = QSqlError("", "invalid database driver", QSqlError::ConnectionError);
+            QFileInfo dbFile(sourcePath);
+            if (!dbFile.exists()) {
+                *error = QSqlError("", "no existing database found \"" + sourcePath + "\"",
+                        QSqlError::ConnectionError);
             } else {
-                QFileInfo dbFile(sourcePath);
-                if (!dbFile.exists()) {
-                    *error = QSqlError("", "no existing database found \"" + sourcePath + "\"",
+                bool success = connection.open();
+                if (!success) {
+                    *error = QSqlError("", "unable to open existing database \"" + sourcePath + "\"",
                             QSqlError::ConnectionError);
                 } else {
-                    bool success = connection.open();
-                    if (!success) {
-                        *error = QSqlError("", "unable to open existing database \"" + sourcePath + "\"",
-                                QSqlError::ConnectionError);
-                    } else {
-                        // success
-                        *error = QSqlError();
-                    }
+                    // success
+                    *error = QSqlError();
                 }
             }
         }
@@ -104,14 +118,17 @@ bool SqlQueryUtils::getQueryData(QSqlDatabase &connection, const QString &query,
     timer.start();
     results->clear();
 
-    QSqlQuery sqlQuery(connection);
-    QString fullQuery = extendQuery(query, offset, limit);
-    SqlQueryUtils::prepareQuery(fullQuery, bindValues, &sqlQuery);
+    QSqlQuery *cachedSqlQuery = cachedPagedQuery(connection, query, offset, limit, bindValues, error);
+    if (cachedSqlQuery == NULL) {
+        return false;
+    }
+    QSqlQuery &sqlQuery = *cachedSqlQuery;
 
     bool success = sqlQuery.exec();
     if (!success) {
         *error = sqlQuery.lastError();
         qDebug() << "query error: " << *error;
+        sqlQuery.finish();
         return false;
     }
     QList<QString> field;
@@ -153,20 +170,61 @@ bool SqlQueryUtils::getQueryData(QSqlDatabase &connection, const QString &query,
         results->append(DataItem(keyId, dataRev, recordMap));
     }
 
+    sqlQuery.finish();
+
     qDebug() << "Query executed: " << sqlQuery.executedQuery();
     qDebug() << "Loaded " << results->size() << " items in " << timer.elapsed() << "ms";
     return true;
 }
 
+bool SqlQueryUtils::getQueryData(QSqlDatabase &connection, const QString &query, int offset, int limit,
+        const QVariantMap &bindValues, SqlResultSet *results, QSqlError *error) {
+    QElapsedTimer timer;
+    timer.start();
+    results->clear();
+
+    QSqlQuery *cachedSqlQuery = cachedPagedQuery(connection, query, offset, limit, bindValues, error);
+    if (cachedSqlQuery == NULL) {
+        return false;
+    }
+    QSqlQuery &sqlQuery = *cachedSqlQuery;
+
+    bool success = sqlQuery.exec();
+    if (!success) {
+        *error = sqlQuery.lastError();
+        qDebug() << "query error: " << *error;
+        sqlQuery.finish();
+        return false;
+    }
+    // one field name table for the whole result
+    QSqlRecord record = sqlQuery.record();
+    QStringList field;
+    for (int i = 0, n = record.count(); i < n; i++) {
+        field.append(record.fieldName(i));
+    }
+    results->setFieldNames(field);
+    while (sqlQuery.next()) {
+        results->appendRow(sqlQuery);
+    }
+    sqlQuery.finish();
+
+    qDebug() << "Query executed: " << sqlQuery.executedQuery();
+    qDebug() << "Loaded " << results->rowCount() << " rows in " << timer.elapsed() << "ms";
+    return true;
+}
+
 bool SqlQueryUtils::getSingleQueryValue(QSqlDatabase &connection, const QString &query, const QVariantMap &bindValues,
         const QString &resultName, QVariant *resultValue, QSqlError *error) {
     QElapsedTimer timer;
     timer.start();
 
-    QSqlQuery sqlQuery(connection);
-    SqlQueryUtils::prepareQuery(query, bindValues, &sqlQuery);
-
     *resultValue = QVariant();
+    QSqlQuery *cachedSqlQuery = cachedQuery(connection, query, bindValues, error);
+    if (cachedSqlQuery == NULL) {
+        return false;
+    }
+    QSqlQuery &sqlQuery = *cachedSqlQuery;
+
     bool success = sqlQuery.exec();
     if (success && sqlQuery.next()) {
         QSqlRecord record = sqlQuery.record();
@@ -179,9 +237,12 @@ bool SqlQueryUtils::getSingleQueryValue(QSqlDatabase &connection, const QString
                 break;
             }
         }
+        // only the first row is read so release the statement explicitly
+        sqlQuery.finish();
     } else {
         *error = sqlQuery.lastError();
         qDebug() << "query error: " << *error;
+        sqlQuery.finish();
         return false;
     }
 
@@ -263,6 +324,80 @@ void SqlQueryUtils::prepareQuery(const QString &query, const QVariantMap &bindVa
     }
 }
 
+QSqlQuery *SqlQueryUtils::cachedQuery(QSqlDatabase &connection, const QString &query,
+        const QVariantMap &bindValues, QSqlError *error) {
+    SqlStatementCache::Statement *statement = cachedStatement(connection, query, false, error);
+    if (statement == NULL) {
+        return NULL;
+    }
+    bindParameters(statement->parameters, bindValues, &statement->query);
+    return &statement->query;
+}
+
+QSqlQuery *SqlQueryUtils::cachedPagedQuery(QSqlDatabase &connection, const QString &query, int offset, int limit,
+        const QVariantMap &bindValues, QSqlError *error) {
+    SqlStatementCache::Statement *statement = cachedStatement(connection, query, true, error);
+    if (statement == NULL) {
+        return NULL;
+    }
+    bindParameters(statement->parameters, bindValues, &statement->query);
+    // limit and offset are the two trailing positional placeholders added by cachedStatement()
+    int position = statement->parameters.size();
+    statement->query.bindValue(position, limit);
+    statement->query.bindValue(position + 1, offset);
+    return &statement->query;
+}
+
+bool SqlQueryUtils::execBatch(QSqlDatabase &connection, const QString &query, const QVariantMap &bindValues,
+        const QVariantList &bindValueRows, int *rowsAffected, QSqlError *error) {
+    *rowsAffected = 0;
+    SqlStatementCache::Statement *statement = cachedStatement(connection, query, false, error);
+    if (statement == NULL) {
+        return false;
+    }
+    // QSqlQuery::execBatch() is emulated by the SQLite driver as one exec() per row without
+    // per row counts, so run the prepared statement directly and sum the changed rows.
+    QSqlQuery &sqlQuery = statement->query;
+    for (int i = 0, n = bindValueRows.size(); i < n; i++) {
+        bindParameters(statement->parameters, bindValueRows.at(i).toMap(), bindValues, &sqlQuery);
+        if (!sqlQuery.exec()) {
+            *error = sqlQuery.lastError();
+            qDebug() << "query error: " << *error << " in batch row " << i;
+            sqlQuery.finish();
+            return false;
+        }
+        *rowsAffected += qMax(0, sqlQuery.numRowsAffected());
+    }
+    sqlQuery.finish();
+    return true;
+}
+
+SqlStatementCache::Statement *SqlQueryUtils::cachedStatement(QSqlDatabase &connection, const QString &query,
+        bool paged, QSqlError *error) {
+    // paged and unpaged forms of the same query text are different statements
+    QString key = paged ? query + QLatin1String(PAGED_QUERY_SUFFIX) : query;
+    SqlStatementCache *cache = SqlStatementCache::instance();
+    SqlStatementCache::Statement *statement = cache->statement(connection, key);
+    if (statement != NULL) {
+        return statement;
+    }
+
+    QString positionalQuery(query);
+    QScopedPointer<SqlStatementCache::Statement> newStatement(new SqlStatementCache::Statement(connection));
+    newStatement->parameters = createPositionalQuery(positionalQuery);
+    if (paged) {
+        positionalQuery += QLatin1String(PAGED_QUERY_SUFFIX);
+    }
+    // results are only ever read forward so avoid caching rows in the driver
+    newStatement->query.setForwardOnly(true);
+    if (!newStatement->query.prepare(positionalQuery)) {
+        *error = newStatement->query.lastError();
+        qDebug() << "query error: " << *error;
+        return NULL;
+    }
+    return cache->insert(connection, key, newStatement.take());
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 ///////////////////////// File scope helper functions//////////////////////////
@@ -276,43 +411,53 @@ static QVariant valueLookup(const QVariantMap& bindValues, QString key) {
     return bindValues.value(key);
 }
 
-static QVariantList createPositionalQueryAndList(QString& baseSql, const QVariantMap& bindValues) {
-    QVariantList values;
+// replace named placeholders with positional ones and return the names in positional order
+static QStringList createPositionalQuery(QString& baseSql) {
+    QStringList parameters;
 
-    if (bindValues.size() > 0) {
-        //Note: the below algorithm is based on QSqlResultPrivate::namedToPositionalBinding
-        //in an attempt to keep this code in sync with QT's param parsing.
+    //Note: the below algorithm is based on QSqlResultPrivate::namedToPositionalBinding
+    //in an attempt to keep this code in sync with QT's param parsing.
 
-        int length = baseSql.length();
-        bool inEscape = false;
+    int length = baseSql.length();
+    bool inEscape = false;
 
-        for (int i = 0; i < length;) {
-            QChar ch = baseSql.at(i);
-            if (ch == QLatin1Char(':') && !inEscape && (i == 0 || baseSql.at(i - 1) != QLatin1Char(':'))
-                    && (i + 1 < length && (baseSql.at(i + 1)).isLetterOrNumber())) {
+    for (int i = 0; i < length;) {
+        QChar ch = baseSql.at(i);
+        if (ch == QLatin1Char(':') && !inEscape && (i == 0 || baseSql.at(i - 1) != QLatin1Char(':'))
+                && (i + 1 < length && (baseSql.at(i + 1)).isLetterOrNumber())) {
 
-                //fast forward to end of term
-                int end = i + 2;
-                for (; end < length && baseSql.at(end).isLetterOrNumber(); ++end)
-                    ;
+            //fast forward to end of term
+            int end = i + 2;
+            for (; end < length && baseSql.at(end).isLetterOrNumber(); ++end)
+                ;
 
-                //extract value for this term
-                QString oldKey = baseSql.mid(i, end - i);
+            //extract name for this term
+            QString oldKey = baseSql.mid(i, end - i);
 
-                //replace term with unique term
-                baseSql.replace(i, end - i, '?');
-                values.append(valueLookup(bindValues, oldKey));
-                //values.append(bindValues.value(oldKey));
+            //replace term with unique term
+            baseSql.replace(i, end - i, '?');
+            parameters.append(oldKey);
 
-                //correct loop variables
-                length = baseSql.length();
-                i = end + (1 - oldKey.length());
-            } else {
-                if (ch == QLatin1Char('\'')) {
-                    inEscape = !inEscape;
-                }
-                ++i;
+            //correct loop variables
+            length = baseSql.length();
+            i = end + (1 - oldKey.length());
+        } else {
+            if (ch == QLatin1Char('\'')) {
+                inEscape = !inEscape;
             }
+            ++i;
+        }
+    }
+    return parameters;
+}
+
+static QVariantList createPositionalQueryAndList(QString& baseSql, const QVariantMap& bindValues) {
+    QVariantList values;
+
+    if (bindValues.size() > 0) {
+        QStringList parameters = createPositionalQuery(baseSql);
+        for (int i = 0, n = parameters.size(); i < n; ++i) {
+            values.append(valueLookup(bindValues, parameters.at(i)));
         }
     }
     return values;
@@ -327,3 +472,21 @@ static void bindParameters(const QVariantList& bindValues, QSqlQuery *sqlQuery)
     }
 }
 
+static void bindParameters(const QStringList& parameters, const QVariantMap& bindValues, QSqlQuery *sqlQuery) {
+    for (int i = parameters.length() - 1; i >= 0; --i) {
+        sqlQuery->bindValue(i, valueLookup(bindValues, parameters.at(i)));
+    }
+}
+
+// values in the row take precedence over the shared bind values
+static void bindParameters(const QStringList& parameters, const QVariantMap& rowValues, const QVariantMap& bindValues,
+        QSqlQuery *sqlQuery) {
+    for (int i = parameters.length() - 1; i >= 0; --i) {
+        QString key = parameters.at(i);
+        if (!rowValues.contains(key) && !rowValues.contains(key.mid(1))) {
+            sqlQuery->bindValue(i, valueLookup(bindValues, key));
+        } else {
+            sqlQuery->bindValue(i, valueLookup(rowValues, key));
+        }
+    }
+}
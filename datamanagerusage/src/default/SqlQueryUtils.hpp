@@ -20,6 +20,8 @@
 #include <bb/cascades/datamanager/Global>
 #include <bb/cascades/datamanager/DataItem>
 #include <bb/cascades/datamanager/HeaderDataItem>
+#include "SqlResultSet.hpp"
+#include "SqlStatementCache.hpp"
 #include <QList>
 #include <QScopedPointer>
 #include <QString>
@@ -65,6 +67,19 @@ public:
      */
     QSqlDatabase connection(const QUrl &source, QSqlError *error);
 
+    /*!
+     * Add and open a new named connection to the database at the source path.
+     *
+     * @param sourcePath The absolute path to the local database.
+     * @param connectionName The name to register the connection under.
+     * @param[out] error The error object to update with the status. Pointer must not be null.
+     * If OK, then QSqlError::type() will be QSqlError::NoError.
+     *
+     * @return The QSqlDatabase object to use as an open connection to the database.
+     *
+     */
+    QSqlDatabase openConnection(const QString &sourcePath, const QString &connectionName, QSqlError *error);
+
     /*!
      * Execute the supplied SQL query after binding any values and return a single result value.
      *
@@ -99,6 +114,25 @@ public:
          const QVariantMap &bindValues, const QString &keyColumn, const QString &revisionColumn,
          QList<bb::cascades::datamanager::DataItem> *results, QSqlError *error);
 
+    /*!
+     * Execute the supplied SQL data query after applying limit and offset and binding any values,
+     * decoding the rows into a column oriented result set instead of a QVariantMap per row.
+     *
+     * @param connection The open database connection.
+     * @param query The SQL data query.
+     * @param offset The index offset within the view. A negative offset is ignored.
+     * @param limit The number of items to retrieve. A negative limit means both limit and offset are ignored.
+     * @param bindValues A map used to replace any named placeholders in the query with values.
+     * @param[out] results The result set which is the return data. Pointer must not be null.
+     * @param[out] error The error object to update with the status. Pointer must not be null.
+     * @return Returns true if the data could be successfully retrieved, else returns false.
+     *
+     * @see SqlResultSet::dataItems
+     *
+     */
+    bool getQueryData(QSqlDatabase &connection, const QString &query, int offset, int limit,
+         const QVariantMap &bindValues, SqlResultSet *results, QSqlError *error);
+
     /*!
      * Extend the given query string with offset and/or limit and return the modified string.
      * Offset cannot be used without limit.
@@ -127,6 +161,55 @@ public:
      */
     void prepareQuery(const QString &query, const QVariantMap &bindValues, QSqlQuery *sqlQuery);
 
+    /**
+     * Return a prepared query for the given query string with the bindValues bound to it.
+     *
+     * The query is taken from the SqlStatementCache of the connection, so the
+     * named-to-positional rewrite and the prepare are only done the first time a query
+     * string is used on a connection. Later calls only bind the values again.
+     * Call QSqlQuery::finish() when done with the results.
+     *
+     * @param connection The open database connection.
+     * @param query The SQL query with named placeholders.
+     * @param bindValues A map used to replace any named placeholders in the query with values.
+     * @param[out] error The error object to update with the status. Pointer must not be null.
+     * @return The prepared query owned by the cache, or 0 if the query could not be prepared.
+     */
+    QSqlQuery *cachedQuery(QSqlDatabase &connection, const QString &query, const QVariantMap &bindValues,
+            QSqlError *error);
+
+    /**
+     * Same as cachedQuery() but the query is extended with limit and offset placeholders
+     * so that every page of a query shares one prepared statement.
+     *
+     * @param offset The index offset within the view.
+     * @param limit The number of items to retrieve. A negative limit means no limit.
+     */
+    QSqlQuery *cachedPagedQuery(QSqlDatabase &connection, const QString &query, int offset, int limit,
+            const QVariantMap &bindValues, QSqlError *error);
+
+    /**
+     * Execute the query once for each row of bind values using a single prepared statement.
+     *
+     * @param connection The open database connection.
+     * @param query The SQL query with named placeholders.
+     * @param bindValues Values used for any placeholder which is not in a row.
+     * @param bindValueRows A list of maps, each one used to replace the named placeholders for one execution.
+     * @param[out] rowsAffected The total number of rows changed by all executions. Pointer must not be null.
+     * @param[out] error The error object to update with the status. Pointer must not be null.
+     * @return Returns true if every execution succeeded, else returns false.
+     */
+    bool execBatch(QSqlDatabase &connection, const QString &query, const QVariantMap &bindValues,
+            const QVariantList &bindValueRows, int *rowsAffected, QSqlError *error);
+
+private:
+    /**
+     * Look up or prepare and cache the statement for the query, optionally extended
+     * with positional limit and offset placeholders.
+     */
+    SqlStatementCache::Statement *cachedStatement(QSqlDatabase &connection, const QString &query, bool paged,
+            QSqlError *error);
+
 };
 
 #endif /* SQLQUERYUTILS_HPP */
@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SqlResultSet.hpp"
+#include "NumericRevision.hpp"
+
+#include <QHash>
+#include <QSharedData>
+#include <QVector>
+
+using namespace bb::cascades::datamanager;
+
+/*
+ * The values of one result column. The vector matching the storage is used;
+ * NULL values are flagged in nulls and take a default value in that vector.
+ */
+class SqlColumn
+{
+public:
+    enum Storage {
+        Empty,   // no non-NULL value seen yet
+        Integer,
+        Real,
+        Text,
+        Blob,
+        Generic  // mixed or unusual types
+    };
+
+    SqlColumn()
+        : storage(Empty)
+        , type(QVariant::Invalid) {
+    }
+
+    void append(const QVariant &value) {
+        bool isNull = value.isNull();
+        if (isNull && storage == Empty) {
+            // remember the type of the driver's null value until a real value decides the storage
+            type = value.type();
+        } else if (!isNull && storage == Empty) {
+            setStorage(value.type());
+        } else if (!isNull && storage != Generic && value.type() != type) {
+            convertToGeneric();
+        }
+        nulls.append(isNull);
+        switch (storage) {
+        case Empty:
+            break;
+        case Integer:
+            integers.append(isNull ? 0 : value.toLongLong());
+            break;
+        case Real:
+            reals.append(isNull ? 0.0 : value.toDouble());
+            break;
+        case Text:
+            texts.append(isNull ? QString() : value.toString());
+            break;
+        case Blob:
+            blobs.append(isNull ? QByteArray() : value.toByteArray());
+            break;
+        case Generic:
+            generic.append(value);
+            break;
+        }
+    }
+
+    QVariant value(int row) const {
+        if (nulls.at(row)) {
+            // a null value of the column type, as the driver returns it
+            return storage == Generic ? generic.at(row) : QVariant(type);
+        }
+        switch (storage) {
+        case Integer:
+            return type == QVariant::Int ? QVariant(int(integers.at(row))) : QVariant(integers.at(row));
+        case Real:
+            return QVariant(reals.at(row));
+        case Text:
+            return QVariant(texts.at(row));
+        case Blob:
+            return QVariant(blobs.at(row));
+        case Generic:
+            return generic.at(row);
+        case Empty:
+            break;
+        }
+        return QVariant();
+    }
+
+    Storage storage;
+    QVariant::Type type;
+    QVector<bool> nulls;
+    QVector<qint64> integers;
+    QVector<double> reals;
+    QVector<QString> texts;
+    QVector<QByteArray> blobs;
+    QVector<QVariant> generic;
+
+private:
+    void setStorage(QVariant::Type valueType) {
+        switch (valueType) {
+        case QVariant::Int:
+        case QVariant::LongLong:
+            storage = Integer;
+            integers.resize(nulls.size());
+            break;
+        case QVariant::Double:
+            storage = Real;
+            reals.resize(nulls.size());
+            break;
+        case QVariant::String:
+            storage = Text;
+            texts.resize(nulls.size());
+            break;
+        case QVariant::ByteArray:
+            storage = Blob;
+            blobs.resize(nulls.size());
+            break;
+        default:
+            storage = Generic;
+            generic.resize(nulls.size());
+            break;
+        }
+        type = valueType;
+    }
+
+    void convertToGeneric() {
+        QVector<QVariant> values;
+        values.reserve(nulls.size() + 1);
+        for (int row = 0, n = nulls.size(); row < n; ++row) {
+            values.append(value(row));
+        }
+        integers.clear();
+        reals.clear();
+        texts.clear();
+        blobs.clear();
+        generic = values;
+        storage = Generic;
+    }
+};
+
+class SqlResultSetData: public QSharedData
+{
+public:
+    SqlResultSetData()
+        : rowCount(0) {
+    }
+
+    QStringList fieldNames;
+    QHash<QString, int> fieldIndex;
+    QVector<SqlColumn> columns;
+    int rowCount;
+};
+
+// JavaScript/QML doesn't support 64bit integers (everything is converted to double)
+// so convert to string the same way SqlQueryUtils::getQueryData does.
+static QVariant qmlValue(const QVariant &value) {
+    if (value.type() == QVariant::LongLong || value.type() == QVariant::ULongLong) {
+        return value.toString();
+    }
+    return value;
+}
+
+SqlResultSet::SqlResultSet()
+    : d(new SqlResultSetData()) {
+}
+
+SqlResultSet::SqlResultSet(const SqlResultSet &other)
+    : d(other.d) {
+}
+
+SqlResultSet &SqlResultSet::operator=(const SqlResultSet &other) {
+    d = other.d;
+    return *this;
+}
+
+SqlResultSet::~SqlResultSet() {
+}
+
+void SqlResultSet::clear() {
+    d = new SqlResultSetData();
+}
+
+void SqlResultSet::setFieldNames(const QStringList &fieldNames) {
+    d = new SqlResultSetData();
+    d->fieldNames = fieldNames;
+    d->columns.resize(fieldNames.size());
+    for (int i = 0, n = fieldNames.size(); i < n; i++) {
+        d->fieldIndex.insert(fieldNames.at(i), i);
+    }
+}
+
+void SqlResultSet::appendRow(const QSqlQuery &sqlQuery) {
+    for (int i = 0, n = d->columns.size(); i < n; i++) {
+        d->columns[i].append(sqlQuery.value(i));
+    }
+    ++d->rowCount;
+}
+
+QStringList SqlResultSet::fieldNames() const {
+    return d->fieldNames;
+}
+
+int SqlResultSet::indexOf(const QString &fieldName) const {
+    return d->fieldIndex.value(fieldName, -1);
+}
+
+int SqlResultSet::columnCount() const {
+    return d->columns.size();
+}
+
+int SqlResultSet::rowCount() const {
+    return d->rowCount;
+}
+
+QVariant SqlResultSet::value(int row, int column) const {
+    if (row < 0 || row >= d->rowCount || column < 0 || column >= d->columns.size()) {
+        return QVariant();
+    }
+    return d->columns.at(column).value(row);
+}
+
+SqlRowView SqlResultSet::row(int row) const {
+    return SqlRowView(*this, row);
+}
+
+QList<DataItem> SqlResultSet::dataItems(const QString &keyColumn, const QString &revisionColumn) const {
+    QList<DataItem> items;
+    items.reserve(d->rowCount);
+    int keyIndex = keyColumn.isEmpty() ? -1 : indexOf(keyColumn);
+    int revisionIndex = revisionColumn.isEmpty() ? -1 : indexOf(revisionColumn);
+    for (int row = 0; row < d->rowCount; row++) {
+        // the data item key
+        QString keyId;
+        if (keyIndex >= 0) {
+            keyId = value(row, keyIndex).toString();
+        }
+
+        // the data item revision
+        quint64 revision = 0;
+        bool revisionOK = false;
+        if (revisionIndex >= 0) {
+            revision = value(row, revisionIndex).toULongLong(&revisionOK);
+        }
+        DataRevision dataRev = revisionOK ? DataRevision(new NumericRevision(revision)) : DataRevision();
+
+        items.append(DataItem(keyId, dataRev, QVariant::fromValue(SqlRowView(*this, row))));
+    }
+    return items;
+}
+
+SqlRowView::SqlRowView()
+    : m_row(-1) {
+}
+
+SqlRowView::SqlRowView(const SqlResultSet &resultSet, int row)
+    : m_resultSet(resultSet)
+    , m_row(row) {
+}
+
+bool SqlRowView::isValid() const {
+    return m_row >= 0 && m_row < m_resultSet.rowCount();
+}
+
+int SqlRowView::row() const {
+    return m_row;
+}
+
+QVariant SqlRowView::value(int column) const {
+    return m_resultSet.value(m_row, column);
+}
+
+QVariant SqlRowView::value(const QString &fieldName) const {
+    return m_resultSet.value(m_row, m_resultSet.indexOf(fieldName));
+}
+
+QVariantMap SqlRowView::toMap() const {
+    QVariantMap recordMap;
+    if (isValid()) {
+        const QStringList &fieldNames = m_resultSet.d->fieldNames;
+        for (int i = 0, n = fieldNames.size(); i < n; i++) {
+            recordMap.insert(fieldNames.at(i), qmlValue(value(i)));
+        }
+    }
+    return recordMap;
+}
+
+QVariantMap SqlRowView::toMap(const QVariant &payload) {
+    if (payload.userType() == qMetaTypeId<SqlRowView>()) {
+        return payload.value<SqlRowView>().toMap();
+    }
+    return payload.toMap();
+}
@@ -0,0 +1,222 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SQLRESULTSET_HPP
+#define SQLRESULTSET_HPP
+
+#include <bb/cascades/datamanager/DataItem>
+#include <QExplicitlySharedDataPointer>
+#include <QList>
+#include <QMetaType>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QtSql/QSqlQuery>
+
+class SqlResultSetData;
+class SqlRowView;
+
+/*!
+ * @brief A column oriented buffer for the rows returned by an SQL query.
+ *
+ * The field names are stored once per result set and each column keeps its values
+ * in a vector of the column type (integer, real, text or blob). A column which
+ * turns out to hold mixed types falls back to storing QVariant values.
+ *
+ * Compared to building a QVariantMap per row this avoids inserting every field
+ * name into every row and most of the per-value allocations. Rows are exposed
+ * through SqlRowView, which only references the buffer.
+ *
+ * The buffer is explicitly shared: copies of a result set and any row views see
+ * rows appended later. clear() and setFieldNames() detach into a new buffer, so
+ * existing row views keep the rows they were created for.
+ *
+ * @see SqlRowView
+ * @see SqlQueryUtils::getQueryData
+ *
+ */
+class SqlResultSet
+{
+public:
+    /*!
+     * Constructor.
+     *
+     */
+    SqlResultSet();
+
+    /*!
+     * Copy constructor. The copy shares the buffer.
+     *
+     */
+    SqlResultSet(const SqlResultSet &other);
+
+    /*!
+     * Assignment operator. This result set shares the buffer of other afterwards.
+     *
+     */
+    SqlResultSet &operator=(const SqlResultSet &other);
+
+    /*!
+     * Destructor.
+     *
+     */
+    virtual ~SqlResultSet();
+
+    /*!
+     * Remove all rows and fields.
+     *
+     */
+    void clear();
+
+    /*!
+     * Start a new buffer with the given field names and no rows.
+     *
+     * @param fieldNames The names of the result columns in query order.
+     *
+     */
+    void setFieldNames(const QStringList &fieldNames);
+
+    /*!
+     * Decode the current row of the query and append it. The query must be positioned
+     * on a valid row and have the columns given to setFieldNames().
+     *
+     */
+    void appendRow(const QSqlQuery &sqlQuery);
+
+    /*!
+     * Get the field names of the result columns.
+     *
+     */
+    QStringList fieldNames() const;
+
+    /*!
+     * Get the index of the named column or -1 if there is no such column.
+     *
+     */
+    int indexOf(const QString &fieldName) const;
+
+    /*!
+     * Get the number of columns.
+     *
+     */
+    int columnCount() const;
+
+    /*!
+     * Get the number of rows.
+     *
+     */
+    int rowCount() const;
+
+    /*!
+     * Get the value stored for a row and column, as returned by the database driver.
+     *
+     */
+    QVariant value(int row, int column) const;
+
+    /*!
+     * Get a view of a row which references this buffer.
+     *
+     */
+    SqlRowView row(int row) const;
+
+    /*!
+     * Create a DataItem for each row. The payload of each item is a SqlRowView
+     * instead of a QVariantMap; use SqlRowView::toMap() to read it.
+     *
+     * @param keyColumn The key column name used in the query. May be empty.
+     * @param revisionColumn The revision column name used in the query. May be empty.
+     * @return The data items.
+     *
+     */
+    QList<bb::cascades::datamanager::DataItem> dataItems(const QString &keyColumn,
+            const QString &revisionColumn) const;
+
+private:
+    friend class SqlRowView;
+    QExplicitlySharedDataPointer<SqlResultSetData> d;
+};
+
+/*!
+ * @brief A lightweight reference to one row of a SqlResultSet.
+ *
+ * A row view can be stored as a DataItem payload. The QVariantMap form is only
+ * built when toMap() is called.
+ *
+ */
+class SqlRowView
+{
+public:
+    /*!
+     * Constructor for an invalid view.
+     *
+     */
+    SqlRowView();
+
+    /*!
+     * Constructor.
+     *
+     * @param resultSet The result set holding the row.
+     * @param row The row index in the result set.
+     *
+     */
+    SqlRowView(const SqlResultSet &resultSet, int row);
+
+    /*!
+     * Return true if the view references a row.
+     *
+     */
+    bool isValid() const;
+
+    /*!
+     * Get the row index in the result set.
+     *
+     */
+    int row() const;
+
+    /*!
+     * Get the value of a column by index.
+     *
+     */
+    QVariant value(int column) const;
+
+    /*!
+     * Get the value of a column by field name. Returns an invalid QVariant if
+     * there is no such column.
+     *
+     */
+    QVariant value(const QString &fieldName) const;
+
+    /*!
+     * Build the field name to value map for the row. 64 bit integers are converted
+     * to strings as they would be for QML.
+     *
+     */
+    QVariantMap toMap() const;
+
+    /*!
+     * Return the map form of a DataItem payload which is either a SqlRowView or a QVariantMap.
+     *
+     */
+    static QVariantMap toMap(const QVariant &payload);
+
+private:
+    SqlResultSet m_resultSet;
+    int m_row;
+};
+
+Q_DECLARE_METATYPE(SqlRowView)
+
+#endif /* SQLRESULTSET_HPP */
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "SqlStatementCache.hpp"
+
+#include <QThreadStorage>
+#include <QtCore/QDebug>
+
+// one cache per thread, deleted by QThreadStorage when the thread exits
+static QThreadStorage<SqlStatementCache *> s_threadCache;
+
+SqlStatementCache *SqlStatementCache::instance() {
+    if (!s_threadCache.hasLocalData()) {
+        s_threadCache.setLocalData(new SqlStatementCache());
+    }
+    return s_threadCache.localData();
+}
+
+SqlStatementCache::SqlStatementCache(int capacity)
+    : m_statements(qMax(1, capacity))
+    , m_hitCount(0)
+    , m_missCount(0) {
+}
+
+SqlStatementCache::~SqlStatementCache() {
+    qDebug() << "SqlStatementCache destructor: hits=" << m_hitCount << ", misses=" << m_missCount;
+    // the prepared queries must be gone before their connections are removed
+    m_statements.clear();
+    for (int i = 0; i < m_connectionNames.size(); ++i) {
+        {
+            QSqlDatabase connection = QSqlDatabase::database(m_connectionNames.at(i), false);
+            connection.close();
+        }
+        QSqlDatabase::removeDatabase(m_connectionNames.at(i));
+    }
+}
+
+void SqlStatementCache::adoptConnection(const QString &connectionName) {
+    if (!m_connectionNames.contains(connectionName)) {
+        m_connectionNames.append(connectionName);
+    }
+}
+
+SqlStatementCache::Statement *SqlStatementCache::statement(const QSqlDatabase &connection, const QString &key) {
+    Statement *statement = m_statements.object(cacheKey(connection, key));
+    if (statement != NULL) {
+        ++m_hitCount;
+    } else {
+        ++m_missCount;
+    }
+    return statement;
+}
+
+SqlStatementCache::Statement *SqlStatementCache::insert(const QSqlDatabase &connection, const QString &key,
+        Statement *statement) {
+    // every statement has a cost of 1 so the insert can not be rejected
+    m_statements.insert(cacheKey(connection, key), statement, 1);
+    return statement;
+}
+
+void SqlStatementCache::clear() {
+    m_statements.clear();
+}
+
+void SqlStatementCache::setCapacity(int capacity) {
+    m_statements.setMaxCost(qMax(1, capacity));
+}
+
+int SqlStatementCache::capacity() const {
+    return m_statements.maxCost();
+}
+
+int SqlStatementCache::size() const {
+    return m_statements.size();
+}
+
+int SqlStatementCache::hitCount() const {
+    return m_hitCount;
+}
+
+int SqlStatementCache::missCount() const {
+    return m_missCount;
+}
+
+QString SqlStatementCache::cacheKey(const QSqlDatabase &connection, const QString &key) const {
+    // connection names are unique per database path and thread
+    return connection.connectionName() + QLatin1Char('\n') + key;
+}
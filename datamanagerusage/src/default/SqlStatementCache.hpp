@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SQLSTATEMENTCACHE_HPP
+#define SQLSTATEMENTCACHE_HPP
+
+#include <QCache>
+#include <QString>
+#include <QStringList>
+#include <QtSql/QSqlDatabase>
+#include <QtSql/QSqlQuery>
+
+/*!
+ * @brief A least-recently-used cache of prepared SQL statements.
+ *
+ * Each thread has its own cache (see instance()) so that no locking is needed;
+ * a connection and the statements prepared on it are only ever used by the thread
+ * that created them. Statements are keyed by connection name and by the
+ * named-parameter SQL text, and hold the rewritten positional form of the query
+ * together with the prepared QSqlQuery. A repeated query then only needs its values to be bound again.
+ *
+ * @see SqlQueryUtils
+ *
+ */
+class SqlStatementCache
+{
+public:
+    /*!
+     * A cached prepared statement.
+     *
+     */
+    struct Statement
+    {
+        explicit Statement(const QSqlDatabase &connection)
+            : query(connection) {
+        }
+
+        // the named parameters of the original query in positional order
+        QStringList parameters;
+        // the prepared positional query
+        QSqlQuery query;
+    };
+
+    /*!
+     * The default maximum number of statements cached per thread.
+     *
+     */
+    static const int DefaultCapacity = 32;
+
+    /*!
+     * Return the statement cache for the calling thread, creating it if needed.
+     * The cache is deleted when the thread exits.
+     *
+     */
+    static SqlStatementCache *instance();
+
+    /*!
+     * Remove the named connection when this cache is deleted, after the statements
+     * prepared on it. Used for connections opened on the cache's thread which must
+     * not outlive the thread, such as those of a SqlConnectionPool.
+     *
+     */
+    void adoptConnection(const QString &connectionName);
+
+    /*!
+     * Constructor.
+     *
+     * @param capacity The maximum number of statements to keep.
+     *
+     */
+    explicit SqlStatementCache(int capacity = DefaultCapacity);
+
+    /*!
+     * Destructor.
+     *
+     */
+    virtual ~SqlStatementCache();
+
+    /*!
+     * Look up the statement for the query on the connection. A hit marks the
+     * statement as most recently used.
+     *
+     * @param connection The open database connection.
+     * @param key The SQL text the statement is prepared from.
+     * @return The cached statement or 0 if there is none. Ownership stays with the cache.
+     *
+     */
+    Statement *statement(const QSqlDatabase &connection, const QString &key);
+
+    /*!
+     * Add a prepared statement for the query on the connection. The least recently used
+     * statement is evicted if the cache is full.
+     *
+     * @param connection The open database connection.
+     * @param key The SQL text the statement is prepared from.
+     * @param statement The prepared statement. Ownership is transferred to the cache.
+     * @return The statement, for convenience.
+     *
+     */
+    Statement *insert(const QSqlDatabase &connection, const QString &key, Statement *statement);
+
+    /*!
+     * Remove all cached statements. The hit and miss counters are kept.
+     *
+     */
+    void clear();
+
+    /*!
+     * Set the maximum number of cached statements. Must be at least 1.
+     *
+     */
+    void setCapacity(int capacity);
+
+    /*!
+     * Get the maximum number of cached statements.
+     *
+     */
+    int capacity() const;
+
+    /*!
+     * Get the number of cached statements.
+     *
+     */
+    int size() const;
+
+    /*!
+     * Get the number of lookups which found a prepared statement.
+     *
+     */
+    int hitCount() const;
+
+    /*!
+     * Get the number of lookups which required a statement to be prepared.
+     *
+     */
+    int missCount() const;
+
+private:
+    QString cacheKey(const QSqlDatabase &connection, const QString &key) const;
+
+    QCache<QString, Statement> m_statements;
+    QStringList m_connectionNames;
+    int m_hitCount;
+    int m_missCount;
+
+    Q_DISABLE_COPY(SqlStatementCache)
+};
+
+#endif /* SQLSTATEMENTCACHE_HPP */
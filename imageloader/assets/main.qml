@@ -65,6 +65,18 @@ Page {
 
                     layout: DockLayout {}
 
+                    // Don't decode the image of an item that has been scrolled out of view, the
+                    // decoding is resumed when the item is shown again
+                    property bool initialized: ListItem.initialized
+
+                    onInitializedChanged: {
+                        if (initialized) {
+                            ListItemData.resume();
+                        } else {
+                            ListItemData.cancel();
+                        }
+                    }
+
                     // The ActivityIndicator that is only active and visible while the image is loading
                     ActivityIndicator {
                         horizontalAlignment: HorizontalAlignment.Center
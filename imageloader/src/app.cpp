@@ -61,7 +61,7 @@ using namespace bb::cascades;
  *
  * In this app, you will learn:
  *     -how to use QNetworkAccessManager to perform asynchronous network requests.
- *     -how to use QThread to perform time-consuming operations in their own threads.
+ *     -how to use a QThreadPool to perform time-consuming operations in their own threads.
  *
  */
 //! [0]
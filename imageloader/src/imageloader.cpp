@@ -15,8 +15,6 @@
 
 #include "imageloader.hpp"
 
-#include "imageprocessor.hpp"
-
 #include <bb/ImageData>
 
 #include <QNetworkAccessManager>
@@ -24,6 +22,10 @@
 #include <QNetworkReply>
 #include <QUrl>
 #include <QDebug>
+#include <QThreadPool>
+
+// The size the images are scaled to, they cover it keeping their aspect ratio
+static const QSize ImageSize(768, 500);
 
 /**
  *  This class implements a image loader which will initialize a network request in asynchronous manner.
@@ -39,6 +41,8 @@ ImageLoader::ImageLoader(const QString &imageUrl, QObject* parent)
     : QObject(parent)
     , m_loading(false)
     , m_imageUrl(imageUrl)
+    , m_active(true)
+    , m_processingId(0)
 {
 }
 //! [0]
@@ -47,7 +51,11 @@ ImageLoader::ImageLoader(const QString &imageUrl, QObject* parent)
  * Destructor
  */
 //! [1]
-ImageLoader::~ImageLoader() { }
+ImageLoader::~ImageLoader()
+{
+    // Don't let a waiting image processor decode an image nobody will see.
+    cancel();
+}
 //! [1]
 
 /**
@@ -92,21 +100,12 @@ void ImageLoader::onReplyFinished()
         if (reply->error() == QNetworkReply::NoError) {
             const int available = reply->bytesAvailable();
             if (available > 0) {
-                const QByteArray data(reply->readAll());
-
-                // Setup the image processing thread
-                ImageProcessor *imageProcessor = new ImageProcessor(data);
-
-                QFuture<QImage> future = QtConcurrent::run(imageProcessor, &ImageProcessor::start);
-
-                // Invoke our onProcessingFinished slot after the processing has finished.
-                bool ok = connect(&m_watcher, SIGNAL(finished()), this, SLOT(onImageProcessingFinished()));
-                Q_ASSERT(ok);
-                Q_UNUSED(ok);
-
-                // starts watching the given future
-                m_watcher.setFuture(future);
+                m_data = reply->readAll();
 
+                // Decode the image in the image processor pool, unless its list item is scrolled away.
+                if (m_active) {
+                    startProcessing();
+                }
             }
         } else {
             m_label = tr("Error: %1 status: %2").arg(reply->errorString(), reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toString());
@@ -127,30 +126,85 @@ void ImageLoader::onReplyFinished()
 }
 //! [3]
 
+/**
+ * ImageLoader::startProcessing()
+ *
+ * Starts constructing the QImage object in the image processor pool.
+ */
+//! [4]
+void ImageLoader::startProcessing()
+{
+    m_cancelled = ImageProcessor::CancelFlag(new QAtomicInt(0));
+    ImageProcessor *imageProcessor = new ImageProcessor(m_data, ImageSize, ++m_processingId, m_cancelled);
+
+    // Invoke our onImageProcessingFinished slot after the processing has finished. The signal is
+    // emitted from the pool thread, so the slot is called in this object's thread.
+    bool ok = connect(imageProcessor, SIGNAL(finished(int, QImage)), this, SLOT(onImageProcessingFinished(int, QImage)),
+                      Qt::QueuedConnection);
+    Q_ASSERT(ok);
+    Q_UNUSED(ok);
+
+    // The pool deletes the processor once it has run.
+    ImageProcessor::threadPool()->start(imageProcessor);
+}
+//! [4]
+
+/**
+ * ImageLoader::cancel()
+ *
+ * Cancels the current image processing and keeps the data to decode it later.
+ */
+//! [5]
+void ImageLoader::cancel()
+{
+    m_active = false;
+    if (m_cancelled) {
+        m_cancelled->fetchAndStoreOrdered(1);
+        m_cancelled.clear();
+    }
+}
+
+void ImageLoader::resume()
+{
+    m_active = true;
+    if (!m_cancelled && !m_data.isEmpty()) {
+        startProcessing();
+    }
+}
+//! [5]
+
 /**
  * ImageLoader::onImageProcessingFinished()
  *
  * Handler for the signal indicating the result of the image processing.
  */
-//! [4]
-void ImageLoader::onImageProcessingFinished()
+//! [6]
+void ImageLoader::onImageProcessingFinished(int id, const QImage &image)
 {
-    QImage swappedImage = m_watcher.future().result().rgbSwapped();
-    if(swappedImage.format() != QImage::Format_RGB32) {
-    	swappedImage = swappedImage.convertToFormat(QImage::Format_RGB32);
+    // Ignore the result of a processor that has been cancelled after it was done.
+    if (id != m_processingId || !m_cancelled) {
+        return;
     }
-    const bb::ImageData imageData = bb::ImageData::fromPixels(swappedImage.bits(), bb::PixelFormat::RGBX, swappedImage.width(), swappedImage.height(), swappedImage.bytesPerLine());
+    m_cancelled.clear();
+    m_data.clear();
 
-    m_image = bb::cascades::Image(imageData);
-    emit imageChanged();
+    if (image.isNull()) {
+        m_label = tr("Could not decode image");
+    } else {
+        // The image processor has already put the pixels in RGBX order.
+        const bb::ImageData imageData = bb::ImageData::fromPixels(image.bits(), bb::PixelFormat::RGBX, image.width(), image.height(), image.bytesPerLine());
+
+        m_image = bb::cascades::Image(imageData);
+        emit imageChanged();
 
-    m_label.clear();
+        m_label.clear();
+    }
     emit labelChanged();
 
     m_loading = false;
     emit loadingChanged();
 }
-//! [4]
+//! [6]
 
 QVariant ImageLoader::image() const
 {
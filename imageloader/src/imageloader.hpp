@@ -16,6 +16,8 @@
 #ifndef IMAGELOADER_HPP
 #define IMAGELOADER_HPP
 
+#include "imageprocessor.hpp"
+
 #include <QImage>
 #include <QByteArray>
 
@@ -53,6 +55,18 @@ public:
      */
     void load();
 
+    /*
+     * Cancels the decoding of the image, e.g. when its list item is scrolled
+     * out of view. The downloaded data is kept so the image can be decoded
+     * by resume().
+     */
+    Q_INVOKABLE void cancel();
+
+    /*
+     * Decodes the downloaded image again if it was cancelled before it was done.
+     */
+    Q_INVOKABLE void resume();
+
 Q_SIGNALS:
     // The change notification signals of the properties
     void imageChanged();
@@ -68,7 +82,7 @@ private Q_SLOTS:
     /*
      * Response handler for the image process operation.
      */
-    void onImageProcessingFinished();
+    void onImageProcessingFinished(int id, const QImage &image);
 
 private:
     // The accessor methods of the properties
@@ -84,8 +98,20 @@ private:
     // The URL of the image that should be loaded
     QString m_imageUrl;
 
-    // The thread status watcher
-    QFutureWatcher<QImage> m_watcher;
+    // Starts decoding the downloaded data in the shared image processor pool
+    void startProcessing();
+
+    // The downloaded image data, kept until it has been decoded
+    QByteArray m_data;
+
+    // Whether the image should be decoded, false while the list item is scrolled away
+    bool m_active;
+
+    // The id of the current image processor, results of older processors are ignored
+    int m_processingId;
+
+    // The flag that cancels the current image processor
+    ImageProcessor::CancelFlag m_cancelled;
 };
 //! [0]
 
@@ -15,25 +15,91 @@
 
 #include "imageprocessor.hpp"
 
+#include <QtCore/QBuffer>
+#include <QtCore/QThreadPool>
+#include <QtGui/QImageIOHandler>
+#include <QtGui/QImageReader>
+
 //! [0]
-ImageProcessor::ImageProcessor(const QByteArray &imageData, QObject *parent)
+ImageProcessor::ImageProcessor(const QByteArray &imageData, const QSize &targetSize, int id,
+                               const CancelFlag &cancelled, QObject *parent)
     : QObject(parent)
     , m_data(imageData)
+    , m_targetSize(targetSize)
+    , m_id(id)
+    , m_cancelled(cancelled)
 {
+    setAutoDelete(true);
 }
 //! [0]
 
-//! [1]
-QImage ImageProcessor::start()
+QThreadPool *ImageProcessor::threadPool()
 {
-    QImage image;
+    // A pool of its own, so image decoding never takes all threads of the global pool.
+    // It keeps the default of one thread per CPU core.
+    static QThreadPool pool;
+    return &pool;
+}
 
-    image.loadFromData(m_data);
+//! [1]
+void ImageProcessor::run()
+{
+    // The list item may have scrolled away while the processor was waiting in the pool.
+    if (*m_cancelled) {
+        return;
+    }
 
-    image = image.scaled(768, 500, Qt::KeepAspectRatioByExpanding);
+    QImage image = decode();
 
     // Image processing goes here, example could be adding water mark to the downloaded image
 
-    return image;
+    // Swap the red and blue channels in place, so the pixels are in the RGBX byte order
+    // bb::ImageData expects, without making a copy of the image.
+    if (!image.isNull()) {
+        for (int y = 0; y < image.height(); ++y) {
+            QRgb *pixel = reinterpret_cast<QRgb*>(image.scanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                const QRgb p = pixel[x];
+                pixel[x] = (p & 0xff00ff00) | ((p & 0xff) << 16) | ((p >> 16) & 0xff);
+            }
+        }
+    }
+
+    if (!*m_cancelled) {
+        emit finished(m_id, image);
+    }
 }
 //! [1]
+
+QImage ImageProcessor::decode() const
+{
+    QBuffer buffer;
+    buffer.setData(m_data);
+    buffer.open(QIODevice::ReadOnly);
+
+    QImageReader reader(&buffer);
+
+    // Let the decoder scale the image, a JPEG is then decoded at a fraction
+    // of its full resolution instead of being scaled after decoding.
+    const QSize targetSize = reader.size().scaled(m_targetSize, Qt::KeepAspectRatioByExpanding);
+    const bool scaledByReader = targetSize.isValid() && reader.supportsOption(QImageIOHandler::ScaledSize);
+    if (scaledByReader) {
+        reader.setScaledSize(targetSize);
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        return image;
+    }
+
+    if (!scaledByReader) {
+        image = image.scaled(m_targetSize, Qt::KeepAspectRatioByExpanding);
+    }
+
+    // Only 32 bit images are swapped in place, e.g. a gray scale JPEG has to be converted.
+    if (image.format() != QImage::Format_RGB32) {
+        image = image.convertToFormat(QImage::Format_RGB32);
+    }
+
+    return image;
+}
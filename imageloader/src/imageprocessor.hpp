@@ -16,39 +16,78 @@
 #ifndef IMAGESCALER_HPP
 #define IMAGESCALER_HPP
 
+#include <QtCore/QAtomicInt>
 #include <QtCore/QByteArray>
 #include <QtCore/QObject>
+#include <QtCore/QRunnable>
+#include <QtCore/QSharedPointer>
+#include <QtCore/QSize>
 #include <QtGui/QImage>
 
+class QThreadPool;
+
 /**
  * @short A class to convert raw image data into a QImage and process it further.
  *
- * The class is designed to be used inside a QThread by providing a separated
- * start() slot and a finished() signal.
+ * The class is designed to be run by the thread pool returned by threadPool(),
+ * which is shared by all image loaders and runs as many decodes at the same
+ * time as there are CPU cores. The result is reported by the finished() signal,
+ * and the pool deletes the processor once it has run.
+ *
+ * The image is decoded straight to the target size and its pixels are stored
+ * in the RGBX byte order used by bb::ImageData, so the image can be handed to
+ * bb::ImageData::fromPixels() without further conversion.
  */
 //! [0]
-class ImageProcessor : public QObject
+class ImageProcessor : public QObject, public QRunnable
 {
     Q_OBJECT
 
 public:
+    // A flag shared with the processor; setting it to 1 cancels the processing.
+    typedef QSharedPointer<QAtomicInt> CancelFlag;
+
     /*
      * Creates a new image processor.
      *
      * @param imageData The raw image data.
+     * @param targetSize The size the image is scaled to, keeping its aspect ratio
+     *                   so that it covers the whole size.
+     * @param id An id that is passed to the finished() signal.
+     * @param cancelled The flag that cancels the processing.
      * @param parent The parent object.
      */
-    ImageProcessor(const QByteArray &imageData, QObject *parent = 0);
+    ImageProcessor(const QByteArray &imageData, const QSize &targetSize, int id,
+                   const CancelFlag &cancelled, QObject *parent = 0);
+
+    /*
+     * Decodes and processes the image, this is called by the thread pool.
+     */
+    void run();
 
-public Q_SLOTS:
     /*
-     * Starts the actual operation.
+     * Returns the thread pool that is shared by all image processors.
      */
-    QImage start();
+    static QThreadPool *threadPool();
+
+Q_SIGNALS:
+    /*
+     * Emitted from the pool thread with the processed image, unless the
+     * processing has been cancelled. The image is null if decoding failed.
+     */
+    void finished(int id, const QImage &image);
 
 private:
+    QImage decode() const;
+
     // The raw image data
     QByteArray m_data;
+
+    // The size the image is scaled to
+    QSize m_targetSize;
+
+    int m_id;
+    CancelFlag m_cancelled;
 };
 //! [0]
 
@@ -46,90 +46,168 @@
 #include <stdarg.h>
 
 #include <QtCore/QDebug>
+#include <QtCore/QIODevice>
 #include <QtCore/QMetaType>
 
 Q_DECLARE_METATYPE(QList<QVariantMap>)
 
-QtObjectFormatter::QtObjectFormatter()
+// The number of characters collected before they are written to the device
+static const int ChunkSize = 64 * 1024;
+
+/**
+ * Collects the formatted text and keeps track of the line start for the
+ * indentation. When writing to a device, the text is written out in chunks
+ * at line ends, and the buffer is reused for the next chunk.
+ */
+class QtObjectFormatter::Output
+{
+public:
+    Output(QString *text, QIODevice *device, int indent)
+        : m_text(text)
+        , m_device(device)
+        , m_indent(indent)
+        , m_atLineStart(true)
+        , m_error(false)
+    {
+    }
+
+    void append(const QString &text)
+    {
+        m_text->append(text);
+        m_atLineStart = false;
+    }
+
+    void append(const QLatin1String &text)
+    {
+        m_text->append(text);
+        m_atLineStart = false;
+    }
+
+    // Indents the line for the nesting depth if nothing was written to it yet
+    void startLine(int depth)
+    {
+        if (m_atLineStart) {
+            for (int i = depth * m_indent; i > 0; --i)
+                m_text->append(QLatin1Char(' '));
+        }
+    }
+
+    void newLine()
+    {
+        m_text->append(QLatin1Char('\n'));
+        m_atLineStart = true;
+        if (m_device && m_text->size() >= ChunkSize)
+            flush();
+    }
+
+    // Ends the line, without leaving empty lines in the indented output
+    void endLine()
+    {
+        if (m_indent == 0 || !m_atLineStart)
+            newLine();
+    }
+
+    bool flush()
+    {
+        if (m_device && !m_error && !m_text->isEmpty()) {
+            const QByteArray data = m_text->toUtf8();
+            m_error = m_device->write(data) != data.size();
+            // keeps the reserved capacity for the next chunk
+            m_text->resize(0);
+        }
+        return !m_error;
+    }
+
+private:
+    QString *m_text;
+    QIODevice *m_device;
+    int m_indent;
+    bool m_atLineStart;
+    bool m_error;
+};
+
+// Returns whether the value is one of the list or map types that are traversed
+static bool isContainer(const QVariant &value)
 {
+    return value.type() == QVariant::Map || value.type() == QVariant::List
+            || value.userType() == qMetaTypeId< QList<QVariantMap> >();
 }
 
-void QtObjectFormatter::traverse(const QVariant &value, QString &out) const
+QtObjectFormatter::QtObjectFormatter(int indent)
+    : m_indent(qMax(0, indent))
+{
+}
+
+int QtObjectFormatter::indent() const
+{
+    return m_indent;
+}
+
+// The nested maps and lists are accessed through QVariant::constData() and
+// not through value<T>(), so they are walked in place instead of being copied.
+void QtObjectFormatter::traverse(const QVariant &value, int depth, Output &out) const
 {
     switch (value.type()) {
         case QVariant::Map:
             {
-                const QVariantMap object = value.value<QVariantMap>();
-                QMapIterator<QString, QVariant> it(object);
-                while(it.hasNext()) {
-                    it.next();
-                    out += it.key();
-                    out += ": ";
-                    traverse(it.value(), out);
-                    out += "\n";
+                const QVariantMap &object = *static_cast<const QVariantMap*>(value.constData());
+                for (QVariantMap::const_iterator it = object.constBegin(); it != object.constEnd(); ++it) {
+                    out.startLine(depth);
+                    out.append(it.key());
+                    if (m_indent > 0 && isContainer(it.value())) {
+                        out.append(QLatin1String(":"));
+                        out.newLine();
+                    } else {
+                        out.append(QLatin1String(": "));
+                    }
+                    traverse(it.value(), depth + 1, out);
+                    out.endLine();
                 }
             }
             break;
         case QVariant::List:
-            {
-                const QVariantList list = value.value<QVariantList>();
-                QListIterator<QVariant> it(list);
-                int index = 0;
-                while(it.hasNext()) {
-                    QVariant value = it.next();
-                    out += "item[";
-                    out += QString::number(index++);
-                    out += "]:\n";
-                    traverse(value, out);
-                }
-                out += "\n";
-            }
+            traverseItems(*static_cast<const QVariantList*>(value.constData()), depth, out);
             break;
         case QVariant::String:
             {
-                out += "\"";
-                out += value.toString();
-                out += "\"";
+                out.startLine(depth);
+                out.append(QLatin1String("\""));
+                out.append(*static_cast<const QString*>(value.constData()));
+                out.append(QLatin1String("\""));
             }
             break;
         case QVariant::Bool:
             {
-                out += value.toString();
-                out += " (Bool)";
+                out.startLine(depth);
+                out.append(value.toString());
+                out.append(QLatin1String(" (Bool)"));
             }
             break;
         case QVariant::Int:
             {
-                out += value.toString();
-                out += " (Int)";
+                out.startLine(depth);
+                out.append(value.toString());
+                out.append(QLatin1String(" (Int)"));
             }
             break;
         case QVariant::Double:
             {
-                out += value.toString();
-                out += " (Double)";
+                out.startLine(depth);
+                out.append(value.toString());
+                out.append(QLatin1String(" (Double)"));
             }
             break;
         case QVariant::LongLong:
             {
-                out += value.toString();
-                out += " (LongLong)";
+                out.startLine(depth);
+                out.append(value.toString());
+                out.append(QLatin1String(" (LongLong)"));
             }
             break;
         default:
-            if (value.canConvert< QList<QVariantMap> >())
+            if (value.userType() == qMetaTypeId< QList<QVariantMap> >())
             {
-                const QList<QVariantMap> list = value.value< QList<QVariantMap> >();
-                QListIterator<QVariantMap> it(list);
-                int index = 0;
-                while(it.hasNext()) {
-                    QVariant value = it.next();
-                    out += "item[";
-                    out += QString::number(index++);
-                    out += "]:\n";
-                    traverse(value, out);
-                }
-                out += "\n";
+                traverseItems(*static_cast<const QList<QVariantMap>*>(value.constData()), depth, out);
                 break;
             }
             qWarning() << "Unsupported property type: " << value.typeName();
@@ -137,10 +215,36 @@ void QtObjectFormatter::traverse(const QVariant &value, QString &out) const
     }
 }
 
-QString QtObjectFormatter::asString(const QVariant &value) const
+template <typename T>
+void QtObjectFormatter::traverseItems(const QList<T> &list, int depth, Output &out) const
+{
+    for (int index = 0; index < list.size(); ++index) {
+        out.startLine(depth);
+        out.append(QLatin1String("item["));
+        out.append(QString::number(index));
+        out.append(QLatin1String("]:"));
+        out.newLine();
+        traverse(list.at(index), depth + 1, out);
+        if (m_indent > 0)
+            out.endLine();
+    }
+    out.endLine();
+}
+
+QString QtObjectFormatter::asString(const QVariant &value, int sizeHint) const
+{
+    QString text;
+    text.reserve(qMax(200, sizeHint));
+    Output out(&text, 0, m_indent);
+    traverse(value, 0, out);
+    return text;
+}
+
+bool QtObjectFormatter::write(const QVariant &value, QIODevice *device) const
 {
-    QString out;
-    out.reserve(200);
-    traverse(value, out);
-    return out;
+    QString text;
+    text.reserve(ChunkSize + ChunkSize / 4);
+    Output out(&text, device, m_indent);
+    traverse(value, 0, out);
+    return out.flush();
 }
@@ -46,24 +46,52 @@
 #include <QtCore/QString>
 #include <QtCore/QVariant>
 
+class QIODevice;
+
 /**
  * \brief QtObjectFormatter formats the Qt QVariant data for debugging purposes.
+ *
+ * Nested maps and lists are walked in place, so formatting a large document
+ * does not copy it. The output can either be returned as one string or be
+ * written to a device in chunks while the data is walked.
  */
 class QtObjectFormatter
 {
 public:
     /**
-     * Constructs a formatter.
+     * Constructs a formatter. If @p indent is greater than 0, every nesting
+     * level is indented by that many spaces and nested maps and lists start
+     * on their own line.
+     */
+    explicit QtObjectFormatter(int indent = 0);
+
+    /**
+     * Returns the number of spaces each nesting level is indented by.
+     */
+    int indent() const;
+
+    /**
+     * Returns the the given @p value formatted as string. The @p sizeHint
+     * is the expected length of the result, e.g. the length of the JSON text
+     * the value was read from, and is reserved up front.
      */
-    QtObjectFormatter();
+    QString asString(const QVariant &value, int sizeHint = 0) const;
 
     /**
-     * Returns the the given @p value formatted as string.
+     * Writes the given @p value formatted as UTF-8 text to the @p device,
+     * which has to be open for writing. Returns false if writing failed.
      */
-    QString asString(const QVariant &value) const;
+    bool write(const QVariant &value, QIODevice *device) const;
 
 private:
-    void traverse(const QVariant& value, QString& out) const;
+    class Output;
+
+    void traverse(const QVariant& value, int depth, Output& out) const;
+
+    template <typename T>
+    void traverseItems(const QList<T>& list, int depth, Output& out) const;
+
+    int m_indent;
 };
 
 #endif
@@ -173,7 +173,7 @@ void App::convertJsonToQt()
     } else {
         setQtData(qtData);
         const QtObjectFormatter fmt;
-        setRhsTitleAndText(tr("Qt Data from JSON"), fmt.asString(qtData));
+        setRhsTitleAndText(tr("Qt Data from JSON"), fmt.asString(qtData, mJsonData.size()));
         setResultAndState(result + tr("Success"), QtDisplayed);
     }
 }
@@ -44,6 +44,21 @@ NavigationPane {
                     page.session = session;
                     navigationPane.push(page)
                 }
+            },
+            ActionItem {
+                title: qsTr("Replay Telemetry")
+                imageSource: "asset:///images/track.png"
+                ActionBar.placement: ActionBarPlacement.InOverflow
+                onTriggered: {
+                    // Replays the last recorded tracking session in real time
+                    var fileName = _locationDiagnostics.latestTelemetryLog()
+                    if (fileName == "")
+                        return
+                    var page = locationPage.createObject()
+                    var session = _locationDiagnostics.createReplaySession(fileName, 1.0)
+                    page.session = session
+                    navigationPane.push(page)
+                }
             }
         ]
         //! [0]
@@ -205,6 +220,13 @@ NavigationPane {
                         checked: _locationDiagnostics.backgroundMode
                         onCheckedChanged: _locationDiagnostics.backgroundMode = checked
                     }
+                    ToggleLabelButton {
+                        horizontalAlignment: HorizontalAlignment.Fill
+                        topMargin: ui.du(1.1)
+                        text: qsTr("Record Telemetry")
+                        checked: _locationDiagnostics.recordTelemetry
+                        onCheckedChanged: _locationDiagnostics.recordTelemetry = checked
+                    }
                 }
             }
         }
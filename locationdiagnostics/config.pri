@@ -79,12 +79,17 @@ config_pri_assets {
 config_pri_source_group1 {
     SOURCES += \
         $$quote($$BASEDIR/src/LocationDiagnostics.cpp) \
+        $$quote($$BASEDIR/src/LocationRecorder.cpp) \
+        $$quote($$BASEDIR/src/LocationReplay.cpp) \
         $$quote($$BASEDIR/src/LocationSession.cpp) \
         $$quote($$BASEDIR/src/RawLocationParser.cpp) \
         $$quote($$BASEDIR/src/main.cpp)
 
     HEADERS += \
         $$quote($$BASEDIR/src/LocationDiagnostics.hpp) \
+        $$quote($$BASEDIR/src/LocationRecord.hpp) \
+        $$quote($$BASEDIR/src/LocationRecorder.hpp) \
+        $$quote($$BASEDIR/src/LocationReplay.hpp) \
         $$quote($$BASEDIR/src/LocationSession.hpp) \
         $$quote($$BASEDIR/src/RawLocationParser.hpp)
 }
@@ -15,10 +15,14 @@
 
 #include "LocationDiagnostics.hpp"
 
+#include "LocationReplay.hpp"
 #include "LocationSession.hpp"
 
 #include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
 #include <QSettings>
+#include <QStringList>
 
 //! [0]
 LocationDiagnostics::LocationDiagnostics(QObject *parent)
@@ -31,6 +35,7 @@ LocationDiagnostics::LocationDiagnostics(QObject *parent)
     m_frequency = settings.value("frequency", "1").toInt();
     m_useSound = settings.value("useSound", true).toBool();
     m_backgroundMode = settings.value("backgroundMode", true).toBool();
+    m_recordTelemetry = settings.value("recordTelemetry", false).toBool();
 
     bool ok = connect(qApp, SIGNAL(manualExit()), SLOT(onManualExit()));
     Q_ASSERT(ok);
@@ -91,6 +96,14 @@ LocationSession* LocationDiagnostics::createLocationSession(bool trackingMode)
     session->positionSource()->setProperty("canRunInBackground", m_backgroundMode);
 
 
+    // Record the fixes of a tracking session, one log per session
+    if (trackingMode && m_recordTelemetry) {
+        const QString fileName = QString::fromLatin1("%1/%2.loc")
+                                     .arg(telemetryPath())
+                                     .arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss"));
+        session->startRecording(fileName);
+    }
+
     // Activate the session
     if (trackingMode) {
         session->startUpdates();
@@ -102,6 +115,41 @@ LocationSession* LocationDiagnostics::createLocationSession(bool trackingMode)
 }
 //! [1]
 
+LocationSession* LocationDiagnostics::createReplaySession(const QString &fileName, double speed)
+{
+    // The position source of a replay session is never started
+    LocationSession* session = new LocationSession(this, false);
+
+    LocationReplay* replay = new LocationReplay(session);
+    replay->setSpeed(speed);
+
+    if (!replay->open(fileName))
+        return session;
+
+    bool ok = connect(replay, SIGNAL(recordReplayed(const LocationRecord &)), session, SLOT(replayRecord(const LocationRecord &)));
+    Q_ASSERT(ok);
+    Q_UNUSED(ok);
+
+    replay->start();
+
+    return session;
+}
+
+QString LocationDiagnostics::latestTelemetryLog() const
+{
+    // The logs are named after the time they were started, so the last one is the newest
+    const QStringList logs = QDir(telemetryPath()).entryList(QStringList() << "*.loc", QDir::Files, QDir::Name);
+    if (logs.isEmpty())
+        return QString();
+
+    return QDir(telemetryPath()).absoluteFilePath(logs.last());
+}
+
+QString LocationDiagnostics::telemetryPath()
+{
+    return QDir::homePath() + QLatin1String("/telemetry");
+}
+
 void LocationDiagnostics::onManualExit()
 {
     qApp->exit(0);
@@ -255,3 +303,20 @@ void LocationDiagnostics::setBackgroundMode(bool mode)
     emit backgroundModeChanged();
 }
 
+bool LocationDiagnostics::recordTelemetry() const
+{
+    return m_recordTelemetry;
+}
+
+void LocationDiagnostics::setRecordTelemetry(bool record)
+{
+    if (m_recordTelemetry == record)
+        return;
+
+    m_recordTelemetry = record;
+
+    QSettings settings;
+    settings.setValue("recordTelemetry", m_recordTelemetry);
+
+    emit recordTelemetryChanged();
+}
@@ -42,6 +42,7 @@ class LocationDiagnostics : public QObject
     Q_PROPERTY(int frequency READ frequency WRITE setFrequency NOTIFY frequencyChanged)
     Q_PROPERTY(bool useSound READ useSound WRITE setUseSound NOTIFY useSoundChanged)
     Q_PROPERTY(bool backgroundMode READ backgroundMode WRITE setBackgroundMode NOTIFY backgroundModeChanged)
+    Q_PROPERTY(bool recordTelemetry READ recordTelemetry WRITE setRecordTelemetry NOTIFY recordTelemetryChanged)
 
 public:
     LocationDiagnostics(QObject *parent = 0);
@@ -51,6 +52,18 @@ public:
      */
     Q_INVOKABLE LocationSession* createLocationSession(bool trackingMode);
 
+    /**
+     * This method creates a location session which replays a recorded telemetry log
+     * instead of retrieving location information. A speed of 1 replays in real time.
+     */
+    Q_INVOKABLE LocationSession* createReplaySession(const QString &fileName, double speed = 1.0);
+
+    /**
+     * This method returns the most recently recorded telemetry log, or an empty string
+     * if no session has been recorded yet.
+     */
+    Q_INVOKABLE QString latestTelemetryLog() const;
+
 
 Q_SIGNALS:
     // The change notification signals of the properties
@@ -63,6 +76,7 @@ Q_SIGNALS:
     void frequencyChanged();
     void useSoundChanged();
     void backgroundModeChanged();
+    void recordTelemetryChanged();
 
 private Q_SLOTS:
     void onManualExit();
@@ -87,6 +101,11 @@ private:
     void setUseSound(bool sound);
     bool backgroundMode() const;
     void setBackgroundMode(bool mode);
+    bool recordTelemetry() const;
+    void setRecordTelemetry(bool record);
+
+    // The directory the telemetry logs are recorded to
+    static QString telemetryPath();
 
     // The property values
     QString m_positionMethod;
@@ -98,6 +117,7 @@ private:
     int m_frequency;
     bool m_useSound;
     bool m_backgroundMode;
+    bool m_recordTelemetry;
 
 };
 //! [0]
@@ -0,0 +1,102 @@
+/* Copyright (c) 2012, 2013  BlackBerry Limited.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef LOCATIONRECORD_HPP
+#define LOCATIONRECORD_HPP
+
+#include <QtCore/QtGlobal>
+
+/**
+ * The binary layout of the telemetry log written by LocationRecorder and read by LocationReplay.
+ *
+ * A log is a LocationLogHeader followed by fixed size LocationRecords, one per fix, so record n
+ * is found at a fixed offset and a mapped log can be read in place. The values are stored in the
+ * byte order of the device that recorded them; the header tells a reader whether it can use the log.
+ */
+
+// One satellite of a fix
+struct LocationSatelliteRecord
+{
+    enum Flag {
+        EphemerisAvailable = 0x01,
+        Tracked = 0x02,
+        Used = 0x04,
+        Almanac = 0x08
+    };
+
+    float id;
+    float carrierToNoiseRatio;
+    float azimuth;
+    float elevation;
+    quint32 flags;
+};
+
+// One fix with its satellites, as parsed by RawLocationParser
+struct LocationRecord
+{
+    enum Flag {
+        Propagated = 0x01
+    };
+
+    // Satellites beyond this number are not recorded
+    static const int MaxSatellites = 48;
+
+    // The length of the position method text, including the terminating zero
+    static const int MethodLength = 32;
+
+    // The time the fix was received, in milliseconds since the epoch
+    qint64 timestamp;
+
+    double latitude;
+    double longitude;
+    double altitude;
+    double horizontalAccuracy;
+    double verticalAccuracy;
+    double heading;
+    double speed;
+    double ttff;
+    double gpsWeek;
+    double gpsTow;
+    double utc;
+    double hdop;
+    double vdop;
+    double pdop;
+    quint32 flags;
+    quint32 satelliteCount;
+    char method[MethodLength];
+    LocationSatelliteRecord satellites[MaxSatellites];
+};
+
+struct LocationLogHeader
+{
+    // The version of the record layout
+    static const quint32 CurrentVersion = 1;
+
+    char magic[8];
+    quint32 version;
+    quint32 recordSize;
+    // 0x01020304 as written by the recording device
+    quint32 byteOrderMark;
+    quint32 reserved;
+    qint64 startTime;
+};
+
+// The value of LocationLogHeader::magic
+static const char LocationLogMagic[8] = { 'L', 'O', 'C', 'D', 'I', 'A', 'G', '\0' };
+
+// The value of LocationLogHeader::byteOrderMark
+static const quint32 LocationLogByteOrderMark = 0x01020304;
+
+#endif
@@ -0,0 +1,174 @@
+/* Copyright (c) 2012, 2013  BlackBerry Limited.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "LocationRecorder.hpp"
+
+#include <QtCore/QDateTime>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QFileInfo>
+#include <QtCore/QMutexLocker>
+
+#include <string.h>
+
+// The time in milliseconds between two flushes of the buffer
+static const unsigned long FlushInterval = 2000;
+
+LocationRecorder::LocationRecorder(const QString &fileName, int capacity, QObject *parent)
+    : QThread(parent)
+    , m_file(fileName)
+    , m_capacity(1)
+    , m_head(0)
+    , m_tail(0)
+    , m_dropped(0)
+    , m_written(0)
+    , m_stopping(false)
+{
+    // A power of two keeps the slot of a running count valid when the count wraps
+    while (m_capacity < capacity)
+        m_capacity *= 2;
+
+    m_buffer.reset(new LocationRecord[m_capacity]);
+}
+
+LocationRecorder::~LocationRecorder()
+{
+    close();
+}
+
+bool LocationRecorder::open()
+{
+    if (m_file.isOpen())
+        return true;
+
+    QDir().mkpath(QFileInfo(m_file).absolutePath());
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "LocationRecorder: cannot create" << m_file.fileName() << m_file.errorString();
+        return false;
+    }
+
+    LocationLogHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LocationLogMagic, sizeof(header.magic));
+    header.version = LocationLogHeader::CurrentVersion;
+    header.recordSize = sizeof(LocationRecord);
+    header.byteOrderMark = LocationLogByteOrderMark;
+    header.startTime = QDateTime::currentMSecsSinceEpoch();
+
+    if (m_file.write(reinterpret_cast<const char*>(&header), sizeof(header)) != sizeof(header)) {
+        qWarning() << "LocationRecorder: cannot write" << m_file.fileName() << m_file.errorString();
+        m_file.close();
+        return false;
+    }
+
+    m_stopping = false;
+    start(QThread::LowPriority);
+
+    return true;
+}
+
+void LocationRecorder::close()
+{
+    if (!m_file.isOpen())
+        return;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_stopping = true;
+        m_wakeUp.wakeOne();
+    }
+    wait();
+
+    m_file.close();
+
+    if (m_dropped > 0)
+        qWarning() << "LocationRecorder: dropped" << int(m_dropped) << "fixes";
+}
+
+//! [0]
+bool LocationRecorder::append(const LocationRecord &record)
+{
+    // Only this method moves the head, only flush() moves the tail
+    const int head = m_head;
+    const int tail = m_tail.fetchAndAddAcquire(0);
+
+    if (head - tail >= m_capacity) {
+        m_dropped.ref();
+        return false;
+    }
+
+    m_buffer[head & (m_capacity - 1)] = record;
+
+    // Publish the slot to the background thread only once it is filled
+    m_head.fetchAndStoreRelease(head + 1);
+
+    return true;
+}
+//! [0]
+
+qint64 LocationRecorder::writtenCount() const
+{
+    return m_written;
+}
+
+int LocationRecorder::droppedCount() const
+{
+    return m_dropped;
+}
+
+void LocationRecorder::run()
+{
+    QMutexLocker locker(&m_mutex);
+
+    while (!m_stopping) {
+        m_wakeUp.wait(&m_mutex, FlushInterval);
+
+        locker.unlock();
+        flush();
+        locker.relock();
+    }
+
+    // Fixes appended after the last flush
+    locker.unlock();
+    flush();
+}
+
+//! [1]
+void LocationRecorder::flush()
+{
+    const int head = m_head.fetchAndAddAcquire(0);
+    int tail = m_tail;
+
+    while (tail != head) {
+        // Write the filled slots up to the end of the buffer in one go
+        const int slot = tail & (m_capacity - 1);
+        const int count = qMin(head - tail, m_capacity - slot);
+
+        const qint64 size = qint64(count) * sizeof(LocationRecord);
+        if (m_file.write(reinterpret_cast<const char*>(&m_buffer[slot]), size) != size) {
+            qWarning() << "LocationRecorder: cannot write" << m_file.fileName() << m_file.errorString();
+        }
+
+        tail += count;
+        m_written += count;
+
+        // Hand the slots back to append()
+        m_tail.fetchAndStoreRelease(tail);
+    }
+
+    m_file.flush();
+}
+//! [1]
@@ -0,0 +1,92 @@
+/* Copyright (c) 2012, 2013  BlackBerry Limited.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef LOCATIONRECORDER_HPP
+#define LOCATIONRECORDER_HPP
+
+#include "LocationRecord.hpp"
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QFile>
+#include <QtCore/QMutex>
+#include <QtCore/QScopedArrayPointer>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+/**
+ * @short Records location fixes to a binary telemetry log.
+ *
+ * append() copies a fix into a single producer, single consumer ring buffer and never blocks,
+ * so it can be called from the thread receiving the position updates. A background thread
+ * flushes the buffer to the log in batches. When the buffer is full because the log cannot
+ * keep up, new fixes are dropped and counted instead of stalling the session.
+ *
+ * @see LocationRecord
+ * @see LocationReplay
+ */
+class LocationRecorder : public QThread
+{
+    Q_OBJECT
+
+public:
+    // The default number of fixes buffered, about 17 minutes at 1 Hz
+    static const int DefaultCapacity = 1024;
+
+    // The capacity is rounded up to a power of two
+    LocationRecorder(const QString &fileName, int capacity = DefaultCapacity, QObject *parent = 0);
+
+    // Stops the recorder, writing all buffered fixes first
+    ~LocationRecorder();
+
+    // Creates the log and starts the background thread
+    bool open();
+
+    // Writes all buffered fixes and stops the background thread
+    void close();
+
+    // Queues a fix for the log, returns false if it had to be dropped
+    bool append(const LocationRecord &record);
+
+    // The number of fixes written to the log
+    qint64 writtenCount() const;
+
+    // The number of fixes dropped because the buffer was full
+    int droppedCount() const;
+
+protected:
+    // Reimplemented from QThread, the content is executed in the background thread
+    void run();
+
+private:
+    // Writes the buffered fixes to the log, called in the background thread
+    void flush();
+
+    QFile m_file;
+    QScopedArrayPointer<LocationRecord> m_buffer;
+    int m_capacity;
+
+    // The running counts of fixes appended and flushed, the slot is the count modulo capacity
+    QAtomicInt m_head;
+    QAtomicInt m_tail;
+    QAtomicInt m_dropped;
+    qint64 m_written;
+
+    // Only used to wake up and stop the background thread
+    QMutex m_mutex;
+    QWaitCondition m_wakeUp;
+    bool m_stopping;
+};
+
+#endif
@@ -0,0 +1,137 @@
+/* Copyright (c) 2012, 2013  BlackBerry Limited.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#include "LocationReplay.hpp"
+
+#include <QtCore/QDebug>
+
+#include <limits.h>
+#include <string.h>
+
+LocationReplay::LocationReplay(QObject *parent)
+    : QObject(parent)
+    , m_records(0)
+    , m_recordCount(0)
+    , m_next(0)
+    , m_speed(1.0)
+{
+    m_timer.setSingleShot(true);
+
+    bool ok = connect(&m_timer, SIGNAL(timeout()), this, SLOT(replayNext()));
+    Q_ASSERT(ok);
+    Q_UNUSED(ok);
+}
+
+bool LocationReplay::open(const QString &fileName)
+{
+    stop();
+
+    if (m_file.isOpen())
+        m_file.close();
+
+    m_records = 0;
+    m_recordCount = 0;
+    m_next = 0;
+
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "LocationReplay: cannot open" << fileName << m_file.errorString();
+        return false;
+    }
+
+    const qint64 size = m_file.size();
+    const uchar *data = (size >= qint64(sizeof(LocationLogHeader)) ? m_file.map(0, size) : 0);
+    if (!data) {
+        qWarning() << "LocationReplay: cannot map" << fileName;
+        m_file.close();
+        return false;
+    }
+
+    LocationLogHeader header;
+    memcpy(&header, data, sizeof(header));
+
+    if (memcmp(header.magic, LocationLogMagic, sizeof(header.magic)) != 0
+            || header.version != LocationLogHeader::CurrentVersion
+            || header.recordSize != sizeof(LocationRecord)
+            || header.byteOrderMark != LocationLogByteOrderMark) {
+        qWarning() << "LocationReplay: incompatible log" << fileName;
+        m_file.close();
+        return false;
+    }
+
+    // A record cut short by the end of a recording is left out
+    m_records = data + sizeof(LocationLogHeader);
+    m_recordCount = (size - sizeof(LocationLogHeader)) / sizeof(LocationRecord);
+
+    return true;
+}
+
+int LocationReplay::recordCount() const
+{
+    return m_recordCount;
+}
+
+const LocationRecord *LocationReplay::record(int index) const
+{
+    if (index < 0 || index >= m_recordCount)
+        return 0;
+
+    return reinterpret_cast<const LocationRecord*>(m_records + qint64(index) * sizeof(LocationRecord));
+}
+
+void LocationReplay::setSpeed(double speed)
+{
+    m_speed = qMax(0.0, speed);
+}
+
+double LocationReplay::speed() const
+{
+    return m_speed;
+}
+
+void LocationReplay::start()
+{
+    if (m_next < m_recordCount && !m_timer.isActive())
+        m_timer.start(0);
+}
+
+void LocationReplay::stop()
+{
+    m_timer.stop();
+}
+
+//! [0]
+void LocationReplay::replayNext()
+{
+    const LocationRecord *current = record(m_next++);
+    if (!current)
+        return;
+
+    emit recordReplayed(*current);
+
+    const LocationRecord *next = record(m_next);
+    if (!next) {
+        emit finished();
+        return;
+    }
+
+    // Keep the recorded spacing of the fixes, scaled by the speed
+    int delay = 0;
+    if (m_speed > 0)
+        delay = qBound(qint64(0), qint64((next->timestamp - current->timestamp) / m_speed), qint64(INT_MAX));
+
+    m_timer.start(delay);
+}
+//! [0]
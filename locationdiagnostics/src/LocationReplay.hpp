@@ -0,0 +1,78 @@
+/* Copyright (c) 2012, 2013  BlackBerry Limited.
+*
+* Licensed under the Apache License, Version 2.0 (the "License");
+* you may not use this file except in compliance with the License.
+* You may obtain a copy of the License at
+*
+* http://www.apache.org/licenses/LICENSE-2.0
+*
+* Unless required by applicable law or agreed to in writing, software
+* distributed under the License is distributed on an "AS IS" BASIS,
+* WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+* See the License for the specific language governing permissions and
+* limitations under the License.
+*/
+
+#ifndef LOCATIONREPLAY_HPP
+#define LOCATIONREPLAY_HPP
+
+#include "LocationRecord.hpp"
+
+#include <QtCore/QFile>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+/**
+ * @short Plays back a telemetry log written by LocationRecorder.
+ *
+ * The log is mapped into memory and the fixes are emitted in order, spaced by the time between
+ * them when they were recorded divided by the speed. Connect recordReplayed() to
+ * LocationSession::replayRecord() to feed a log back through a session.
+ */
+class LocationReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    LocationReplay(QObject *parent = 0);
+
+    // Maps the log, returns false if it is missing or was not written by a compatible device
+    bool open(const QString &fileName);
+
+    // The number of fixes in the log
+    int recordCount() const;
+
+    // The fix at the given index, read in place from the mapped log
+    const LocationRecord *record(int index) const;
+
+    // The playback speed; 1 is real time, 0 replays as fast as possible
+    void setSpeed(double speed);
+    double speed() const;
+
+public Q_SLOTS:
+    // Starts or continues the playback
+    void start();
+
+    // Pauses the playback
+    void stop();
+
+Q_SIGNALS:
+    // This signal is emitted for every fix of the log
+    void recordReplayed(const LocationRecord &record);
+
+    // This signal is emitted after the last fix
+    void finished();
+
+private Q_SLOTS:
+    void replayNext();
+
+private:
+    QFile m_file;
+    const uchar *m_records;
+    int m_recordCount;
+    int m_next;
+    double m_speed;
+    QTimer m_timer;
+};
+
+#endif
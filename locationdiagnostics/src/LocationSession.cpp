@@ -15,6 +15,7 @@
 
 #include "LocationSession.hpp"
 
+#include "LocationRecorder.hpp"
 #include "RawLocationParser.hpp"
 
 #include <bb/cascades/maps/MapData.hpp>
@@ -22,9 +23,11 @@
 #include <bb/multimedia/SystemSound>
 #include <bb/platform/geo/GeoLocation.hpp>
 
+#include <QtCore/QDateTime>
 #include <QtCore/QVariant>
 
 #include <iostream>
+#include <string.h>
 
 using namespace bb::cascades::maps;
 using namespace bb::multimedia;
@@ -38,6 +41,8 @@ LocationSession::LocationSession(QObject* parent, bool satInfo)
     , m_altitude(0)
     , m_soundEnabled(false)
     , m_positionSource(QGeoPositionInfoSource::createDefaultSource(this))
+    , m_satelliteSource(0)
+    , m_recorder(0)
     , m_isPropagated(false)
     , m_mapView(0)
 {
@@ -153,6 +158,14 @@ void LocationSession::positionUpdated(const QGeoPositionInfo& pos)
 
     emit dataChanged();
 
+    updateMapView();
+
+    log(tr("update"));
+}
+//! [5]
+
+void LocationSession::updateMapView()
+{
     if (m_mapView) {
         Geographic *myGeo = m_mapView->mapData()->geographic("myLocation");
         GeoLocation *myLocation = 0;
@@ -173,10 +186,7 @@ void LocationSession::positionUpdated(const QGeoPositionInfo& pos)
         m_mapView->setFocusedId(myLocation->id());
         m_mapView->setLocationOnFocused();
     }
-
-    log(tr("update"));
 }
-//! [5]
 
 QGeoPositionInfoSource* LocationSession::positionSource() const
 {
@@ -188,6 +198,44 @@ void LocationSession::setSoundEnabled(bool enabled)
     m_soundEnabled = enabled;
 }
 
+bool LocationSession::startRecording(const QString &fileName)
+{
+    if (m_recorder)
+        return true;
+
+    // The recorder flushes the remaining fixes when the session is deleted
+    m_recorder = new LocationRecorder(fileName, LocationRecorder::DefaultCapacity, this);
+    if (!m_recorder->open()) {
+        delete m_recorder;
+        m_recorder = 0;
+        log(tr("Failed to start recording to %1").arg(fileName));
+        return false;
+    }
+
+    log(tr("Recording to %1").arg(fileName));
+    return true;
+}
+
+void LocationSession::replayRecord(const LocationRecord &record)
+{
+    m_latitude = record.latitude;
+    m_longitude = record.longitude;
+    m_altitude = record.altitude;
+    m_time = QDateTime::fromMSecsSinceEpoch(record.timestamp).toString();
+    m_direction = QString::number(record.heading);
+    m_groundSpeed = QString::number(record.speed);
+    m_horizontalAccuracy = QString::number(record.horizontalAccuracy);
+    m_verticalAccuracy = QString::number(record.verticalAccuracy);
+
+    applyRecord(record);
+
+    emit dataChanged();
+
+    updateMapView();
+
+    log(tr("replayed update"));
+}
+
 void LocationSession::positionUpdateTimeout()
 {
     log(tr("positionUpdateTimeout() received"));
@@ -226,6 +274,50 @@ void LocationSession::satellitesInViewUpdated(const QList<QGeoSatelliteInfo> &sa
     emit dataChanged();
 }
 
+static LocationRecord recordFromParser(const RawLocationParser &parser)
+{
+    LocationRecord record;
+    memset(&record, 0, sizeof(record));
+
+    record.timestamp = QDateTime::currentMSecsSinceEpoch();
+    record.latitude = parser.latitude();
+    record.longitude = parser.longitude();
+    record.altitude = parser.altitude();
+    record.horizontalAccuracy = parser.horizontalAccuracy();
+    record.verticalAccuracy = parser.verticalAccuracy();
+    record.heading = parser.heading();
+    record.speed = parser.speed();
+    record.ttff = parser.ttff();
+    record.gpsWeek = parser.gpsWeek();
+    record.gpsTow = parser.gpsTow();
+    record.utc = parser.utc();
+    record.hdop = parser.hdop();
+    record.vdop = parser.vdop();
+    record.pdop = parser.pdop();
+    record.flags = (parser.propagated() ? LocationRecord::Propagated : 0);
+    qstrncpy(record.method, parser.positionMethod().toLatin1().constData(), LocationRecord::MethodLength);
+
+    record.satelliteCount = qMin(parser.numberOfSatellites(), int(LocationRecord::MaxSatellites));
+    for (quint32 i = 0; i < record.satelliteCount; i++) {
+        LocationSatelliteRecord &satellite = record.satellites[i];
+        satellite.id = parser.satelliteId(i);
+        satellite.carrierToNoiseRatio = parser.satelliteCarrierToNoiseRatio(i);
+        satellite.azimuth = parser.satelliteAzimuth(i);
+        satellite.elevation = parser.satelliteElevation(i);
+
+        if (parser.satelliteEphemerisAvailable(i))
+            satellite.flags |= LocationSatelliteRecord::EphemerisAvailable;
+        if (parser.satelliteTracked(i))
+            satellite.flags |= LocationSatelliteRecord::Tracked;
+        if (parser.satelliteUsed(i))
+            satellite.flags |= LocationSatelliteRecord::Used;
+        if (parser.satelliteAlmanac(i))
+            satellite.flags |= LocationSatelliteRecord::Almanac;
+    }
+
+    return record;
+}
+
 void LocationSession::parseRawData()
 {
     // Parsing the raw data from the low level Location Manager. Use this only if a field is not accessible via QGeoPositionInfo above.
@@ -237,43 +329,42 @@ void LocationSession::parseRawData()
 
     RawLocationParser parser(replyData);
 
-    m_method = parser.positionMethod();
-    m_horizontalDilution = QString::number(parser.hdop());
-    m_verticalDilution = QString::number(parser.vdop());
-    m_positionDilution = QString::number(parser.pdop());
-    m_ttff = QString::number(parser.ttff());
-    m_gpsWeek = QString::number(parser.gpsWeek());
-    m_gpsTimeOfWeek = QString::number(parser.gpsTow());
-    m_isPropagated = parser.propagated();
-
-    const double latitude = parser.latitude();
-    const double longitude = parser.longitude();
-    const double altitude = parser.altitude();
-    const double hAccuracy = parser.horizontalAccuracy();
-    const double vAccuracy = parser.verticalAccuracy();
-    const double heading = parser.heading();
-    const double speed = parser.speed();
-    const double utc = parser.utc();
+    const LocationRecord record = recordFromParser(parser);
 
-    log(
-            tr("Method: %0, Latitude: %1, Longitude: %2, Altitude: %3, Horizontal Accuracy: %4, Vertical Accuracy: %5, Heading: %6, Speed: %7, TTFF: %8, GPS Week: %9, ").arg(m_method).arg(latitude).arg(longitude).arg(altitude).arg(hAccuracy).arg(vAccuracy).arg(heading).arg(speed).arg(m_ttff).arg(m_gpsWeek)
-                    + tr("GPS TOW: %0, UTC: %1, Horizontal Dilution: %2, Vertical Dilution: %3, Positional Dilution: %4, Propagated: %5").arg(m_gpsTimeOfWeek).arg(utc).arg(m_horizontalDilution).arg(m_verticalDilution).arg(m_positionDilution).arg(m_isPropagated ? tr("true") : tr("false")), false);
+    // Never blocks, a fix is dropped if the log falls behind
+    if (m_recorder)
+        m_recorder->append(record);
+
+    applyRecord(record);
 
     const QString error = parser.error();
     if (error.length() > 3) {
         log(tr("!!! [Error] %1").arg(error));
     }
+}
+
+void LocationSession::applyRecord(const LocationRecord &record)
+{
+    m_method = QString::fromLatin1(record.method);
+    m_horizontalDilution = QString::number(record.hdop);
+    m_verticalDilution = QString::number(record.vdop);
+    m_positionDilution = QString::number(record.pdop);
+    m_ttff = QString::number(record.ttff);
+    m_gpsWeek = QString::number(record.gpsWeek);
+    m_gpsTimeOfWeek = QString::number(record.gpsTow);
+    m_isPropagated = (record.flags & LocationRecord::Propagated);
+
+    log(
+            tr("Method: %0, Latitude: %1, Longitude: %2, Altitude: %3, Horizontal Accuracy: %4, Vertical Accuracy: %5, Heading: %6, Speed: %7, TTFF: %8, GPS Week: %9, ").arg(m_method).arg(record.latitude).arg(record.longitude).arg(record.altitude).arg(record.horizontalAccuracy).arg(record.verticalAccuracy).arg(record.heading).arg(record.speed).arg(m_ttff).arg(m_gpsWeek)
+                    + tr("GPS TOW: %0, UTC: %1, Horizontal Dilution: %2, Vertical Dilution: %3, Positional Dilution: %4, Propagated: %5").arg(m_gpsTimeOfWeek).arg(record.utc).arg(m_horizontalDilution).arg(m_verticalDilution).arg(m_positionDilution).arg(m_isPropagated ? tr("true") : tr("false")), false);
 
-    for (int i = 0; i < parser.numberOfSatellites(); i++) {
-        const double id = parser.satelliteId(i);
-        const double cno = parser.satelliteCarrierToNoiseRatio(i);
-        const bool ephemerisAvailable = parser.satelliteEphemerisAvailable(i);
-        const double azimuth = parser.satelliteAzimuth(i);
-        const double elevation = parser.satelliteElevation(i);
-        const bool tracked = parser.satelliteTracked(i);
-        const bool used = parser.satelliteUsed(i);
+    for (quint32 i = 0; i < record.satelliteCount; i++) {
+        const LocationSatelliteRecord &satellite = record.satellites[i];
+        const bool ephemerisAvailable = (satellite.flags & LocationSatelliteRecord::EphemerisAvailable);
+        const bool tracked = (satellite.flags & LocationSatelliteRecord::Tracked);
+        const bool used = (satellite.flags & LocationSatelliteRecord::Used);
 
-        log(tr("\t[Satellite %0], ID: %1, CNO: %2, Ephemeris Available: %3, Azimuth: %4, Elevation: %5, Tracked: %6, Used: %7").arg(i).arg(id).arg(cno).arg(ephemerisAvailable ? tr("true") : tr("false")).arg(azimuth).arg(elevation).arg(tracked ? tr("true") : tr("false")).arg(used ? tr("true") : tr("false")), false);
+        log(tr("\t[Satellite %0], ID: %1, CNO: %2, Ephemeris Available: %3, Azimuth: %4, Elevation: %5, Tracked: %6, Used: %7").arg(i).arg(satellite.id).arg(satellite.carrierToNoiseRatio).arg(ephemerisAvailable ? tr("true") : tr("false")).arg(satellite.azimuth).arg(satellite.elevation).arg(tracked ? tr("true") : tr("false")).arg(used ? tr("true") : tr("false")), false);
     }
 }
 
@@ -16,6 +16,8 @@
 #ifndef LOCATIONSESSION_HPP
 #define LOCATIONSESSION_HPP
 
+#include "LocationRecord.hpp"
+
 #include <QDebug>
 #include <QtLocationSubset/QGeoPositionInfo>
 #include <QtLocationSubset/QGeoPositionInfoSource>
@@ -28,6 +30,8 @@
 
 using namespace QtMobilitySubset;
 
+class LocationRecorder;
+
 /**
  * @short A helper class that encapsulates the retrieval of location information.
  */
@@ -78,12 +82,19 @@ public:
     // Sets whether a sound should be played on retrieval of new location information
     void setSoundEnabled(bool enabled);
 
+    // Starts recording every retrieved fix to the given telemetry log
+    bool startRecording(const QString &fileName);
+
     // This method is called to stop the retrieval of location information
     Q_INVOKABLE void stopUpdates();
 
     // This method is called to reset the internal retrieval engine
     Q_INVOKABLE void resetSession(const QString &type);
 
+public Q_SLOTS:
+    // This slot is invoked for every fix of a replayed telemetry log
+    void replayRecord(const LocationRecord &record);
+
 Q_SIGNALS:
     // The change notification signals of the properties
     void dataChanged();
@@ -110,6 +121,12 @@ private:
     // A helper method to parse the raw geo information
     void parseRawData();
 
+    // A helper method to update the properties from a parsed or replayed fix
+    void applyRecord(const LocationRecord &record);
+
+    // A helper method to move the location pin on the map view
+    void updateMapView();
+
     // A helper message to log events
     void log(const QString &msg, bool showInUi = true);
 
@@ -147,6 +164,9 @@ private:
     // The central object to retrieve satellite information
     QGeoSatelliteInfoSource *m_satelliteSource;
 
+    // The telemetry log of the session, if recording
+    LocationRecorder *m_recorder;
+
     // The property values
     QString m_method;
     double m_latitude;
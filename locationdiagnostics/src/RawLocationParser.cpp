@@ -18,207 +18,218 @@
 #include <QtCore/qnumeric.h>
 
 RawLocationParser::RawLocationParser(const QVariant & replyData)
-    : m_replyData(replyData)
 {
+    // replyData is a QVariantMap holding all of the reply parameters
+    const QVariantMap positionData = replyData.toMap();
+
+    m_position.latitude = parseDouble(positionData, "latitude");
+    m_position.longitude = parseDouble(positionData, "longitude");
+    m_position.altitude = parseDouble(positionData, "altitude");
+    m_position.horizontalAccuracy = parseDouble(positionData, "accuracy");
+    m_position.verticalAccuracy = parseDouble(positionData, "altitudeAccuracy");
+    m_position.heading = parseDouble(positionData, "heading");
+    m_position.speed = parseDouble(positionData, "speed");
+    m_position.ttff = parseDouble(positionData, "ttff");
+    m_position.gpsWeek = parseDouble(positionData, "gpsWeek");
+    m_position.gpsTow = parseDouble(positionData, "gpsTow");
+    m_position.utc = parseDouble(positionData, "utc");
+    m_position.hdop = parseDouble(positionData, "hdop");
+    m_position.vdop = parseDouble(positionData, "vdop");
+    m_position.pdop = parseDouble(positionData, "pdop");
+    m_position.propagated = parseBool(positionData, "propagated");
+
+    m_positionMethod = QString::fromLatin1("%1 [%2]").arg(parseString(positionData, "fix_type"))
+                                                     .arg(parseString(positionData, "provider"));
+    m_error = QString::fromLatin1("%1: %2").arg(parseString(positionData, "err"))
+                                           .arg(parseString(positionData, "errstr"));
+
+    const QVariant satellites = positionData.value("satellites");
+    if (satellites.isValid() && satellites.canConvert<QVariantList>()) {
+        const QVariantList satelliteList = satellites.toList();
+        m_satellites.reserve(satelliteList.size());
+
+        foreach (const QVariant &satellite, satelliteList) {
+            const QVariantMap satelliteData = satellite.toMap();
+
+            Satellite sat;
+            sat.id = parseDouble(satelliteData, "id");
+            sat.carrierToNoiseRatio = parseDouble(satelliteData, "cno");
+            sat.azimuth = parseDouble(satelliteData, "azimuth");
+            sat.elevation = parseDouble(satelliteData, "elevation");
+            sat.ephemerisAvailable = parseBool(satelliteData, "ephemeris");
+            sat.tracked = parseBool(satelliteData, "tracked");
+            sat.used = parseBool(satelliteData, "used");
+            sat.almanac = parseBool(satelliteData, "almanac");
+            m_satellites.append(sat);
+        }
+    }
 }
 
 double RawLocationParser::latitude() const
 {
-    return parseDouble(m_replyData, "latitude");
+    return m_position.latitude;
 }
 
 double RawLocationParser::longitude() const
 {
-    return parseDouble(m_replyData, "longitude");
+    return m_position.longitude;
 }
 
 double RawLocationParser::altitude() const
 {
-    return parseDouble(m_replyData, "altitude");
+    return m_position.altitude;
 }
 
 double RawLocationParser::horizontalAccuracy() const
 {
-    return parseDouble(m_replyData, "accuracy");
+    return m_position.horizontalAccuracy;
 }
 
 double RawLocationParser::verticalAccuracy() const
 {
-    return parseDouble(m_replyData, "altitudeAccuracy");
+    return m_position.verticalAccuracy;
 }
 
 double RawLocationParser::heading() const
 {
-    return parseDouble(m_replyData, "heading");
+    return m_position.heading;
 }
 
 double RawLocationParser::speed() const
 {
-    return parseDouble(m_replyData, "speed");
+    return m_position.speed;
 }
 
 double RawLocationParser::ttff() const
 {
-    return parseDouble(m_replyData, "ttff");
+    return m_position.ttff;
 }
 
 double RawLocationParser::gpsWeek() const
 {
-    return parseDouble(m_replyData, "gpsWeek");
+    return m_position.gpsWeek;
 }
 
 double RawLocationParser::gpsTow() const
 {
-    return parseDouble(m_replyData, "gpsTow");
+    return m_position.gpsTow;
 }
 
 double RawLocationParser::utc() const
 {
-    return parseDouble(m_replyData, "utc");
+    return m_position.utc;
 }
 
 double RawLocationParser::hdop() const
 {
-    return parseDouble(m_replyData, "hdop");
+    return m_position.hdop;
 }
 
 double RawLocationParser::vdop() const
 {
-    return parseDouble(m_replyData, "vdop");
+    return m_position.vdop;
 }
 
 double RawLocationParser::pdop() const
 {
-    return parseDouble(m_replyData, "pdop");
+    return m_position.pdop;
 }
 
 bool RawLocationParser::propagated() const
 {
-    return parseBool(m_replyData, "propagated");
+    return m_position.propagated;
 }
 
 QString RawLocationParser::positionMethod() const
 {
-    const QString fixType = parseString(m_replyData, "fix_type");
-    const QString provider = parseString(m_replyData, "provider");
-
-    return QString::fromLatin1("%1 [%2]").arg(fixType).arg(provider);
+    return m_positionMethod;
 }
 
 QString RawLocationParser::error() const
 {
-    const QString err = parseString(m_replyData, "err");
-    const QString errstr = parseString(m_replyData, "errstr");
-
-    return QString::fromLatin1("%1: %2").arg(err).arg(errstr);
+    return m_error;
 }
 
 int RawLocationParser::numberOfSatellites() const
 {
-    QVariantList satellites;
-
-    const bool sizeFound = parseList(&satellites, m_replyData, "satellites");
-    if (sizeFound == false) {
-        return 0;
-    }
-
-    return satellites.size();
+    return m_satellites.size();
 }
 
 double RawLocationParser::satelliteId(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return qQNaN();
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseDouble(sat, "id");
+    return m_satellites.at(satIndex).id;
 }
 
 double RawLocationParser::satelliteCarrierToNoiseRatio(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return qQNaN();
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseDouble(sat, "cno");
+    return m_satellites.at(satIndex).carrierToNoiseRatio;
 }
 
 bool RawLocationParser::satelliteEphemerisAvailable(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return false;
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseBool(sat, "ephemeris");
+    return m_satellites.at(satIndex).ephemerisAvailable;
 }
 
 double RawLocationParser::satelliteAzimuth(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return qQNaN();
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseDouble(sat, "azimuth");
+    return m_satellites.at(satIndex).azimuth;
 }
 
 double RawLocationParser::satelliteElevation(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return qQNaN();
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseDouble(sat, "elevation");
+    return m_satellites.at(satIndex).elevation;
 }
 
 bool RawLocationParser::satelliteTracked(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return false;
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseBool(sat, "tracked");
+    return m_satellites.at(satIndex).tracked;
 }
 
 bool RawLocationParser::satelliteUsed(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return false;
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseBool(sat, "used");
+    return m_satellites.at(satIndex).used;
 }
 
 bool RawLocationParser::satelliteAlmanac(int satIndex) const
 {
-    QVariantList satellites;
-    if (parseList(&satellites, m_replyData, "satellites") == false) {
+    if (satIndex < 0 || satIndex >= m_satellites.size()) {
         return false;
     }
 
-    const QVariant sat = satellites.at(satIndex);
-    return parseBool(sat, "almanac");
+    return m_satellites.at(satIndex).almanac;
 }
 
-double RawLocationParser::parseDouble(const QVariant & replyData, const QString & key) const
+double RawLocationParser::parseDouble(const QVariantMap & replyData, const QString & key)
 {
-    // replyData is a QVariantMap holding all of the reply parameters
-    const QVariantMap positionData = replyData.toMap();
-
-    const QVariant val = positionData.value(key);
+    const QVariant val = replyData.value(key);
     if (val.isValid() && val.canConvert<double>()) {
         return val.toDouble();
     }
@@ -226,12 +237,9 @@ double RawLocationParser::parseDouble(const QVariant & replyData, const QString
     return qQNaN();
 }
 
-bool RawLocationParser::parseBool(const QVariant & replyData, const QString & key) const
+bool RawLocationParser::parseBool(const QVariantMap & replyData, const QString & key)
 {
-    // replyData is a QVariantMap holding all of the reply parameters
-    const QVariantMap positionData = replyData.toMap();
-
-    const QVariant val = positionData.value(key);
+    const QVariant val = replyData.value(key);
     if (val.isValid() && val.canConvert<bool>()) {
         return val.toBool();
     }
@@ -239,30 +247,12 @@ bool RawLocationParser::parseBool(const QVariant & replyData, const QString & ke
     return false;
 }
 
-QString RawLocationParser::parseString(const QVariant & replyData, const QString & key) const
+QString RawLocationParser::parseString(const QVariantMap & replyData, const QString & key)
 {
-    // replyData is a QVariantMap holding all of the reply parameters
-    const QVariantMap positionData = replyData.toMap();
-
-    const QVariant val = positionData.value(key);
+    const QVariant val = replyData.value(key);
     if (val.isValid() && val.canConvert<QString>()) {
         return val.toString();
     }
 
     return "";
 }
-
-bool RawLocationParser::parseList(QVariantList *out, const QVariant & replyData, const QString & key) const
-{
-    // replyData is a QVariantMap holding all of the reply parameters
-    const QVariantMap positionData = replyData.toMap();
-
-    const QVariant val = positionData.value(key);
-    if (val.isValid() && val.canConvert<QVariantList>()) {
-        *out = val.toList();
-        return true;
-    }
-
-    return false;
-}
-
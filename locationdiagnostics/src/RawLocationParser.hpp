@@ -18,9 +18,12 @@
 
 #include <QtCore/QObject>
 #include <QtCore/QVariant>
+#include <QtCore/QVector>
 
 /**
  * A utility class to parse the raw reply from the lower level Location Manager of the OS.
+ *
+ * The reply is decoded once in the constructor, so all getters are plain field reads.
  */
 class RawLocationParser
 {
@@ -57,12 +60,45 @@ public:
     bool satelliteAlmanac(int satIndex) const;
 
 private:
-    double parseDouble(const QVariant & replyData, const QString & key) const;
-    bool parseBool(const QVariant & replyData, const QString & key) const;
-    QString parseString(const QVariant & replyData, const QString & key) const;
-    bool parseList(QVariantList *out, const QVariant & replyData, const QString & key) const;
+    struct Position
+    {
+        double latitude;
+        double longitude;
+        double altitude;
+        double horizontalAccuracy;
+        double verticalAccuracy;
+        double heading;
+        double speed;
+        double ttff;
+        double gpsWeek;
+        double gpsTow;
+        double utc;
+        double hdop;
+        double vdop;
+        double pdop;
+        bool propagated;
+    };
 
-    QVariant m_replyData;
+    struct Satellite
+    {
+        double id;
+        double carrierToNoiseRatio;
+        double azimuth;
+        double elevation;
+        bool ephemerisAvailable;
+        bool tracked;
+        bool used;
+        bool almanac;
+    };
+
+    static double parseDouble(const QVariantMap & replyData, const QString & key);
+    static bool parseBool(const QVariantMap & replyData, const QString & key);
+    static QString parseString(const QVariantMap & replyData, const QString & key);
+
+    Position m_position;
+    QVector<Satellite> m_satellites;
+    QString m_positionMethod;
+    QString m_error;
 };
 
 #endif
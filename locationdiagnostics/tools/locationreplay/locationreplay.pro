@@ -0,0 +1,21 @@
+# A console tool which replays a telemetry log through LocationReplay.
+# It only needs QtCore, so it builds and runs on a desktop Qt 4.8:
+#
+#   qmake && make && ./locationreplay fixtures/drive.loc 10
+
+TEMPLATE = app
+TARGET = locationreplay
+
+QT = core
+CONFIG += console warn_on
+CONFIG -= app_bundle
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    main.cpp \
+    ../../src/LocationReplay.cpp
+
+HEADERS += \
+    ../../src/LocationRecord.hpp \
+    ../../src/LocationReplay.hpp
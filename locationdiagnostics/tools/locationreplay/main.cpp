@@ -0,0 +1,118 @@
+/* Copyright (c) 2012, 2013  BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "LocationReplay.hpp"
+
+#include <QtCore/QCoreApplication>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QStringList>
+#include <QtCore/QTextStream>
+
+/**
+ * Prints every fix replayed from a telemetry log, with the time it was replayed at
+ * and the time it was recorded at, both relative to the first fix.
+ */
+class ReplayPrinter : public QObject
+{
+    Q_OBJECT
+
+public:
+    ReplayPrinter(QObject *parent = 0)
+        : QObject(parent)
+        , m_firstTimestamp(0)
+        , m_count(0)
+        , m_out(stdout)
+    {
+    }
+
+    int count() const
+    {
+        return m_count;
+    }
+
+public Q_SLOTS:
+    void print(const LocationRecord &record)
+    {
+        if (m_count++ == 0) {
+            m_firstTimestamp = record.timestamp;
+            m_elapsed.start();
+        }
+
+        m_out << QString::fromLatin1("%1 ms  +%2 ms  %3, %4  +/-%5 m  %6 satellites  %7")
+                     .arg(m_elapsed.elapsed(), 6)
+                     .arg(record.timestamp - m_firstTimestamp, 6)
+                     .arg(record.latitude, 0, 'f', 6)
+                     .arg(record.longitude, 0, 'f', 6)
+                     .arg(record.horizontalAccuracy, 0, 'f', 1)
+                     .arg(record.satelliteCount)
+                     .arg(QString::fromLatin1(record.method))
+              << endl;
+    }
+
+private:
+    qint64 m_firstTimestamp;
+    int m_count;
+    QElapsedTimer m_elapsed;
+    QTextStream m_out;
+};
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    const QStringList args = app.arguments();
+    if (args.count() < 2 || args.count() > 3) {
+        QTextStream(stderr) << "usage: locationreplay <log.loc> [speed]" << endl
+                            << "  speed 1 replays in real time, 0 as fast as possible (default 1)" << endl;
+        return 2;
+    }
+
+    double speed = 1.0;
+    if (args.count() == 3) {
+        bool ok = false;
+        speed = args.at(2).toDouble(&ok);
+        if (!ok || speed < 0) {
+            QTextStream(stderr) << "locationreplay: invalid speed " << args.at(2) << endl;
+            return 2;
+        }
+    }
+
+    LocationReplay replay;
+    replay.setSpeed(speed);
+    if (!replay.open(args.at(1)))
+        return 1;
+
+    if (replay.recordCount() == 0) {
+        QTextStream(stderr) << "locationreplay: " << args.at(1) << " has no fixes" << endl;
+        return 1;
+    }
+
+    ReplayPrinter printer;
+
+    bool ok = QObject::connect(&replay, SIGNAL(recordReplayed(const LocationRecord &)), &printer, SLOT(print(const LocationRecord &)));
+    Q_ASSERT(ok);
+    ok = QObject::connect(&replay, SIGNAL(finished()), &app, SLOT(quit()));
+    Q_ASSERT(ok);
+    Q_UNUSED(ok);
+
+    replay.start();
+    app.exec();
+
+    QTextStream(stdout) << printer.count() << " of " << replay.recordCount() << " fixes replayed" << endl;
+
+    return printer.count() == replay.recordCount() ? 0 : 1;
+}
+
+#include "main.moc"
@@ -53,13 +53,17 @@ config_pri_assets {
 
 config_pri_source_group1 {
     SOURCES += \
-        $$quote($$BASEDIR/src/RawHeaderView.cpp) \
         $$quote($$BASEDIR/src/applicationui.cpp) \
-        $$quote($$BASEDIR/src/main.cpp)
+        $$quote($$BASEDIR/src/ContactsDataModel.cpp) \
+        $$quote($$BASEDIR/src/main.cpp) \
+        $$quote($$BASEDIR/src/RawHeaderView.cpp) \
+        $$quote($$BASEDIR/src/SegmentedDownload.cpp)
 
     HEADERS += \
+        $$quote($$BASEDIR/src/applicationui.hpp) \
+        $$quote($$BASEDIR/src/ContactsDataModel.hpp) \
         $$quote($$BASEDIR/src/RawHeaderView.hpp) \
-        $$quote($$BASEDIR/src/applicationui.hpp)
+        $$quote($$BASEDIR/src/SegmentedDownload.hpp)
 }
 
 INCLUDEPATH += $$quote($$BASEDIR/src)
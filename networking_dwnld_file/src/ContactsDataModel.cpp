@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2011-2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ */
+
+#include "ContactsDataModel.hpp"
+
+#include <QVariantMap>
+
+ContactsDataModel::ContactsDataModel(QObject *parent) :
+        bb::cascades::DataModel(parent)
+{
+}
+
+int ContactsDataModel::childCount(const QVariantList& indexPath)
+{
+    if (indexPath.size() == 0)
+    {
+        return m_Headers.size();
+    }
+
+    if (indexPath.size() == 1)
+    {
+        const int header = indexPath[0].toInt();
+        if (header >= 0 && header < m_Headers.size())
+        {
+            return m_Headers[header].contacts.size();
+        }
+    }
+
+    return 0;
+}
+
+bool ContactsDataModel::hasChildren(const QVariantList& indexPath)
+{
+    return childCount(indexPath) > 0;
+}
+
+QVariant ContactsDataModel::data(const QVariantList& indexPath)
+{
+    // Like XmlDataModel, the item data is a map of the element
+    // attributes, so ListItemData.title works for both models
+    QVariantMap item;
+    const int header = indexPath.size() > 0 ? indexPath[0].toInt() : -1;
+
+    if (header >= 0 && header < m_Headers.size())
+    {
+        if (indexPath.size() == 1)
+        {
+            item["title"] = m_Headers[header].title;
+        }
+        else if (indexPath.size() == 2)
+        {
+            const int contact = indexPath[1].toInt();
+            if (contact >= 0 && contact < m_Headers[header].contacts.size())
+            {
+                item["title"] = m_Headers[header].contacts[contact];
+            }
+        }
+    }
+
+    return item;
+}
+
+QString ContactsDataModel::itemType(const QVariantList& indexPath)
+{
+    switch (indexPath.size())
+    {
+        case 1:
+            return QLatin1String("header");
+
+        case 2:
+            return QLatin1String("contacts");
+
+        default:
+            return QString();
+    }
+}
+
+void ContactsDataModel::appendHeader(const QString& title)
+{
+    Header header;
+    header.title = title;
+    m_Headers.append(header);
+
+    emit itemAdded(QVariantList() << m_Headers.size() - 1);
+}
+
+void ContactsDataModel::appendContact(const QString& title)
+{
+    // Contacts before the first header get an untitled header
+    if (m_Headers.isEmpty())
+    {
+        appendHeader(QString());
+    }
+
+    const int header = m_Headers.size() - 1;
+    m_Headers[header].contacts.append(title);
+
+    emit itemAdded(QVariantList() << header << m_Headers[header].contacts.size() - 1);
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright (c) 2011-2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ */
+
+#ifndef CONTACTSDATAMODEL_HPP_
+#define CONTACTSDATAMODEL_HPP_
+
+#include <QList>
+#include <QStringList>
+#include <bb/cascades/DataModel>
+
+// A two level data model of contact list headers and contacts, with
+// the same item types and item data as an XmlDataModel loaded from
+// contacts_list.xml. Unlike XmlDataModel it can grow while the file
+// is still being downloaded.
+class ContactsDataModel : public bb::cascades::DataModel
+{
+    Q_OBJECT
+
+    public:
+        ContactsDataModel ( QObject *parent = 0 );
+        virtual ~ContactsDataModel () {}
+
+        // Required interface implementation
+        virtual int childCount ( const QVariantList& indexPath );
+        virtual bool hasChildren ( const QVariantList& indexPath );
+        virtual QVariant data ( const QVariantList& indexPath );
+        virtual QString itemType ( const QVariantList& indexPath );
+
+    public slots:
+        void appendHeader ( const QString& title );
+        void appendContact ( const QString& title );
+
+    private:
+        struct Header
+        {
+            QString title;
+            QStringList contacts;
+        };
+
+        QList<Header> m_Headers;
+};
+
+#endif /* CONTACTSDATAMODEL_HPP_ */
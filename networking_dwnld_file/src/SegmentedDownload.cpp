@@ -0,0 +1,667 @@
+/*
+ * Copyright (c) 2011-2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ */
+
+#include "SegmentedDownload.hpp"
+
+#include <QDebug>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QSettings>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+// The most data a reply buffers before the socket stops reading,
+// and the size of the pieces taken from it
+static const qint64 READ_BUFFER_SIZE = 64 * 1024;
+static const qint64 CHUNK_SIZE = 16 * 1024;
+
+// Smaller segments cost more in requests than they gain
+static const qint64 MIN_SEGMENT_SIZE = 256 * 1024;
+
+// How much data may be written before the journal is saved again
+static const qint64 JOURNAL_INTERVAL = 256 * 1024;
+
+SegmentedDownload::SegmentedDownload(QNetworkAccessManager *manager, const QString& filePath,
+        QObject *parent) :
+        QObject(parent), m_pNetAccessMngr(manager), m_pHeadReply(NULL), m_FilePath(filePath),
+        m_JournalPath(filePath + ".journal"), m_Error(QNetworkReply::NoError),
+        m_SegmentCount(DefaultSegmentCount), m_Size(-1), m_BytesReceived(0), m_SessionBytes(0),
+        m_UnsavedBytes(0), m_ParsedOffset(0), m_FirstRecordTime(-1), m_Running(false)
+{
+    m_PartFile.setFileName(filePath + ".part");
+}
+
+bool SegmentedDownload::start(const QUrl& url)
+{
+    if (m_Running)
+    {
+        return true;
+    }
+
+    if (!m_PartFile.open(QIODevice::ReadWrite))
+    {
+        qWarning() << "SegmentedDownload could not open" << m_PartFile.fileName();
+        return false;
+    }
+
+    m_Url = url;
+    m_Error = QNetworkReply::NoError;
+    m_SessionBytes = 0;
+    m_FirstRecordTime = -1;
+    m_Running = true;
+    m_Timer.start();
+
+    // The size, the validator and the range support decide how
+    // the file is fetched and whether the journal can be used
+    m_pHeadReply = m_pNetAccessMngr->head(QNetworkRequest(url));
+
+    bool res = QObject::connect(m_pHeadReply, SIGNAL(finished()), this, SLOT(onHeadFinished()));
+    Q_ASSERT(res);
+    Q_UNUSED(res);
+
+    return true;
+}
+
+void SegmentedDownload::setSegmentCount(int count)
+{
+    m_SegmentCount = qMax(1, count);
+}
+
+int SegmentedDownload::segmentCount() const
+{
+    return m_SegmentCount;
+}
+
+QNetworkReply::NetworkError SegmentedDownload::error() const
+{
+    return m_Error;
+}
+
+QList<QNetworkReply::RawHeaderPair> SegmentedDownload::rawHeaderPairs() const
+{
+    return m_RawHeaders;
+}
+
+qint64 SegmentedDownload::throughput() const
+{
+    return m_SessionBytes * 1000 / qMax(Q_INT64_C(1), m_Timer.elapsed());
+}
+
+void SegmentedDownload::onHeadFinished()
+{
+    QNetworkReply* reply = m_pHeadReply;
+    m_pHeadReply = NULL;
+    reply->deleteLater();
+
+    const QNetworkReply::NetworkError error = reply->error();
+    if (error > QNetworkReply::NoError && error < QNetworkReply::ContentAccessDenied)
+    {
+        // Connection and proxy errors, the GET would fail as well
+        m_Error = error;
+        fail(true);
+        return;
+    }
+
+    m_RawHeaders = reply->rawHeaderPairs();
+
+    bool sizeOk = false;
+    const qint64 size = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&sizeOk);
+    QByteArray validator = reply->rawHeader("ETag");
+    if (validator.isEmpty())
+    {
+        validator = reply->rawHeader("Last-Modified");
+    }
+
+    // Servers which do not answer HEAD are still asked for the file
+    const bool ranges = error == QNetworkReply::NoError
+            && reply->rawHeader("Accept-Ranges").contains("bytes");
+    if (!ranges || !sizeOk || size <= 0)
+    {
+        planUnsegmented(sizeOk ? size : -1);
+    }
+    else if (!loadJournal(size, validator))
+    {
+        planSegments(size, validator);
+    }
+
+    // Records already on disk are read again for the new list
+    m_XmlReader.clear();
+    m_ParsedOffset = 0;
+    emit restarted();
+    parseWrittenData();
+
+    m_BytesReceived = 0;
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        m_BytesReceived += m_Segments[i].done;
+        if (!m_Segments[i].complete())
+        {
+            requestSegment(m_Segments[i]);
+        }
+    }
+
+    if (m_BytesReceived > 0)
+    {
+        qDebug() << "SegmentedDownload resumes after" << m_BytesReceived << "of" << m_Size << "bytes";
+        emit downloadProgress(m_BytesReceived, m_Size);
+    }
+
+    if (isComplete())
+    {
+        // Only the rename was left
+        complete();
+    }
+}
+
+void SegmentedDownload::onSegmentReadyRead()
+{
+    const int index = indexOf(qobject_cast<QNetworkReply*>(sender()));
+    if (index >= 0)
+    {
+        readSegment(m_Segments[index]);
+    }
+}
+
+void SegmentedDownload::onSegmentFinished()
+{
+    QNetworkReply* reply = qobject_cast<QNetworkReply*>(sender());
+    reply->deleteLater();
+
+    const int index = indexOf(reply);
+    if (index < 0)
+    {
+        // Aborted by fail()
+        return;
+    }
+
+    if (reply->error() == QNetworkReply::NoError)
+    {
+        readSegment(m_Segments[index]);
+        if (!m_Running)
+        {
+            return;
+        }
+    }
+
+    Segment& segment = m_Segments[index];
+    segment.reply = NULL;
+
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        m_Error = reply->error();
+        fail(true);
+        return;
+    }
+
+    if (segment.end < 0)
+    {
+        // Without a size, the end of the reply is the end of the file
+        segment.end = segment.position() - 1;
+        m_Size = segment.position();
+    }
+    else if (!segment.complete())
+    {
+        m_Error = QNetworkReply::RemoteHostClosedError;
+        fail(true);
+        return;
+    }
+
+    if (isComplete())
+    {
+        complete();
+    }
+}
+
+// Reads the segments saved by an earlier attempt. They are only used
+// for the same, unchanged file.
+bool SegmentedDownload::loadJournal(qint64 size, const QByteArray& validator)
+{
+    if (validator.isEmpty() || m_PartFile.size() != size)
+    {
+        return false;
+    }
+
+    QSettings journal(m_JournalPath, QSettings::IniFormat);
+    if (journal.value("url").toString() != m_Url.toString()
+            || journal.value("size").toLongLong() != size
+            || journal.value("validator").toByteArray() != validator)
+    {
+        return false;
+    }
+
+    QList<Segment> segments;
+    qint64 next = 0;
+    const int count = journal.beginReadArray("segments");
+    for (int i = 0; i < count; ++i)
+    {
+        journal.setArrayIndex(i);
+
+        Segment segment;
+        segment.start = journal.value("start").toLongLong();
+        segment.end = journal.value("end").toLongLong();
+        segment.done = journal.value("done").toLongLong();
+        segment.reply = NULL;
+        segment.checked = false;
+
+        // The segments must cover the file in order
+        if (segment.start != next || segment.end < segment.start || segment.done < 0
+                || segment.position() > segment.end + 1)
+        {
+            return false;
+        }
+        next = segment.end + 1;
+        segments.append(segment);
+    }
+    journal.endArray();
+
+    if (next != size)
+    {
+        return false;
+    }
+
+    m_Segments = segments;
+    m_Size = size;
+    m_Validator = validator;
+    return true;
+}
+
+void SegmentedDownload::saveJournal()
+{
+    m_UnsavedBytes = 0;
+
+    // Without a validator a changed file could not be detected
+    if (m_Validator.isEmpty() || m_Segments.isEmpty() || m_Segments.first().end < 0)
+    {
+        QFile::remove(m_JournalPath);
+        return;
+    }
+
+    // The data must reach the file before the journal claims it
+    m_PartFile.flush();
+
+    QSettings journal(m_JournalPath, QSettings::IniFormat);
+    journal.clear();
+    journal.setValue("url", m_Url.toString());
+    journal.setValue("size", m_Size);
+    journal.setValue("validator", m_Validator);
+    journal.beginWriteArray("segments", m_Segments.size());
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        journal.setArrayIndex(i);
+        journal.setValue("start", m_Segments[i].start);
+        journal.setValue("end", m_Segments[i].end);
+        journal.setValue("done", m_Segments[i].done);
+    }
+    journal.endArray();
+    journal.sync();
+}
+
+void SegmentedDownload::planSegments(qint64 size, const QByteArray& validator)
+{
+    const int count = qBound(Q_INT64_C(1), (size + MIN_SEGMENT_SIZE - 1) / MIN_SEGMENT_SIZE,
+            qint64(m_SegmentCount));
+    const qint64 segmentSize = size / count;
+
+    m_Segments.clear();
+    for (int i = 0; i < count; ++i)
+    {
+        Segment segment;
+        segment.start = i * segmentSize;
+        segment.end = i == count - 1 ? size - 1 : segment.start + segmentSize - 1;
+        segment.done = 0;
+        segment.reply = NULL;
+        segment.checked = false;
+        m_Segments.append(segment);
+    }
+
+    // Reserve the whole file up front, every segment writes to its place
+    m_PartFile.resize(0);
+    if (!m_PartFile.resize(size))
+    {
+        qWarning() << "SegmentedDownload could not allocate" << size << "bytes";
+    }
+
+    m_Size = size;
+    m_Validator = validator;
+    saveJournal();
+}
+
+void SegmentedDownload::planUnsegmented(qint64 size)
+{
+    Segment segment;
+    segment.start = 0;
+    segment.end = -1;
+    segment.done = 0;
+    segment.reply = NULL;
+    segment.checked = false;
+
+    m_Segments.clear();
+    m_Segments.append(segment);
+    m_PartFile.resize(0);
+
+    m_Size = size;
+    m_Validator.clear();
+    saveJournal();
+}
+
+void SegmentedDownload::requestSegment(Segment& segment)
+{
+    QNetworkRequest request(m_Url);
+    if (segment.end >= 0)
+    {
+        request.setRawHeader("Range", "bytes=" + QByteArray::number(segment.position()) + "-"
+                + QByteArray::number(segment.end));
+        // A changed file is sent whole, and then rejected
+        request.setRawHeader("If-Range", m_Validator);
+    }
+
+    segment.checked = false;
+    segment.reply = m_pNetAccessMngr->get(request);
+    segment.reply->setReadBufferSize(READ_BUFFER_SIZE);
+
+    bool res;
+    Q_UNUSED(res);
+
+    res = QObject::connect(segment.reply, SIGNAL(readyRead()), this, SLOT(onSegmentReadyRead()));
+    Q_ASSERT(res);
+
+    res = QObject::connect(segment.reply, SIGNAL(finished()), this, SLOT(onSegmentFinished()));
+    Q_ASSERT(res);
+}
+
+// Checks the status once, before the first byte of the body is used.
+// Returns true while the body of the reply should be written.
+bool SegmentedDownload::acceptResponse(Segment& segment)
+{
+    if (segment.checked)
+    {
+        return true;
+    }
+
+    const QVariant status = segment.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if (!status.isValid())
+    {
+        // Headers not received yet
+        return false;
+    }
+    segment.checked = true;
+
+    if (segment.end < 0)
+    {
+        if (status.toInt() == 200)
+        {
+            return true;
+        }
+    }
+    else if (status.toInt() == 206)
+    {
+        const QByteArray expected = "bytes " + QByteArray::number(segment.position()) + "-";
+        if (segment.reply->rawHeader("Content-Range").startsWith(expected))
+        {
+            return true;
+        }
+    }
+
+    else if (status.toInt() == 200 && segment.position() == 0)
+    {
+        // Some servers and proxies announce ranges but send the whole file,
+        // that body is kept and the download goes on without segments
+        useWholeResponse(segment.reply);
+        return false;
+    }
+
+    // The server has ignored the range or the file has changed,
+    // the journal is of no use any more
+    qWarning() << "SegmentedDownload cannot use response" << status.toInt();
+    m_Error = QNetworkReply::UnknownContentError;
+    fail(false);
+    return false;
+}
+
+// Replaces the segments by a single one which reads the whole file from reply.
+// The other requests are aborted and the bytes they wrote are dropped.
+void SegmentedDownload::useWholeResponse(QNetworkReply* reply)
+{
+    qWarning() << "SegmentedDownload got the whole file for a range, continuing without segments";
+
+    QList<QNetworkReply*> otherReplies;
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        if (m_Segments[i].reply != NULL && m_Segments[i].reply != reply)
+        {
+            otherReplies.append(m_Segments[i].reply);
+        }
+    }
+
+    bool sizeOk = false;
+    const qint64 size = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong(&sizeOk);
+    planUnsegmented(sizeOk ? size : -1);
+
+    Segment& segment = m_Segments.first();
+    segment.reply = reply;
+    segment.checked = true;
+    m_BytesReceived = 0;
+
+    // The replies are no longer in the list, so their finished() is ignored
+    for (int i = 0; i < otherReplies.size(); ++i)
+    {
+        otherReplies[i]->abort();
+    }
+
+    readSegment(segment);
+}
+
+void SegmentedDownload::readSegment(Segment& segment)
+{
+    if (!acceptResponse(segment))
+    {
+        return;
+    }
+
+    QNetworkReply* reply = segment.reply;
+    while (reply->bytesAvailable() > 0)
+    {
+        QByteArray chunk = reply->read(CHUNK_SIZE);
+        if (segment.end >= 0 && segment.position() + chunk.size() > segment.end + 1)
+        {
+            chunk.truncate(segment.end + 1 - segment.position());
+        }
+        if (chunk.isEmpty())
+        {
+            break;
+        }
+
+        if (!m_PartFile.seek(segment.position()) || m_PartFile.write(chunk) != chunk.size())
+        {
+            qWarning() << "SegmentedDownload could not write" << m_PartFile.fileName();
+            m_Error = QNetworkReply::UnknownContentError;
+            fail(true);
+            return;
+        }
+
+        segment.done += chunk.size();
+        m_BytesReceived += chunk.size();
+        m_SessionBytes += chunk.size();
+        m_UnsavedBytes += chunk.size();
+    }
+
+    if (m_UnsavedBytes >= JOURNAL_INTERVAL)
+    {
+        saveJournal();
+    }
+
+    parseWrittenData();
+
+    emit downloadProgress(m_BytesReceived, m_Size);
+}
+
+int SegmentedDownload::indexOf(QNetworkReply* reply) const
+{
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        if (m_Segments[i].reply == reply)
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool SegmentedDownload::isComplete() const
+{
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        if (!m_Segments[i].complete())
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Feeds the parser with the data written since the last call, up to
+// the first byte which is still missing
+void SegmentedDownload::parseWrittenData()
+{
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        const Segment& segment = m_Segments[i];
+        if (m_ParsedOffset < segment.position() && m_PartFile.seek(m_ParsedOffset))
+        {
+            while (m_ParsedOffset < segment.position())
+            {
+                const QByteArray data = m_PartFile.read(
+                        qMin(CHUNK_SIZE, segment.position() - m_ParsedOffset));
+                if (data.isEmpty())
+                {
+                    break;
+                }
+                m_ParsedOffset += data.size();
+                m_XmlReader.addData(data);
+                readRecords();
+            }
+        }
+
+        if (!segment.complete())
+        {
+            break;
+        }
+    }
+}
+
+// Reads every record which is complete so far. The reader stops with
+// PrematureEndOfDocumentError at the end of the data added.
+void SegmentedDownload::readRecords()
+{
+    if (m_XmlReader.hasError()
+            && m_XmlReader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+    {
+        return;
+    }
+
+    while (!m_XmlReader.atEnd())
+    {
+        if (m_XmlReader.readNext() != QXmlStreamReader::StartElement)
+        {
+            continue;
+        }
+
+        const QString title = m_XmlReader.attributes().value("title").toString();
+        if (m_XmlReader.name() == "header")
+        {
+            emit headerRead(title);
+        }
+        else if (m_XmlReader.name() == "contacts")
+        {
+            emit contactRead(title);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (m_FirstRecordTime < 0)
+        {
+            m_FirstRecordTime = m_Timer.elapsed();
+        }
+    }
+
+    if (m_XmlReader.hasError()
+            && m_XmlReader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+    {
+        // The file is still saved, only the list stops growing
+        qWarning() << "SegmentedDownload could not parse the list:" << m_XmlReader.errorString();
+    }
+}
+
+void SegmentedDownload::complete()
+{
+    m_Running = false;
+    m_PartFile.close();
+
+    // Only replace the old file once the new one is complete. The POSIX rename
+    // replaces it in one step, so there is always either the old or the new file.
+    if (::rename(QFile::encodeName(m_PartFile.fileName()).constData(),
+            QFile::encodeName(m_FilePath).constData()) != 0)
+    {
+        qWarning() << "SegmentedDownload could not rename" << m_PartFile.fileName() << strerror(errno);
+        // The journal is kept so the next start() only retries the rename
+        m_Error = QNetworkReply::UnknownContentError;
+        fail(true);
+        return;
+    }
+    QFile::remove(m_JournalPath);
+
+    qDebug() << "SegmentedDownload received" << m_SessionBytes << "bytes in" << m_Segments.size()
+            << "segments in" << m_Timer.elapsed() << "ms," << throughput() << "bytes/s, first record after"
+            << m_FirstRecordTime << "ms";
+
+    m_Segments.clear();
+    emit finished(true);
+}
+
+void SegmentedDownload::fail(bool keepJournal)
+{
+    m_Running = false;
+
+    // Replies are detached first, abort() emits finished() right away
+    for (int i = 0; i < m_Segments.size(); ++i)
+    {
+        QNetworkReply* reply = m_Segments[i].reply;
+        m_Segments[i].reply = NULL;
+        if (reply != NULL)
+        {
+            reply->abort();
+        }
+    }
+
+    if (keepJournal)
+    {
+        saveJournal();
+    }
+    else
+    {
+        QFile::remove(m_JournalPath);
+    }
+    m_PartFile.close();
+
+    qDebug() << "SegmentedDownload stopped after" << m_BytesReceived << "of" << m_Size << "bytes:"
+            << m_Error;
+    emit finished(false);
+}
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2011-2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND,
+ * either express or implied.
+ * See the License for the specific language governing permissions
+ * and limitations under the License.
+ */
+
+#ifndef SEGMENTEDDOWNLOAD_HPP_
+#define SEGMENTEDDOWNLOAD_HPP_
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QNetworkReply>
+#include <QObject>
+#include <QUrl>
+#include <QXmlStreamReader>
+
+class QNetworkAccessManager;
+
+// Downloads the contacts list straight to disk. A file large enough
+// is split into segments which are fetched at the same time with HTTP
+// Range requests and written to their place in a pre-allocated ".part"
+// file. The progress of every segment is kept in a journal next to the
+// file, so a later start() only asks for the bytes still missing, even
+// after the app was closed.
+//
+// The data is also fed to an incremental XML parser as soon as all the
+// bytes before it are on disk, so the list can show records before the
+// download has finished and the whole body is never held in memory.
+class SegmentedDownload : public QObject
+{
+    Q_OBJECT
+
+    public:
+        // The number of segments a large file is split into
+        static const int DefaultSegmentCount = 4;
+
+        SegmentedDownload ( QNetworkAccessManager *manager, const QString& filePath,
+                QObject *parent = 0 );
+        virtual ~SegmentedDownload () {}
+
+        // Starts or resumes the download. Returns false if the
+        // file could not be opened for writing.
+        bool start ( const QUrl& url );
+
+        void setSegmentCount ( int count );
+        int segmentCount () const;
+
+        // The error of the last failed request
+        QNetworkReply::NetworkError error () const;
+
+        // The headers the server sent for the file
+        QList<QNetworkReply::RawHeaderPair> rawHeaderPairs () const;
+
+        // The bytes per second received since start()
+        qint64 throughput () const;
+
+    signals:
+        // Emitted when the records are read from the first byte, so
+        // records from an earlier attempt must be discarded
+        void restarted ();
+        void headerRead ( const QString& title );
+        void contactRead ( const QString& title );
+        // The bytes of all segments, including earlier attempts
+        void downloadProgress ( qint64 bytesReceived, qint64 bytesTotal );
+        void finished ( bool success );
+
+    private slots:
+        void onHeadFinished ();
+        void onSegmentReadyRead ();
+        void onSegmentFinished ();
+
+    private:
+        struct Segment
+        {
+            qint64 start;
+            // The last byte, or -1 if the size is not known
+            qint64 end;
+            qint64 done;
+            QNetworkReply* reply;
+            bool checked;
+
+            qint64 position () const { return start + done; }
+            bool complete () const { return end >= 0 && start + done > end; }
+        };
+
+        bool loadJournal ( qint64 size, const QByteArray& validator );
+        void saveJournal ();
+        void planSegments ( qint64 size, const QByteArray& validator );
+        void planUnsegmented ( qint64 size );
+        void requestSegment ( Segment& segment );
+        bool acceptResponse ( Segment& segment );
+        void useWholeResponse ( QNetworkReply* reply );
+        void readSegment ( Segment& segment );
+        int indexOf ( QNetworkReply* reply ) const;
+        bool isComplete () const;
+        void readRecords ();
+        void parseWrittenData ();
+        void complete ();
+        void fail ( bool keepJournal );
+
+        QNetworkAccessManager* m_pNetAccessMngr;
+        QNetworkReply* m_pHeadReply;
+        QFile m_PartFile;
+        QString m_FilePath;
+        QString m_JournalPath;
+        QUrl m_Url;
+        QByteArray m_Validator;
+        QList<Segment> m_Segments;
+        QList<QNetworkReply::RawHeaderPair> m_RawHeaders;
+        QXmlStreamReader m_XmlReader;
+        QElapsedTimer m_Timer;
+        QNetworkReply::NetworkError m_Error;
+        int m_SegmentCount;
+        qint64 m_Size;
+        qint64 m_BytesReceived;
+        qint64 m_SessionBytes;
+        qint64 m_UnsavedBytes;
+        qint64 m_ParsedOffset;
+        qint64 m_FirstRecordTime;
+        bool m_Running;
+};
+
+#endif /* SEGMENTEDDOWNLOAD_HPP_ */
@@ -15,13 +15,14 @@
  * and limitations under the License.
  */
 
+#include "ContactsDataModel.hpp"
 #include "RawHeaderView.hpp"
+#include "SegmentedDownload.hpp"
 #include "applicationui.hpp"
 
 #include <bb/cascades/Application>
 #include <bb/cascades/QmlDocument>
 #include <bb/cascades/AbstractPane>
-#include <bb/cascades/XmlDataModel>
 #include <bb/cascades/LocaleHandler>
 
 using namespace bb::cascades;
@@ -70,7 +71,6 @@ ApplicationUI::ApplicationUI(bb::cascades::Application *app) :
     // Initialize member variables
     m_pNetConfigMngr = new QNetworkConfigurationManager();
     m_pNetAccessMngr = new QNetworkAccessManager(this);
-    m_pNetReply = NULL;
     m_pCurrentDialog = NULL;
     m_pDwnldProgressToast = NULL;
     m_ConnectionRetries = 1;
@@ -78,16 +78,25 @@ ApplicationUI::ApplicationUI(bb::cascades::Application *app) :
     m_RetryFileOpenIsDisplayed = false;
     m_RetryConnIsDisplayed = false;
 
-    // Create a file in the device file system to save
-    // the data model
-    m_pFileObj = new QFile("data/contacts_list.xml");
+    // The contact list is saved to a file in the device file
+    // system while it downloads
+    m_pDownload = new SegmentedDownload(m_pNetAccessMngr, "data/contacts_list.xml", this);
 
     // Set created root object as the application scene
     app->setScene(root);
 
-    // Connect to the QNetworkAccessManager finished signal
-    res = QObject::connect(m_pNetAccessMngr, SIGNAL(finished(QNetworkReply*)), this,
-            SLOT(onRequestFinished()));
+    // Connect to the download signals
+    res = QObject::connect(m_pDownload, SIGNAL(finished(bool)), this,
+            SLOT(onRequestFinished(bool)));
+    Q_ASSERT(res);
+
+    res = QObject::connect(m_pDownload, SIGNAL(restarted()), this,
+            SLOT(onDownloadRestarted()));
+    Q_ASSERT(res);
+
+    // Show download progress
+    res = QObject::connect(m_pDownload, SIGNAL(downloadProgress(qint64, qint64)), this,
+            SLOT(onDownloadProgress(qint64, qint64)));
     Q_ASSERT(res);
 
     res = QObject::connect(m_pNetConfigMngr, SIGNAL(onlineStateChanged(bool)), this,
@@ -120,30 +129,28 @@ void ApplicationUI::waitForConnection()
     }
 }
 
-// This function creates a new network request and sends
-// it to the server, and monitors download progress
+// This function starts the download of the contact list, or
+// resumes it where an earlier attempt stopped
 void ApplicationUI::sendNewRequest()
 {
-    // Create the network request
-    QNetworkRequest request = QNetworkRequest();
-
     QString requestUrl = "http://developer.blackberry.com";
     requestUrl.append("/native/files/documentation");
     requestUrl.append("/cascades/images/contacts_list.xml");
-    request.setUrl(QUrl(requestUrl));
-
-    bool res;
-    Q_UNUSED(res);
 
     // Send the network request
-    m_pNetReply = m_pNetAccessMngr->get(request);
+    if (!m_pDownload->start(QUrl(requestUrl)))
+    {
+        // The progress toast must be canceled to
+        // keep it from displaying when this error
+        // has occurred
+        if (m_pDwnldProgressToast != NULL) m_pDwnldProgressToast->cancel();
 
-    if (m_pNetReply != NULL)
+        // Handle file access errors
+        displayFileOpenRetryDialog();
+    }
+    else
     {
-        // Show download progress
-        res = QObject::connect(m_pNetReply, SIGNAL(downloadProgress(qint64, qint64)), this,
-                SLOT(onDownloadProgress(qint64, qint64)));
-        Q_ASSERT(res);
+        m_FileOpenRetries = 1;
     }
 }
 
@@ -185,27 +192,23 @@ QString ApplicationUI::getErrorString(QNetworkReply::NetworkError networkError)
     return errStr;
 }
 
-void ApplicationUI::onRequestFinished()
+// The contact list has been filled while the file downloaded,
+// so only the status and raw headers are updated here
+void ApplicationUI::onRequestFinished(bool success)
 {
-    if (m_pNetReply != NULL && m_pNetReply->bytesAvailable() > 0
-            && m_pNetReply->error() == QNetworkReply::NoError)
+    if (success)
     {
         // Update the online status in the UI
         updateOnlineStatus(true);
 
         m_ConnectionRetries = 1;
 
-        // Update the contact list
-        openFile();
-
         // Update the raw headers dialog
-        QString rawHdrInfo = getRawHeaderInfo(m_pNetReply);
+        QString rawHdrInfo = getRawHeaderInfo(m_pDownload->rawHeaderPairs());
         m_pRawHeaderInfoTxa->setText(rawHdrInfo);
 
         // Enable the view raw header toggle
         m_pViewRawHdrTbn->setEnabled(true);
-
-        m_pNetReply->deleteLater();
     }
     else
     {
@@ -219,16 +222,14 @@ void ApplicationUI::onRequestFinished()
 
 // This function collects the raw headers and returns them as a
 // QString object
-QString ApplicationUI::getRawHeaderInfo(QNetworkReply* reply)
+QString ApplicationUI::getRawHeaderInfo(const QList<QNetworkReply::RawHeaderPair>& rawHeaderPairs)
 {
-    QList<QByteArray> rawHeaderList = reply->rawHeaderList();
     QString rawHdrs;
 
-    foreach(QByteArray hdrName, rawHeaderList){
-    QByteArray hdrValue = reply->rawHeader(hdrName);
-    rawHdrs += hdrName;
+    foreach(const QNetworkReply::RawHeaderPair& rawHeader, rawHeaderPairs){
+    rawHdrs += rawHeader.first;
     rawHdrs += " : ";
-    rawHdrs += hdrValue;
+    rawHdrs += rawHeader.second;
     rawHdrs += "\n";
 }
 
@@ -309,43 +310,27 @@ void ApplicationUI::refreshConnectionIcons(QNetworkConfiguration::BearerType bea
     m_pNetwrkConnIcon->setImageSource(onlineIcon);
 }
 
-// This function opens the file to store the contact list,
-// and also updates the ListView control
-void ApplicationUI::openFile()
+// This function gives the ListView control an empty data model
+// which grows as the records of the contact list are downloaded
+void ApplicationUI::onDownloadRestarted()
 {
-    if (m_pFileObj->open(QIODevice::ReadWrite))
-    {
-        // Write to the file using the m_pNetReply object
-        m_pFileObj->write(m_pNetReply->readAll());
-        m_pFileObj->flush();
-        m_pFileObj->close();
-
-        // Create a temporary data model file using the contents
-        // of a local XML file
-        XmlDataModel* pDataModel = new XmlDataModel();
-
-        // Set the file path to the downloaded contacts list .xml file
-        QUrl fileUrl = "file://" + QDir::homePath() + "/contacts_list.xml";
+    // The ListView control takes ownership of the data
+    // model and deletes the one it replaces
+    ContactsDataModel* pDataModel = new ContactsDataModel();
 
-        // Set the data model property for the ListView control with the
-        // path of the downloaded contacts_list.xml file
-        pDataModel->setSource(fileUrl);
+    bool res;
+    Q_UNUSED(res);
 
-        // Update the ListView control with the new data model
-        m_pListView->setDataModel(pDataModel);
+    res = QObject::connect(m_pDownload, SIGNAL(headerRead(const QString&)), pDataModel,
+            SLOT(appendHeader(const QString&)));
+    Q_ASSERT(res);
 
-        m_FileOpenRetries = 1;
-    }
-    else
-    {
-        // The progress toast must be canceled to
-        // keep it from displaying when this error
-        // has occurred
-        m_pDwnldProgressToast->cancel();
+    res = QObject::connect(m_pDownload, SIGNAL(contactRead(const QString&)), pDataModel,
+            SLOT(appendContact(const QString&)));
+    Q_ASSERT(res);
 
-        // Handle file access errors
-        displayFileOpenRetryDialog();
-    }
+    // Update the ListView control with the new data model
+    m_pListView->setDataModel(pDataModel);
 }
 
 void ApplicationUI::displayConnRetryDialog()
@@ -359,9 +344,9 @@ void ApplicationUI::displayConnRetryDialog()
 
     QString errMsg;
 
-    if (m_pNetReply != NULL)
+    if (m_pDownload->error() != QNetworkReply::NoError)
     {
-        errMsg = getErrorString(m_pNetReply->error());
+        errMsg = getErrorString(m_pDownload->error());
     }
     else
     {
@@ -448,8 +433,8 @@ void ApplicationUI::onFileOpenRetryDialogFinished(bb::system::SystemUiResult::Ty
     {
         m_FileOpenRetries += 1;
 
-        // Retry opening a file
-        openFile();
+        // Retry opening the file and downloading to it
+        sendNewRequest();
     }
     else
     {
@@ -477,8 +462,13 @@ void ApplicationUI::onDownloadProgress(qint64 bytesSent, qint64 bytesTotal)
         // Show download progress toast
         int currentProgress = (bytesSent * 100) / bytesTotal;
 
+        // The progress and throughput of all the segments
+        QString progressMsg = "Downloading file ... ";
+        progressMsg.append(QString::number(m_pDownload->throughput() / 1024));
+        progressMsg.append(" KB/s");
+
         SystemProgressToast* pProgToast = new SystemProgressToast();
-        pProgToast->setBody("Downloading file ...");
+        pProgToast->setBody(progressMsg);
         pProgToast->setProgress(currentProgress);
         pProgToast->setState(SystemUiProgressState::Active);
         pProgToast->setPosition(SystemUiPosition::MiddleCenter);
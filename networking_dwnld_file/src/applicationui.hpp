@@ -18,7 +18,6 @@
 #ifndef ApplicationUI_HPP_
 #define ApplicationUI_HPP_
 
-#include <QFile>
 #include <QObject>
 #include <QtNetwork>
 #include <QNetworkSession>
@@ -47,6 +46,7 @@ using namespace bb::system;
 
 class QTranslator;
 class RawHeaderView;
+class SegmentedDownload;
 
 class ApplicationUI : public QObject
 {
@@ -60,8 +60,8 @@ class ApplicationUI : public QObject
         // For localization
         void onSystemLanguageChanged ();
 
-        void openFile ();
-        void onRequestFinished();
+        void onDownloadRestarted ();
+        void onRequestFinished ( bool );
         void onOnlineStateChanged(bool);
         void onDownloadProgress ( qint64, qint64 );
         void onFileOpenRetryDialogFinished ( bb::system::SystemUiResult::Type );
@@ -81,8 +81,7 @@ class ApplicationUI : public QObject
 
         QNetworkConfigurationManager* m_pNetConfigMngr;
         QNetworkAccessManager* m_pNetAccessMngr;
-        QNetworkReply* m_pNetReply;
-        QFile* m_pFileObj;
+        SegmentedDownload* m_pDownload;
         SystemDialog* m_pCurrentDialog;
         SystemProgressToast* m_pDwnldProgressToast;
         int m_ConnectionRetries;
@@ -98,7 +97,7 @@ class ApplicationUI : public QObject
         void displayConnRetryDialog ();
         void waitForConnection();
         QString getErrorString(QNetworkReply::NetworkError);
-        QString getRawHeaderInfo(QNetworkReply*);
+        QString getRawHeaderInfo(const QList<QNetworkReply::RawHeaderPair>&);
 };
 
 #endif /* ApplicationUI_HPP_ */
@@ -17,11 +17,30 @@
 
 #include "Person.hpp"
 
+#include <QDebug>
+#include <QHash>
+#include <QVector>
+
+#include <cstdio>
+#include <unistd.h>
+
 using namespace bb::cascades;
 
 const QString FileStorage::m_personsFilePath = "./data/PersonList.dat";
 
+// "PLOG", the files of the first version start with the last customer id instead
+const quint32 FileStorage::m_fileMagic = 0x504c4f47;
+const quint32 FileStorage::m_fileVersion = 2;
+
+// The position of the person count in the header, followed by the index offset
+static const qint64 HeaderCountPosition = 12;
+
+// The file is compacted once the appended records outnumber the snapshot, but not below this
+static const int MinimumCompactionCount = 64;
+
 FileStorage::FileStorage()
+    : m_snapshotCount(0)
+    , m_logCount(0)
 {
 }
 
@@ -32,70 +51,278 @@ FileStorage::~FileStorage()
 // Clear the objects in our custom data file.
 bool FileStorage::clear()
 {
+    m_snapshotCount = 0;
+    m_logCount = 0;
+
     QFile peopleFile(m_personsFilePath);
     return peopleFile.remove();
 }
 //! [0]
+// Write a snapshot of the whole data model to a new file and
+// replace the old file with it.
 bool FileStorage::save(int lastID, GroupDataModel *model)
 {
-    QFile personFile(m_personsFilePath);
+    const QString tempFilePath = m_personsFilePath + ".tmp";
+    QFile personFile(tempFilePath);
 
-    if (!personFile.open(QIODevice::WriteOnly))
+    if (!personFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
         return false;
 
     QDataStream stream(&personFile); // Open a stream into the file.
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    // The person count and the index offset are filled in once the records are written.
+    stream << m_fileMagic << m_fileVersion << qint32(lastID) << quint32(0) << quint64(0);
+
+    const QList<QObject*> objects = model->toListOfObjects();
+    QVector<quint64> offsets;
+    offsets.reserve(objects.size());
+
+    for (int i = 0; i < objects.size(); i++) {
+        Person *person = qobject_cast<Person*>(objects.at(i));
+        if (person) {
+            offsets.append(personFile.pos());
+            personFile.write(encodeRecord(personRecord(PutRecord, lastID, person)));
+        }
+    }
+
+    // The index holds the offset of every person record, so a record can be found
+    // without reading the ones before it.
+    const quint64 indexOffset = personFile.pos();
+    for (int i = 0; i < offsets.size(); i++) {
+        stream << offsets.at(i);
+    }
 
-    const bool saved = serializeDataModel(lastID, model, &stream); // Put the data model into the stream.
+    personFile.seek(HeaderCountPosition);
+    stream << quint32(offsets.size()) << indexOffset;
+
+    // Make sure the data is on the disk before the file replaces the old one.
+    const bool saved = stream.status() == QDataStream::Ok && personFile.flush()
+            && fsync(personFile.handle()) == 0;
 
     personFile.close();
 
-    return saved;
+    // rename() replaces the old file in one step, so after a crash
+    // there is either the old or the new file, never a partial one.
+    if (!saved || rename(QFile::encodeName(tempFilePath).constData(),
+                         QFile::encodeName(m_personsFilePath).constData()) != 0) {
+        QFile::remove(tempFilePath);
+        return false;
+    }
+
+    m_snapshotCount = offsets.size();
+    m_logCount = 0;
+
+    return true;
 }
 
-bool FileStorage::serializeDataModel(int lastID, GroupDataModel* model, QDataStream* stream)
+bool FileStorage::addPerson(int lastID, Person *person, GroupDataModel *model)
 {
-    // This is a simple serialization function.
-    // For more info on dealing with complex types,
-    // or incorporating file versions see "Serializing data type in Qt"
-    // http://qt-project.org/doc/qt-4.8/datastreamformat.html
-    bool addedData = false;
+    return appendRecord(personRecord(PutRecord, lastID, person), model);
+}
 
-    *stream << lastID;
-    if (stream->status() == QDataStream::Ok) {
-        for (int i = 0; i < model->size(); i++) {
-            Person *person = (Person *) model->children()[i];
-            *stream << person->customerID() << person->firstName()
-                    << person->lastName();
-            if (stream->status() != QDataStream::Ok) {
-                return addedData = false;
-            }
-        }
-        addedData = true;
-    }
+bool FileStorage::updatePerson(int lastID, Person *person, GroupDataModel *model)
+{
+    return appendRecord(personRecord(PutRecord, lastID, person), model);
+}
+
+bool FileStorage::removePerson(int lastID, const QString &id, GroupDataModel *model)
+{
+    PersonRecord record;
+    record.type = RemoveRecord;
+    record.lastID = lastID;
+    record.id = id;
+
+    return appendRecord(record, model);
+}
+
+// Append a single change to the end of the file instead of rewriting it.
+bool FileStorage::appendRecord(const PersonRecord &record, GroupDataModel *model)
+{
+    // Without a snapshot there is nothing to append to.
+    if (!QFile::exists(m_personsFilePath))
+        return save(record.lastID, model);
+
+    QFile personFile(m_personsFilePath);
+    if (!personFile.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+
+    const qint64 size = personFile.size();
+    const QByteArray data = encodeRecord(record);
+    const bool appended = personFile.write(data) == data.size() && personFile.flush();
+
+    // Drop a partly written record, so later records are not appended behind it.
+    if (!appended)
+        personFile.resize(size);
+
+    personFile.close();
 
-    return addedData;
+    if (!appended)
+        return false;
+
+    m_logCount++;
+
+    // Compact the file once the changes outnumber the persons in the snapshot.
+    if (m_logCount > qMax(MinimumCompactionCount, m_snapshotCount))
+        return save(record.lastID, model);
+
+    return true;
+}
+
+// A record is its fields serialized into a byte array, stored with the
+// length of the array in front so an incomplete record can be detected.
+QByteArray FileStorage::encodeRecord(const PersonRecord &record)
+{
+    QByteArray fields;
+    QDataStream fieldStream(&fields, QIODevice::WriteOnly);
+    fieldStream.setVersion(QDataStream::Qt_4_8);
+    fieldStream << record.type << record.lastID << record.id << record.firstName << record.lastName;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_4_8);
+    stream << fields;
+
+    return data;
+}
+
+bool FileStorage::readRecord(QDataStream *stream, PersonRecord *record)
+{
+    quint32 length;
+    *stream >> length;
+
+    if (stream->status() != QDataStream::Ok || stream->device()->bytesAvailable() < length)
+        return false;
+
+    const qint64 end = stream->device()->pos() + length;
+    *stream >> record->type >> record->lastID >> record->id >> record->firstName >> record->lastName;
+
+    return stream->status() == QDataStream::Ok && stream->device()->pos() == end;
+}
+
+FileStorage::PersonRecord FileStorage::personRecord(RecordType type, int lastID, Person *person)
+{
+    PersonRecord record;
+    record.type = type;
+    record.lastID = lastID;
+    record.id = person->customerID();
+    record.firstName = person->firstName();
+    record.lastName = person->lastName();
+
+    return record;
 }
 //! [0]
 //! [1]
 int FileStorage::load(int& lastID, GroupDataModel *model)
 {
-    // return the number of persons loaded.
-    int loadedCount = 0;
+    m_snapshotCount = 0;
+    m_logCount = 0;
 
-    // open the custom file for writing.
+    // open the custom file for reading.
     QFile file(m_personsFilePath);
     if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    // Map the file into memory and decode the records straight from it.
+    const qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : 0;
+    const QByteArray data = mapped ? QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size)
+                                   : file.readAll();
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_4_8);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+
+    if (magic != m_fileMagic) {
+        // A file of the first version, read it and convert it.
+        stream.device()->seek(0);
+        const int loadedCount = deserializeIntoDataModel(&stream, model, lastID);
+        if (mapped)
+            file.unmap(mapped);
+        file.close();
+
+        if (loadedCount > 0)
+            save(lastID, model);
+
         return loadedCount;
     }
 
-    // Load from the stream into the dataModel.
-    // The function deserializeIntoDataModel() will create the person instances
-    // and add them to the given dataModel
-    QDataStream stream(&file);
-    loadedCount = deserializeIntoDataModel(&stream, model, lastID);
+    if (version > m_fileVersion) {
+        qWarning() << "Unsupported person file version:" << version;
+        if (mapped)
+            file.unmap(mapped);
+        return 0;
+    }
+
+    qint32 fileLastID;
+    quint32 count;
+    quint64 indexOffset;
+    stream >> fileLastID >> count >> indexOffset;
+
+    // 1. Read the snapshot, keeping the position of each person by id.
+    QList<PersonRecord> persons;
+    QHash<QString, int> positions;
+    positions.reserve(count);
+
+    PersonRecord record;
+    for (quint32 i = 0; i < count && readRecord(&stream, &record); i++) {
+        positions.insert(record.id, persons.size());
+        persons.append(record);
+    }
+    m_snapshotCount = persons.size();
+
+    // 2. Apply the changes appended after the index.
+    stream.device()->seek(indexOffset + count * sizeof(quint64));
+    qint64 validSize = stream.device()->pos();
+
+    while (!stream.atEnd() && readRecord(&stream, &record)) {
+        validSize = stream.device()->pos();
+        fileLastID = record.lastID;
+        m_logCount++;
+
+        const QHash<QString, int>::iterator position = positions.find(record.id);
+        if (record.type == RemoveRecord) {
+            if (position != positions.end()) {
+                persons[position.value()].id.clear();
+                positions.erase(position);
+            }
+        } else if (position != positions.end()) {
+            persons[position.value()] = record;
+        } else {
+            positions.insert(record.id, persons.size());
+            persons.append(record);
+        }
+    }
+
+    if (mapped)
+        file.unmap(mapped);
     file.close();
 
-    return loadedCount;
+    // Drop a record that was only partly written when the app was stopped.
+    if (validSize < size) {
+        qWarning() << "Dropping" << (size - validSize) << "bytes of incomplete records";
+        QFile::resize(m_personsFilePath, validSize);
+    }
+
+    lastID = fileLastID;
+
+    // 3. Insert all persons into the data model at once, so it is sorted only once.
+    QList<QObject*> people;
+    people.reserve(persons.size());
+    for (int i = 0; i < persons.size(); i++) {
+        const PersonRecord &person = persons.at(i);
+        if (!person.id.isEmpty()) {
+            // Note the model will delete Person when the time comes.
+            people.append(new Person(person.id, person.firstName, person.lastName));
+        }
+    }
+    model->insertList(people);
+
+    return people.size();
 }
 
 int FileStorage::deserializeIntoDataModel(QDataStream *stream, GroupDataModel *model, int& lastID)
@@ -20,6 +20,11 @@
 
 using namespace bb::cascades;
 
+// The persons are stored as a record log. The file starts with a header
+// and a snapshot of all persons, followed by an offset index of the
+// snapshot records. Every later change is appended to the end of the
+// file as one more record, and once enough changes have piled up the
+// file is compacted into a new snapshot.
 class FileStorage: public Storage
 {
 public:
@@ -29,12 +34,45 @@ public:
     virtual int load(int& lastID, GroupDataModel *model);
     virtual bool save(int lastID, GroupDataModel *model);
 
+    virtual bool addPerson(int lastID, Person *person, GroupDataModel *model);
+    virtual bool updatePerson(int lastID, Person *person, GroupDataModel *model);
+    virtual bool removePerson(int lastID, const QString &id, GroupDataModel *model);
+
 private:
+    // The kind of change stored in a record.
+    enum RecordType
+    {
+        PutRecord = 1,   ///< a person was added or updated
+        RemoveRecord = 2 ///< a person was removed
+    };
+
+    // A person as stored in a record.
+    struct PersonRecord
+    {
+        quint8 type;
+        qint32 lastID;
+        QString id;
+        QString firstName;
+        QString lastName;
+    };
+
     static const QString m_personsFilePath;
-    bool serializeDataModel(int lastID, GroupDataModel* model, QDataStream* stream);
+    static const quint32 m_fileMagic;
+    static const quint32 m_fileVersion;
+
+    bool appendRecord(const PersonRecord &record, GroupDataModel *model);
+    static QByteArray encodeRecord(const PersonRecord &record);
+    static bool readRecord(QDataStream *stream, PersonRecord *record);
+    static PersonRecord personRecord(RecordType type, int lastID, Person *person);
+
+    // Reads the format of the first version, which had no header, so the file can be converted.
     int deserializeIntoDataModel(QDataStream *stream, GroupDataModel *model, int& lastID);
     bool loadPerson(QDataStream* stream, GroupDataModel *model);
     bool loadLastCustomerID(QDataStream* stream, int& id);
+
+    // The number of persons in the snapshot, and of the records appended after it.
+    int m_snapshotCount;
+    int m_logCount;
 };
 
 #endif
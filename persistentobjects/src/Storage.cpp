@@ -22,3 +22,21 @@ Storage::Storage()
 Storage::~Storage()
 {
 }
+
+bool Storage::addPerson(int lastID, Person *person, GroupDataModel *model)
+{
+    Q_UNUSED(person);
+    return save(lastID, model);
+}
+
+bool Storage::updatePerson(int lastID, Person *person, GroupDataModel *model)
+{
+    Q_UNUSED(person);
+    return save(lastID, model);
+}
+
+bool Storage::removePerson(int lastID, const QString &id, GroupDataModel *model)
+{
+    Q_UNUSED(id);
+    return save(lastID, model);
+}
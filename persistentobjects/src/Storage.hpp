@@ -20,6 +20,8 @@
 
 using namespace bb::cascades;
 
+class Person;
+
 //! [0]
 class Storage
 {
@@ -30,6 +32,13 @@ public:
     virtual bool clear() = 0;
     virtual int load(int& lastID, GroupDataModel *model) = 0;
     virtual bool save(int lastID, GroupDataModel *model) = 0;
+
+    // Store a single change which has already been applied to the model.
+    // By default the whole model is saved; a storage that can store
+    // the change on its own overrides these.
+    virtual bool addPerson(int lastID, Person *person, GroupDataModel *model);
+    virtual bool updatePerson(int lastID, Person *person, GroupDataModel *model);
+    virtual bool removePerson(int lastID, const QString &id, GroupDataModel *model);
 };
 //! [0]
 #endif
@@ -72,7 +72,7 @@ bool App::addObject(const QString &firstName, const QString &lastName)
 
     m_dataModel->insert(person);
 
-    added = m_storage->save(m_lastCustomerID, m_dataModel);
+    added = m_storage->addPerson(m_lastCustomerID, person, m_dataModel);
 
     return added;
 }
@@ -127,7 +127,7 @@ bool App::updateObject(const QString &id, const QString &firstName, const QStrin
 
     // Save the datamodel if we updated something.
     if (updated) {
-        saved = m_storage->save(m_lastCustomerID, m_dataModel);
+        saved = m_storage->updatePerson(m_lastCustomerID, person, m_dataModel);
     }
 
     return (updated && saved);
@@ -155,7 +155,7 @@ bool App::deleteObject(const QString &customerID)
     }
 
     if (deleted) {
-        saved = m_storage->save(m_lastCustomerID, m_dataModel);
+        saved = m_storage->removePerson(m_lastCustomerID, customerID, m_dataModel);
     }
 
     return (deleted && saved);
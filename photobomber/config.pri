@@ -3,26 +3,38 @@ BASEDIR =  $$quote($$_PRO_FILE_PWD_)
 
 device {
     CONFIG(debug, debug|release) {
-        SOURCES +=  $$quote($$BASEDIR/src/main.cpp) \
+        SOURCES +=  $$quote($$BASEDIR/src/imageeffects.cpp) \
+                 $$quote($$BASEDIR/src/imagepipeline.cpp) \
+                 $$quote($$BASEDIR/src/main.cpp) \
                  $$quote($$BASEDIR/src/photobomberapp.cpp)
 
-        HEADERS +=  $$quote($$BASEDIR/src/photobomberapp.h)
+        HEADERS +=  $$quote($$BASEDIR/src/imageeffects.h) \
+                 $$quote($$BASEDIR/src/imagepipeline.h) \
+                 $$quote($$BASEDIR/src/photobomberapp.h)
     }
 
     CONFIG(release, debug|release) {
-        SOURCES +=  $$quote($$BASEDIR/src/main.cpp) \
+        SOURCES +=  $$quote($$BASEDIR/src/imageeffects.cpp) \
+                 $$quote($$BASEDIR/src/imagepipeline.cpp) \
+                 $$quote($$BASEDIR/src/main.cpp) \
                  $$quote($$BASEDIR/src/photobomberapp.cpp)
 
-        HEADERS +=  $$quote($$BASEDIR/src/photobomberapp.h)
+        HEADERS +=  $$quote($$BASEDIR/src/imageeffects.h) \
+                 $$quote($$BASEDIR/src/imagepipeline.h) \
+                 $$quote($$BASEDIR/src/photobomberapp.h)
     }
 }
 
 simulator {
     CONFIG(debug, debug|release) {
-        SOURCES +=  $$quote($$BASEDIR/src/main.cpp) \
+        SOURCES +=  $$quote($$BASEDIR/src/imageeffects.cpp) \
+                 $$quote($$BASEDIR/src/imagepipeline.cpp) \
+                 $$quote($$BASEDIR/src/main.cpp) \
                  $$quote($$BASEDIR/src/photobomberapp.cpp)
 
-        HEADERS +=  $$quote($$BASEDIR/src/photobomberapp.h)
+        HEADERS +=  $$quote($$BASEDIR/src/imageeffects.h) \
+                 $$quote($$BASEDIR/src/imagepipeline.h) \
+                 $$quote($$BASEDIR/src/photobomberapp.h)
     }
 }
 
@@ -0,0 +1,211 @@
+/* Copyright (c) 2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "imageeffects.h"
+
+#include <QtCore/QRect>
+#include <QtCore/QVector>
+#include <QtCore/QtConcurrentMap>
+
+#if defined(__ARM_NEON__)
+#include <arm_neon.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+// The number of rows processed as one piece of work by a thread.
+static const int BAND_HEIGHT = 64;
+
+// The luminance weights (ITU-R BT.601) scaled by 256, they add up to 256.
+static const int RED_WEIGHT = 77;
+static const int GREEN_WEIGHT = 150;
+static const int BLUE_WEIGHT = 29;
+
+// A band of rows of the image, and the part of the overlay that falls into it.
+struct ImageBand
+{
+    uchar *bits;
+    int bytesPerLine;
+    int width;
+    int firstRow;
+    int lastRow;
+
+    const QImage *overlay;
+    QRect overlayRect;
+    QPoint overlayPosition;
+};
+
+static void processBand(ImageBand &band)
+{
+    for (int y = band.firstRow; y <= band.lastRow; y++) {
+        QRgb *row = reinterpret_cast<QRgb*>(band.bits + y * band.bytesPerLine);
+        ImageEffects::grayscaleRow(row, band.width);
+
+        // Blend the overlay while the row is still in the cache.
+        if (band.overlay && y >= band.overlayRect.top() && y <= band.overlayRect.bottom()) {
+            const QRgb *overlayRow = reinterpret_cast<const QRgb*>(
+                    band.overlay->constScanLine(y - band.overlayPosition.y()));
+            ImageEffects::overlayRow(row + band.overlayRect.left(),
+                    overlayRow + band.overlayRect.left() - band.overlayPosition.x(),
+                    band.overlayRect.width());
+        }
+    }
+}
+
+void ImageEffects::grayscale(QImage *image)
+{
+    grayscaleAndOverlay(image, QImage(), QPoint());
+}
+
+void ImageEffects::grayscaleAndOverlay(QImage *image, const QImage &overlay, const QPoint &position)
+{
+    if (image->isNull()) {
+        return;
+    }
+
+    // The kernels work on 32 bit pixels, a camera photo is already in this format.
+    if (image->format() != QImage::Format_RGB32 && image->format() != QImage::Format_ARGB32
+            && image->format() != QImage::Format_ARGB32_Premultiplied) {
+        *image = image->convertToFormat(
+                image->hasAlphaChannel() ? QImage::Format_ARGB32 : QImage::Format_RGB32);
+    }
+
+    // The blending needs premultiplied overlay pixels.
+    const QImage premultiplied = overlay.isNull() ? QImage()
+            : overlay.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const QRect overlayRect = QRect(position, overlay.size()) & image->rect();
+
+    // Get the pixel memory here, bits() must not be called from the threads since it may detach.
+    uchar *bits = image->bits();
+    const int bytesPerLine = image->bytesPerLine();
+
+    QVector<ImageBand> bands;
+    bands.reserve(image->height() / BAND_HEIGHT + 1);
+    for (int firstRow = 0; firstRow < image->height(); firstRow += BAND_HEIGHT) {
+        ImageBand band;
+        band.bits = bits;
+        band.bytesPerLine = bytesPerLine;
+        band.width = image->width();
+        band.firstRow = firstRow;
+        band.lastRow = qMin(firstRow + BAND_HEIGHT, image->height()) - 1;
+        band.overlay = overlayRect.isEmpty() ? 0 : &premultiplied;
+        band.overlayRect = overlayRect;
+        band.overlayPosition = position;
+        bands.append(band);
+    }
+
+    QtConcurrent::blockingMap(bands, processBand);
+}
+
+void ImageEffects::grayscaleRowReference(QRgb *row, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const QRgb pixel = row[i];
+        const uint gray = (qRed(pixel) * RED_WEIGHT + qGreen(pixel) * GREEN_WEIGHT
+                + qBlue(pixel) * BLUE_WEIGHT + 128) >> 8;
+        row[i] = (pixel & 0xff000000) | (gray << 16) | (gray << 8) | gray;
+    }
+}
+
+#if defined(__ARM_NEON__)
+// Converts 8 pixels at a time. vld4 splits the bytes of the pixels into blue, green,
+// red and alpha lanes (the pixels are stored as BGRA in little endian memory).
+void ImageEffects::grayscaleRow(QRgb *row, int count)
+{
+    uint8_t *pixels = reinterpret_cast<uint8_t*>(row);
+    const uint8x8_t redWeight = vdup_n_u8(RED_WEIGHT);
+    const uint8x8_t greenWeight = vdup_n_u8(GREEN_WEIGHT);
+    const uint8x8_t blueWeight = vdup_n_u8(BLUE_WEIGHT);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8, pixels += 32) {
+        uint8x8x4_t bgra = vld4_u8(pixels);
+        uint16x8_t sum = vmull_u8(bgra.val[2], redWeight);
+        sum = vmlal_u8(sum, bgra.val[1], greenWeight);
+        sum = vmlal_u8(sum, bgra.val[0], blueWeight);
+        // rounding shift, the same as adding 128 before shifting
+        const uint8x8_t gray = vrshrn_n_u16(sum, 8);
+        bgra.val[0] = gray;
+        bgra.val[1] = gray;
+        bgra.val[2] = gray;
+        vst4_u8(pixels, bgra);
+    }
+    grayscaleRowReference(row + i, count - i);
+}
+#elif defined(__SSE2__)
+// Converts 4 pixels at a time, with each pixel in a 32 bit lane. The channels and
+// the weights fit in the low 16 bits of the lane, so a 16 bit multiply is enough.
+void ImageEffects::grayscaleRow(QRgb *row, int count)
+{
+    const __m128i channelMask = _mm_set1_epi32(0xff);
+    const __m128i alphaMask = _mm_set1_epi32(0xff000000);
+    const __m128i redWeight = _mm_set1_epi32(RED_WEIGHT);
+    const __m128i greenWeight = _mm_set1_epi32(GREEN_WEIGHT);
+    const __m128i blueWeight = _mm_set1_epi32(BLUE_WEIGHT);
+    const __m128i rounding = _mm_set1_epi32(128);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128i *pixels = reinterpret_cast<__m128i*>(row + i);
+        const __m128i pixel = _mm_loadu_si128(pixels);
+        const __m128i red = _mm_and_si128(_mm_srli_epi32(pixel, 16), channelMask);
+        const __m128i green = _mm_and_si128(_mm_srli_epi32(pixel, 8), channelMask);
+        const __m128i blue = _mm_and_si128(pixel, channelMask);
+
+        __m128i sum = _mm_add_epi32(_mm_mullo_epi16(red, redWeight), _mm_mullo_epi16(green, greenWeight));
+        sum = _mm_add_epi32(sum, _mm_mullo_epi16(blue, blueWeight));
+        const __m128i gray = _mm_srli_epi32(_mm_add_epi32(sum, rounding), 8);
+
+        __m128i result = _mm_and_si128(pixel, alphaMask);
+        result = _mm_or_si128(result, gray);
+        result = _mm_or_si128(result, _mm_slli_epi32(gray, 8));
+        result = _mm_or_si128(result, _mm_slli_epi32(gray, 16));
+        _mm_storeu_si128(pixels, result);
+    }
+    grayscaleRowReference(row + i, count - i);
+}
+#else
+void ImageEffects::grayscaleRow(QRgb *row, int count)
+{
+    grayscaleRowReference(row, count);
+}
+#endif
+
+// Multiplies the four channels of the pixel by alpha / 255, two channels at a time.
+static inline QRgb multiplyChannels(QRgb pixel, uint alpha)
+{
+    uint redBlue = (pixel & 0xff00ff) * alpha;
+    redBlue = (redBlue + ((redBlue >> 8) & 0xff00ff) + 0x800080) >> 8;
+    redBlue &= 0xff00ff;
+
+    uint alphaGreen = ((pixel >> 8) & 0xff00ff) * alpha;
+    alphaGreen = alphaGreen + ((alphaGreen >> 8) & 0xff00ff) + 0x800080;
+    alphaGreen &= 0xff00ff00;
+
+    return alphaGreen | redBlue;
+}
+
+void ImageEffects::overlayRow(QRgb *row, const QRgb *overlay, int count)
+{
+    for (int i = 0; i < count; i++) {
+        const QRgb source = overlay[i];
+        const uint alpha = qAlpha(source);
+        if (alpha == 255) {
+            row[i] = source;
+        } else if (alpha != 0) {
+            row[i] = source + multiplyChannels(row[i], 255 - alpha);
+        }
+    }
+}
@@ -0,0 +1,73 @@
+/* Copyright (c) 2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __IMAGEEFFECTS_H__
+#define __IMAGEEFFECTS_H__
+
+#include <QtCore/QPoint>
+#include <QtGui/QImage>
+
+/**
+ * ImageEffects Description:
+ *
+ * The effects used for bombing a photo: the photo is turned into gray scale and the
+ * bomber image is blended on top of it.
+ *
+ * The pixels are processed row by row, directly in the image memory. The image is
+ * split into bands of rows that are processed in parallel on all cores, and each
+ * band is finished (gray scale and bomber) before the next one is started, so the
+ * rows only pass through the cache once.
+ *
+ * The gray scale conversion has a NEON kernel for the device and an SSE2 kernel for
+ * the simulator. Both give exactly the same result as the plain C++ reference code.
+ */
+class ImageEffects
+{
+public:
+    /**
+     * Converts the image to gray scale, the alpha channel is kept.
+     *
+     * @param image the image to convert, it is changed to a 32 bit format if needed.
+     */
+    static void grayscale(QImage *image);
+
+    /**
+     * Converts the image to gray scale and draws the overlay on top of it.
+     * The image is expected to be opaque, like a camera photo.
+     *
+     * @param image the image to convert, it is changed to a 32 bit format if needed.
+     * @param overlay the image to draw on top, its alpha channel is used for blending.
+     * @param position the position of the overlay's top left corner in the image.
+     */
+    static void grayscaleAndOverlay(QImage *image, const QImage &overlay, const QPoint &position);
+
+    /**
+     * Converts count 32 bit pixels to gray scale luminance in place,
+     * with the fastest kernel available on the CPU.
+     */
+    static void grayscaleRow(QRgb *row, int count);
+
+    /**
+     * The plain C++ version of grayscaleRow(), which the vectorized kernels have to match.
+     */
+    static void grayscaleRowReference(QRgb *row, int count);
+
+    /**
+     * Blends count premultiplied overlay pixels on top of the row pixels (source over).
+     */
+    static void overlayRow(QRgb *row, const QRgb *overlay, int count);
+};
+
+#endif // ifndef __IMAGEEFFECTS_H__
@@ -0,0 +1,135 @@
+/* Copyright (c) 2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "imagepipeline.h"
+
+#include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtGui/QImageIOHandler>
+#include <QtGui/QTransform>
+
+#include <libexif/exif-data.h>
+
+ImagePipeline::ImagePipeline(const QString &filePath) :
+        m_reader(filePath), m_exifOrientation(1)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    // Only the image header is read to get the size.
+    m_size = m_reader.size();
+
+    // Since the image will loose its exif data when its opened in a QImage
+    // the orientation has to be read from the file.
+    ExifData *exifData = exif_data_new_from_file(QFile::encodeName(filePath).constData());
+
+    // Locate the orientation exif information.
+    if (exifData != NULL) {
+        for (int i = 0; i < EXIF_IFD_COUNT; i++) {
+            ExifEntry *exifEntry = exif_content_get_entry(exifData->ifd[i], EXIF_TAG_ORIENTATION);
+
+            // If the entry corresponds to the orientation it will be a non zero pointer.
+            if (exifEntry) {
+                m_exifOrientation = exif_get_short(exifEntry->data, exif_data_get_byte_order(exifData));
+                break;
+            }
+        }
+        exif_data_unref(exifData);
+    }
+
+    qDebug() << "ImagePipeline: header" << m_size << "exif orientation" << m_exifOrientation
+            << "in" << timer.elapsed() << "ms";
+}
+
+QSize ImagePipeline::size() const
+{
+    return m_size;
+}
+
+int ImagePipeline::exifOrientation() const
+{
+    return m_exifOrientation;
+}
+
+int ImagePipeline::rotationForOrientation(int exifOrientation)
+{
+    switch (exifOrientation) {
+        case 3:
+            return 180;
+        case 6:
+            return 90;
+        case 8:
+            return 270;
+        default:
+            // 1 is upright, the other orientations are mirrored orientations, do nothing.
+            return 0;
+    }
+}
+
+QImage ImagePipeline::read(int rotation, int height)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    rotation = ((rotation % 360) + 360) % 360;
+
+    QSize targetSize = m_size;
+    if (height > 0 && m_size.isValid()) {
+        targetSize = QSize(qMax(1, qRound(qreal(m_size.width()) * height / m_size.height())), height);
+    }
+
+    // A JPEG can be scaled down while it is decoded, which is much faster and
+    // does not need the memory for the full size image.
+    if (targetSize != m_size && m_reader.supportsOption(QImageIOHandler::ScaledSize)) {
+        m_reader.setScaledSize(targetSize);
+    }
+
+    QImage decoded;
+    if (!m_reader.read(&decoded)) {
+        m_errorString = m_reader.errorString();
+        qWarning() << "ImagePipeline: Failed to read image" << m_reader.fileName() << m_errorString;
+        return QImage();
+    }
+
+    qDebug() << "ImagePipeline: decode" << decoded.size() << decoded.byteCount() << "bytes in"
+            << timer.restart() << "ms";
+
+    if (decoded.size() == targetSize && rotation == 0) {
+        return decoded;
+    }
+
+    // The scaling that is left and the rotation are done by one transform, so the
+    // final image is written in a single pass. A plain rotation by a multiple of
+    // 90 degrees is a fast pixel copy in QImage.
+    QTransform transform;
+    if (decoded.size() != targetSize) {
+        transform.scale(qreal(targetSize.width()) / decoded.width(),
+                qreal(targetSize.height()) / decoded.height());
+    }
+    transform = transform * QTransform().rotate(rotation);
+
+    const QImage image = decoded.transformed(transform, Qt::SmoothTransformation);
+
+    qDebug() << "ImagePipeline: transform" << image.size() << "peak" << decoded.byteCount() + image.byteCount()
+            << "bytes in" << timer.elapsed() << "ms";
+
+    return image;
+}
+
+QString ImagePipeline::errorString() const
+{
+    return m_errorString;
+}
@@ -14,6 +14,8 @@
  */
 
 #include "photobomberapp.h"
+#include "imageeffects.h"
+#include "imagepipeline.h"
 
 #include <QtGui/QImage>
 #include <QtGui/QImageReader>
@@ -29,8 +31,6 @@
 
 #include <bb/device/DisplayInfo>
 
-#include <libexif/exif-data.h>
-
 using namespace bb::cascades;
 using namespace bb::cascades::multimedia;
 using namespace bb::system;
@@ -130,20 +130,6 @@ void PhotoBomberApp::manipulatePhoto(const QString &fileName)
     reader.setFileName(fileName);
     QImage image = getRotateImage(fileName); //reader.read();
     QSize imageSize = image.size();
-    QColor color;
-
-    // Gray it out! (this is not the gray-scale algorithm that should be used)
-    for (int i = 0; i < imageSize.width(); i++)
-        for (int ii = 0; ii < imageSize.height(); ii++) {
-            color = QColor(image.pixel(i, ii));
-            color.setRed((color.red() + color.green() + color.blue()) / 3);
-            color.setGreen(color.red());
-            color.setBlue(color.red());
-            image.setPixel(i, ii, color.rgb());
-        }
-
-    // Paint an image on top of another image, so we add the gray-scaled image first.
-    QPainter merger(&image);
 
     QString appFolder(QDir::homePath());
     appFolder.chop(4);
@@ -254,8 +240,8 @@ void PhotoBomberApp::manipulatePhoto(const QString &fileName)
         horizontal_pos = imageSize.height() - bomberImageSize.height();
     }
 
-    // Add the image and save the composition.
-    merger.drawImage(vertical_pos, horizontal_pos, bombimage);
+    // Gray it out and add the bomber image in the same pass, then save the composition.
+    ImageEffects::grayscaleAndOverlay(&image, bombimage, QPoint(vertical_pos, horizontal_pos));
     image.save(fileName, "JPG");
 
     // Show the photo by using this function that take use of the InvokeManager.
@@ -264,62 +250,11 @@ void PhotoBomberApp::manipulatePhoto(const QString &fileName)
 
 QImage PhotoBomberApp::getRotateImage(const QString imageFilePath)
 {
-    //Load the image using QImage.
-    QImage image = QImage(imageFilePath);
-
-    ExifData *exifData = 0;
-    ExifEntry *exifEntry = 0;
-    int exifOrientation = 1;
-
-    // Since the image will loose its exif data when its opened in a QImage
-    // it has to be manually rotated according to the exif orientation.
-    exifData = exif_data_new_from_file(imageFilePath.toLatin1().data());
-
-    // Locate the orientation exif information.
-    if (exifData != NULL) {
-        for (int i = 0; i < EXIF_IFD_COUNT; i++) {
-            exifEntry = exif_content_get_entry(exifData->ifd[i], EXIF_TAG_ORIENTATION);
-
-            // If the entry corresponds to the orientation it will be a non zero pointer.
-            if (exifEntry) {
-                exifOrientation = exif_get_short(exifEntry->data, exif_data_get_byte_order(exifData));
-                break;
-            }
-        }
-    }
-
-    // A transform will be used to rotate the image according to device and exif orientation.
-    QTransform transform;
-
-    qDebug() << "Exif data:" << exifOrientation;
-
-
-    // It's a bit tricky to get the correct orientation of the image. A combination of
-    // the way the the device is oriented and what the actual exif data says has to be used
-    // in order to rotate it in the correct way.
-    switch(exifOrientation) {
-        case 1:
-            // 0 degree rotation
-            break;
-        case 3:
-            // 180 degree rotation
-            transform.rotate(180);
-            break;
-        case 6:
-            // 90 degree rotation
-            transform.rotate(90);
-            break;
-        case 8:
-            // 270 degree rotation
-            transform.rotate(270);
-            break;
-        default:
-            // Other orientations are mirrored orientations, do nothing.
-            break;
-    }
+    // The pipeline reads the exif orientation once, before the image is decoded.
+    ImagePipeline pipeline(imageFilePath);
 
-    // Perform the rotation of the image before its saved.
-    image = image.transformed(transform);
+    qDebug() << "Exif data:" << pipeline.exifOrientation();
 
-    return image;
+    // Decode the image and rotate it according to the exif orientation.
+    return pipeline.read(ImagePipeline::rotationForOrientation(pipeline.exifOrientation()));
 }
@@ -1,6 +1,6 @@
 APP_NAME = pushCollector
 
 CONFIG += qt warn_on cascades10
-LIBS += -lbbnetwork
+LIBS += -lbbnetwork -lsqlite3
 
 include(config.pri)
@@ -108,6 +108,8 @@ App::App()
             this, SLOT(onNoPushServiceConnection()));
     QObject::connect(&m_pushNotificationService, SIGNAL(allPushesRemoved()),
             this, SLOT(onAllPushesRemoved()));
+    QObject::connect(&m_pushNotificationService, SIGNAL(pushesSaved(const QList<Push>&)),
+            this, SLOT(onPushesSaved(const QList<Push>&)));
 
     QmlDocument *qml = QmlDocument::create("asset:///main.qml");
     qml->setContextProperty("_pushAPIHandler", this);
@@ -509,6 +511,8 @@ void App::pushNotificationHandler(bb::network::PushPayload &pushPayload)
 
         // Exit the application if it has not been brought to the foreground
         if (!m_hasBeenInForeground) {
+            // Save the pushes which are still queued before exiting
+            m_pushNotificationService.saveQueuedPushes();
             Application::instance()->requestExit();
         }
 
@@ -518,42 +522,51 @@ void App::pushNotificationHandler(bb::network::PushPayload &pushPayload)
     // Convert from PushPayload to Push so that it can be stored in the database
     Push push(pushPayload);
 
-    // Save the push and set the sequence number (ID) of the push
-    push.setSeqNum(m_pushNotificationService.savePush(push));
+    // Queue the push, the pushes arriving close together are saved in one transaction
+    // and then handled in onPushesSaved()
+    // If an acknowledgement of the push is required (that is, the push was sent as a confirmed push
+    // - which is equivalent terminology to the push being sent with application level reliability),
+    // then you must either accept the push or reject the push
+    // In our sample, we always accept the push once it is saved, but situations might arise where an application
+    // might want to reject the push (for example, after looking at the headers that came with the push
+    // or the data of the push, we might decide that the push received did not match what we expected
+    // and so we might want to reject it)
+    m_pushNotificationService.queuePush(push, pushPayload.id(), pushPayload.isAckRequired());
+}
+
+void App::onPushesSaved(const QList<Push> &pushes)
+{
+    QVariantList items;
 
-    // Create a notification for the push that will be added to the BlackBerry Hub
-    Notification *notification = new Notification(NOTIFICATION_PREFIX + QString::number(push.seqNum()),this);
-    notification->setTitle("Push Collector");
-    notification->setBody(QString("New %0 push received").arg(push.fileExtension()));
+    for (int i = 0; i < pushes.size(); ++i) {
+        const Push &push = pushes.at(i);
 
-    // Add an invoke request to the notification
-    // This invoke will contain the seqnum of the push.
-    // When the notification in the BlackBerry Hub is selected, this seqnum will be used to lookup the push in
-    // the database and display it
-    InvokeRequest invokeRequest;
-    invokeRequest.setTarget(INVOKE_TARGET_KEY_OPEN);
-    invokeRequest.setAction(BB_OPEN_INVOCATION_ACTION);
-    invokeRequest.setMimeType("text/plain");
-    invokeRequest.setData(QByteArray::number(push.seqNum()));
-    notification->setInvokeRequest(invokeRequest);
+        // Create a notification for the push that will be added to the BlackBerry Hub
+        Notification *notification = new Notification(NOTIFICATION_PREFIX + QString::number(push.seqNum()),this);
+        notification->setTitle("Push Collector");
+        notification->setBody(QString("New %0 push received").arg(push.fileExtension()));
 
-    // Add the notification for the push to the BlackBerry Hub
-    // Calling this method will add a "splat" to the application icon, indicating that a new push has been received
-    notification->notify();
+        // Add an invoke request to the notification
+        // This invoke will contain the seqnum of the push.
+        // When the notification in the BlackBerry Hub is selected, this seqnum will be used to lookup the push in
+        // the database and display it
+        InvokeRequest invokeRequest;
+        invokeRequest.setTarget(INVOKE_TARGET_KEY_OPEN);
+        invokeRequest.setAction(BB_OPEN_INVOCATION_ACTION);
+        invokeRequest.setMimeType("text/plain");
+        invokeRequest.setData(QByteArray::number(push.seqNum()));
+        notification->setInvokeRequest(invokeRequest);
 
-    m_model->insert(push.toMap());
+        // Add the notification for the push to the BlackBerry Hub
+        // Calling this method will add a "splat" to the application icon, indicating that a new push has been received
+        notification->notify();
 
-    // If an acknowledgement of the push is required (that is, the push was sent as a confirmed push
-    // - which is equivalent terminology to the push being sent with application level reliability),
-    // then you must either accept the push or reject the push
-    if (pushPayload.isAckRequired()) {
-        // In our sample, we always accept the push, but situations might arise where an application
-        // might want to reject the push (for example, after looking at the headers that came with the push
-        // or the data of the push, we might decide that the push received did not match what we expected
-        // and so we might want to reject it)
-        m_pushNotificationService.acceptPush(pushPayload.id());
+        items.append(push.toListItemMap());
     }
 
+    // Insert all the saved pushes at once, so the list view is updated once for the whole batch
+    m_model->insertList(items);
+
     // If the "Launch Application on New Push" checkbox was checked in the config settings, then
     // a new push will launch the app so that it's running in the background (if the app was not
     // already running when the push came in)
@@ -616,22 +629,39 @@ void App::selectPush(const QVariantList &indexPath)
 {
     const QVariantMap item = m_model->data(indexPath).toMap();
     Push push(item);
+
+    // The list items only hold a preview, so load the content now that it is shown
+    push.setContent(m_pushNotificationService.pushContent(push.seqNum()));
+
     updatePushContent(push, indexPath);
 }
 
 void App::openPush(int pushSeqNum)
 {
     Push push = m_pushNotificationService.push(pushSeqNum);
-    QVariantList indexPath = m_model->findExact(push.toMap());
+    QVariantList indexPath = indexPathOf(pushSeqNum);
     updatePushContent(push, indexPath);
 }
 
+QVariantList App::indexPathOf(int pushSeqNum) const
+{
+    for (QVariantList indexPath = m_model->first(); !indexPath.isEmpty(); indexPath = m_model->after(indexPath)) {
+        if (m_model->data(indexPath).toMap().value("seqnum").toInt() == pushSeqNum) {
+            return indexPath;
+        }
+    }
+
+    return QVariantList();
+}
+
 void App::updatePushContent(Push &push, const QVariantList &indexPath)
 {
     push.setUnread(false);
     m_pushNotificationService.markPushAsRead(push.seqNum());
 
-    m_model->updateItem(indexPath, push.toMap());
+    if (!indexPath.isEmpty()) {
+        m_model->updateItem(indexPath, push.toListItemMap());
+    }
 
     // The push has been opened, so delete the notification
     Notification::deleteFromInbox(NOTIFICATION_PREFIX + QString::number(push.seqNum()));
@@ -124,6 +124,7 @@ public Q_SLOTS:
     void onNoPushServiceConnection();
     void onFullscreen();
     void onAllPushesRemoved();
+    void onPushesSaved(const QList<Push> &pushes);
 
 Q_SIGNALS:
     void modelIsEmptyChanged();
@@ -156,6 +157,9 @@ private:
     // a helper function which marks the push as read, and updates the displayed push content
     void updatePushContent(Push &push, const QVariantList &indexPath);
 
+    // a helper function which finds the list item of a push
+    QVariantList indexPathOf(int pushSeqNum) const;
+
     // The accessor methods of the properties
     bb::cascades::GroupDataModel* model() const;
     bool modelIsEmpty() const;
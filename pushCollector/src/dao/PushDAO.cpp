@@ -16,8 +16,13 @@
 
 #include "PushDAO.hpp"
 #include <QDebug>
+#include <sqlite3.h>
+
+// Pushes stored before version 1 have base64-encoded content, from version 1 on the content is stored raw
+#define PUSH_SCHEMA_VERSION 1
 
 PushDAO::PushDAO()
+    : m_tableReady(false)
 {
 }
 
@@ -27,6 +32,17 @@ PushDAO::~PushDAO()
 
 bool PushDAO::createPushTable()
 {
+    if (m_tableReady) {
+        return true;
+    }
+
+    const int version = schemaVersion();
+    if (version < 0) {
+        return false;
+    }
+
+    const bool tableExisted = SQLConnection().tables().contains("push");
+
     const QString query("CREATE TABLE IF NOT EXISTS push (seqnum INTEGER PRIMARY KEY AUTOINCREMENT, pushdate TEXT, type TEXT, pushtime TEXT, extension TEXT, content BLOB, unread INTEGER);");
 
     // Execute the query.
@@ -39,34 +55,165 @@ bool PushDAO::createPushTable()
         return false;
     }
 
+    if (version < PUSH_SCHEMA_VERSION) {
+        QSqlDatabase &connection = SQLConnection();
+
+        // The content and the schema version are updated in one transaction, so a crash
+        // never leaves decoded content marked as base64-encoded or the other way round
+        connection.transaction();
+
+        if (tableExisted && !migrateBase64Content()) {
+            connection.rollback();
+            return false;
+        }
+
+        const QString versionQuery = QString("PRAGMA user_version = %1;").arg(PUSH_SCHEMA_VERSION);
+        QSqlQuery versionSqlQuery(versionQuery, connection);
+
+        const QSqlError versionErr = versionSqlQuery.lastError();
+
+        if (versionErr.isValid()) {
+            qWarning() << "Error executing SQL statement: " << versionQuery << ". ERROR: " << versionErr.text();
+            connection.rollback();
+            return false;
+        }
+
+        if (!connection.commit()) {
+            qWarning() << "Error committing the push schema migration. ERROR: " << connection.lastError().text();
+            connection.rollback();
+            return false;
+        }
+    }
+
+    if (!prepareStatements()) {
+        return false;
+    }
+
+    m_tableReady = true;
+
     return true;
 }
 
-int PushDAO::add(const Push &push)
+bool PushDAO::prepareStatements()
 {
-    int insertId = -1;
-    QSqlQuery sqlQuery(SQLConnection());
-
     const QString query("INSERT INTO push (seqnum, pushdate, type, pushtime, extension, content, unread)"
                         "VALUES(:seqnum, :pushdate, :type, :pushtime, :extension, :content, :unread)");
 
-    sqlQuery.prepare(query);
+    m_insertQuery = QSqlQuery(SQLConnection());
 
-    sqlQuery.bindValue(":pushdate", push.pushDateAsString());
-    sqlQuery.bindValue(":type", push.contentType());
-    sqlQuery.bindValue(":pushtime", push.pushTime());
-    sqlQuery.bindValue(":extension", push.fileExtension());
-    sqlQuery.bindValue(":content", push.content().toBase64(), QSql::In | QSql::Binary);
-    sqlQuery.bindValue(":unread", push.unread());
-    sqlQuery.exec();
+    if (!m_insertQuery.prepare(query)) {
+        qWarning() << "Error preparing SQL statement: " << query << ". ERROR: " << m_insertQuery.lastError().text();
+        return false;
+    }
+
+    return true;
+}
+
+int PushDAO::schemaVersion()
+{
+    const QString query("PRAGMA user_version;");
+
+    QSqlQuery sqlQuery(query, SQLConnection());
 
     const QSqlError err = sqlQuery.lastError();
 
     if (err.isValid()) {
         qWarning() << "Error executing SQL statement: " << query << ". ERROR: " << err.text();
+        return -1;
+    }
+
+    return sqlQuery.next() ? sqlQuery.value(0).toInt() : 0;
+}
+
+bool PushDAO::migrateBase64Content()
+{
+    QSqlDatabase &connection = SQLConnection();
+
+    const QString selectQuery("SELECT seqnum, content FROM push;");
+    const QString updateQuery("UPDATE push SET content = :content WHERE seqnum = :seqNum;");
+
+    // Runs inside the migration transaction of createPushTable(), so a failure leaves
+    // all the pushes base64-encoded
+    QSqlQuery selectSqlQuery(connection);
+    selectSqlQuery.setForwardOnly(true);
+    selectSqlQuery.exec(selectQuery);
+
+    QSqlQuery updateSqlQuery(connection);
+    updateSqlQuery.prepare(updateQuery);
+
+    QSqlError err = selectSqlQuery.lastError();
+    int count = 0;
+
+    while (!err.isValid() && selectSqlQuery.next()) {
+        updateSqlQuery.bindValue(":content", QByteArray::fromBase64(selectSqlQuery.value(1).toByteArray()), QSql::In | QSql::Binary);
+        updateSqlQuery.bindValue(":seqNum", selectSqlQuery.value(0).toInt());
+        updateSqlQuery.exec();
+
+        err = updateSqlQuery.lastError();
+        ++count;
+    }
+
+    if (err.isValid()) {
+        qWarning() << "Error migrating the push content to raw storage. ERROR: " << err.text();
+        return false;
+    }
+
+    qDebug() << "Migrated the content of" << count << "pushes to raw storage";
+
+    return true;
+}
+
+int PushDAO::add(const Push &push)
+{
+    return insert(push);
+}
+
+bool PushDAO::add(QList<Push> &pushes)
+{
+    QSqlDatabase &connection = SQLConnection();
+
+    // Insert all the pushes in one transaction, so they are written to the disk together
+    connection.transaction();
+
+    for (int i = 0; i < pushes.size(); ++i) {
+        const int insertId = insert(pushes.at(i));
+
+        if (insertId < 0) {
+            connection.rollback();
+            return false;
+        }
+
+        pushes[i].setSeqNum(insertId);
+    }
+
+    if (!connection.commit()) {
+        qWarning() << "Error committing the pushes. ERROR: " << connection.lastError().text();
+        connection.rollback();
+        return false;
+    }
+
+    return true;
+}
+
+int PushDAO::insert(const Push &push)
+{
+    int insertId = -1;
+
+    m_insertQuery.bindValue(":pushdate", push.pushDateAsString());
+    m_insertQuery.bindValue(":type", push.contentType());
+    m_insertQuery.bindValue(":pushtime", push.pushTime());
+    m_insertQuery.bindValue(":extension", push.fileExtension());
+    m_insertQuery.bindValue(":content", push.content(), QSql::In | QSql::Binary);
+    m_insertQuery.bindValue(":unread", push.unread());
+    m_insertQuery.exec();
+
+    const QSqlError err = m_insertQuery.lastError();
+
+    if (err.isValid()) {
+        qWarning() << "Error executing SQL statement: " << m_insertQuery.lastQuery() << ". ERROR: " << err.text();
     } else {
-        if (sqlQuery.lastInsertId().isValid()) {
-            insertId = sqlQuery.lastInsertId().toInt();
+        if (m_insertQuery.lastInsertId().isValid()) {
+            insertId = m_insertQuery.lastInsertId().toInt();
         }
     }
 
@@ -98,6 +245,11 @@ bool PushDAO::removeAll()
 {
     const QString query("DROP TABLE push;");
 
+    m_tableReady = false;
+
+    // The prepared statement refers to the table, so it is released before the table is dropped
+    m_insertQuery = QSqlQuery();
+
     // Execute the query.
     QSqlQuery sqlQuery(query, SQLConnection());
 
@@ -135,13 +287,69 @@ Push PushDAO::push(int pushSeqNum)
     return push;
 }
 
+QByteArray PushDAO::content(int pushSeqNum)
+{
+    QSqlDatabase &connection = SQLConnection();
+
+    // Read the content straight into the returned array with the incremental BLOB I/O
+    // of SQLite, rather than through a result row. seqnum is the rowid of the push table.
+    const QVariant handle = connection.driver()->handle();
+
+    if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+        sqlite3 *database = *static_cast<sqlite3 * const *>(handle.constData());
+        sqlite3_blob *blob = 0;
+
+        if (database && sqlite3_blob_open(database, "main", "push", "content", pushSeqNum, 0, &blob) == SQLITE_OK) {
+            QByteArray content;
+            content.resize(sqlite3_blob_bytes(blob));
+
+            const int result = sqlite3_blob_read(blob, content.data(), content.size(), 0);
+            sqlite3_blob_close(blob);
+
+            if (result == SQLITE_OK) {
+                return content;
+            }
+        }
+    }
+
+    // Fall back to a query, e.g. for a push without content
+    QSqlQuery sqlQuery(connection);
+
+    const QString query("SELECT content FROM push WHERE seqnum = :seqNum;");
+
+    sqlQuery.prepare(query);
+    sqlQuery.bindValue(":seqNum", pushSeqNum);
+    sqlQuery.exec();
+
+    const QSqlError err = sqlQuery.lastError();
+
+    if (err.isValid()) {
+        qWarning() << "Error executing SQL statement: " << query << ". ERROR: " << err.text();
+    } else if (sqlQuery.next()) {
+        return sqlQuery.value(0).toByteArray();
+    }
+
+    return QByteArray();
+}
+
 QVariantList PushDAO::pushes()
 {
     QVariantList data;
+    QSqlQuery sqlQuery(SQLConnection());
 
-    const QString query("SELECT seqnum, pushdate, type, pushtime, extension, content, unread FROM push ORDER BY seqnum desc;");
+    // Only the metadata is loaded for the list, plus the start of the content of text pushes
+    // for their preview. The full content is loaded with content() when a push is opened.
+    const QString query("SELECT seqnum, pushdate, type, pushtime, extension, "
+                        "CASE WHEN type = :type THEN substr(content, 1, :previewLength) END, unread "
+                        "FROM push ORDER BY seqnum desc;");
 
-    QSqlQuery sqlQuery(query, SQLConnection());
+    sqlQuery.prepare(query);
+    sqlQuery.setForwardOnly(true);
+
+    sqlQuery.bindValue(":type", CONTENT_TYPE_TEXT);
+    // One more byte than the preview, so the preview can be cut at a character boundary
+    sqlQuery.bindValue(":previewLength", CONTENT_PREVIEW_LENGTH + 1);
+    sqlQuery.exec();
 
     const QSqlError err = sqlQuery.lastError();
 
@@ -149,7 +357,7 @@ QVariantList PushDAO::pushes()
         qWarning() << "Error executing SQL statement: " << query << ". ERROR: " << err.text();
     } else {
         while (sqlQuery.next()){
-            data.append(retrievePush(sqlQuery).toMap());
+            data.append(retrievePush(sqlQuery).toListItemMap());
         }
     }
 
@@ -158,7 +366,7 @@ QVariantList PushDAO::pushes()
 
 Push PushDAO::retrievePush(const QSqlQuery& sqlQuery)
 {
-    return Push(sqlQuery.value(0).toInt(),QByteArray::fromBase64(sqlQuery.value(5).toByteArray()),
+    return Push(sqlQuery.value(0).toInt(),sqlQuery.value(5).toByteArray(),
             sqlQuery.value(2).toString(),sqlQuery.value(4).toString(), sqlQuery.value(1).toString(),
             sqlQuery.value(3).toString(), sqlQuery.value(6).toBool());
 }
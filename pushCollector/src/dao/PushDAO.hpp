@@ -31,15 +31,27 @@ public:
 
     bool createPushTable();
     int add(const Push &push);
+    bool add(QList<Push> &pushes);
     bool remove(int pushSeqNum);
     bool removeAll();
     Push push(int pushSeqNum);
+    QByteArray content(int pushSeqNum);
     QVariantList pushes();
     bool markAsRead(int pushSeqNum);
     bool markAllAsRead();
 
 private:
     Push retrievePush(const QSqlQuery &sqlQuery);
+    int schemaVersion();
+    bool migrateBase64Content();
+    bool prepareStatements();
+    int insert(const Push &push);
+
+    // Whether the push table was created and migrated by this DAO
+    bool m_tableReady;
+
+    // The insert statement, prepared once when the push table is ready
+    QSqlQuery m_insertQuery;
 };
 
 #endif
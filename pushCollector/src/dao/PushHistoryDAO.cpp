@@ -62,6 +62,38 @@ bool PushHistoryDAO::add(const PushHistoryItem &item)
     return true;
 }
 
+bool PushHistoryDAO::add(const QList<PushHistoryItem> &items)
+{
+    QSqlDatabase &connection = SQLConnection();
+    QSqlQuery sqlQuery(connection);
+
+    const QString query("INSERT INTO pushhistory (itemid) VALUES(:itemid)");
+
+    // One prepared statement and one transaction for all the items
+    connection.transaction();
+
+    sqlQuery.prepare(query);
+
+    QSqlError err = sqlQuery.lastError();
+
+    for (int i = 0; !err.isValid() && i < items.size(); ++i) {
+        sqlQuery.bindValue(":itemid", items.at(i).itemId());
+        sqlQuery.exec();
+
+        err = sqlQuery.lastError();
+    }
+
+    if (err.isValid()) {
+        qWarning() << "Error executing SQL statement: " << query << ". ERROR: " << err.text();
+        connection.rollback();
+        return false;
+    }
+
+    connection.commit();
+
+    return true;
+}
+
 bool PushHistoryDAO::removeOldest()
 {
     const QString query("DELETE FROM pushhistory WHERE rownum = (SELECT min(rownum) FROM pushhistory);");
@@ -79,6 +111,27 @@ bool PushHistoryDAO::removeOldest()
     return true;
 }
 
+bool PushHistoryDAO::removeAllButNewest(int count)
+{
+    QSqlQuery sqlQuery(SQLConnection());
+
+    const QString query("DELETE FROM pushhistory WHERE rownum NOT IN (SELECT rownum FROM pushhistory ORDER BY rownum DESC LIMIT :count);");
+
+    sqlQuery.prepare(query);
+
+    sqlQuery.bindValue(":count", count);
+    sqlQuery.exec();
+
+    const QSqlError err = sqlQuery.lastError();
+
+    if (err.isValid()) {
+        qWarning() << "Error executing SQL statement: " << query << ". ERROR: " << err.text();
+        return false;
+    }
+
+    return true;
+}
+
 bool PushHistoryDAO::removeAll()
 {
     const QString query("DROP TABLE pushhistory;");
@@ -120,6 +173,32 @@ PushHistoryItem PushHistoryDAO::pushHistoryItem(const QString &pushHistoryItemId
     return pushHistoryItem;
 }
 
+QList<PushHistoryItem> PushHistoryDAO::newestPushHistoryItems(int count)
+{
+    QList<PushHistoryItem> pushHistoryItems;
+
+    QSqlQuery sqlQuery(SQLConnection());
+    const QString query("SELECT rownum, itemid FROM pushhistory ORDER BY rownum DESC LIMIT :count;");
+
+    sqlQuery.prepare(query);
+    sqlQuery.setForwardOnly(true);
+
+    sqlQuery.bindValue(":count", count);
+    sqlQuery.exec();
+
+    const QSqlError err = sqlQuery.lastError();
+
+    if (err.isValid()) {
+        qWarning() << "Error executing SQL statement: " << query << ". ERROR: " << err.text();
+    } else {
+        while (sqlQuery.next()) {
+            pushHistoryItems.append(PushHistoryItem(sqlQuery.value(1).toString(), sqlQuery.value(0).toInt()));
+        }
+    }
+
+    return pushHistoryItems;
+}
+
 int PushHistoryDAO::pushHistoryCount()
 {
     int count = -1;
@@ -33,9 +33,12 @@ public:
 
     bool createPushHistoryTable();
     bool add(const PushHistoryItem &item);
+    bool add(const QList<PushHistoryItem> &items);
     bool removeOldest();
+    bool removeAllButNewest(int count);
     bool removeAll();
     PushHistoryItem pushHistoryItem(const QString &pushHistoryItemId);
+    QList<PushHistoryItem> newestPushHistoryItems(int count);
     int pushHistoryCount();
 };
 
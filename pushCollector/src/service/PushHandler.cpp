@@ -18,11 +18,15 @@
 #include <QDebug>
 
 PushHandler::PushHandler()
+    : m_pushHistoryCapacity(PUSH_HISTORY_DEFAULT_CAPACITY)
+    , m_pushHistoryLoaded(false)
 {
 }
 
 PushHandler::~PushHandler()
 {
+    savePendingPushes();
+    flushPushHistory();
 }
 
 bool PushHandler::checkForDuplicate(const PushHistoryItem &pushHistoryItem)
@@ -31,25 +35,78 @@ bool PushHandler::checkForDuplicate(const PushHistoryItem &pushHistoryItem)
         return false;
     }
 
-    if (!m_pushHistoryDAO.createPushHistoryTable()) {
+    if (!loadPushHistory()) {
+        return false;
+    }
+
+    if (m_pushHistoryItemIds.contains(pushHistoryItem.itemId())) {
+        return true;
+    }
+
+    // The id is remembered right away so a redelivery is dropped while the push is queued,
+    // but it is only stored once the push has been saved
+    rememberPushHistoryItem(pushHistoryItem.itemId());
+
+    m_unsavedPushHistoryItems.append(pushHistoryItem);
+
+    return false;
+}
+
+void PushHandler::setPushHistoryCapacity(int capacity)
+{
+    m_pushHistoryCapacity = qMax(1, capacity);
+
+    while (m_pushHistoryOrder.size() > m_pushHistoryCapacity) {
+        m_pushHistoryItemIds.remove(m_pushHistoryOrder.dequeue());
+    }
+}
+
+bool PushHandler::flushPushHistory()
+{
+    if (m_pendingPushHistoryItems.isEmpty()) {
+        return true;
+    }
+
+    if (!m_pushHistoryDAO.add(m_pendingPushHistoryItems)) {
         return false;
     }
 
-    const PushHistoryItem storedPushHistoryItem = m_pushHistoryDAO.pushHistoryItem(pushHistoryItem.itemId());
+    m_pendingPushHistoryItems.clear();
+
+    return m_pushHistoryDAO.removeAllButNewest(m_pushHistoryCapacity);
+}
 
-    if (storedPushHistoryItem.seqNum() > -1) {
+bool PushHandler::loadPushHistory()
+{
+    if (m_pushHistoryLoaded) {
         return true;
     }
 
-    if (!m_pushHistoryDAO.add(pushHistoryItem)) {
+    // The table is only created once, and the stored ids are only read once
+    if (!m_pushHistoryDAO.createPushHistoryTable()) {
         return false;
     }
 
-    if (m_pushHistoryDAO.pushHistoryCount() > 10) {
-        m_pushHistoryDAO.removeOldest();
+    const QList<PushHistoryItem> storedPushHistoryItems = m_pushHistoryDAO.newestPushHistoryItems(m_pushHistoryCapacity);
+
+    // The items are returned newest first
+    for (int i = storedPushHistoryItems.size() - 1; i >= 0; --i) {
+        rememberPushHistoryItem(storedPushHistoryItems.at(i).itemId());
     }
 
-    return false;
+    m_pushHistoryLoaded = true;
+
+    return true;
+}
+
+void PushHandler::rememberPushHistoryItem(const QString &itemId)
+{
+    m_pushHistoryItemIds.insert(itemId);
+    m_pushHistoryOrder.enqueue(itemId);
+
+    if (m_pushHistoryOrder.size() > m_pushHistoryCapacity) {
+        m_pushHistoryItemIds.remove(m_pushHistoryOrder.dequeue());
+    }
 }
 
 int PushHandler::save(const Push &push)
@@ -61,13 +118,57 @@ int PushHandler::save(const Push &push)
     return m_pushDAO.add(push);
 }
 
+void PushHandler::queue(const Push &push)
+{
+    m_pendingPushes.append(push);
+}
+
+int PushHandler::pendingPushCount() const
+{
+    return m_pendingPushes.size();
+}
+
+QList<Push> PushHandler::savePendingPushes()
+{
+    if (m_pendingPushes.isEmpty() || !m_pushDAO.createPushTable()) {
+        return QList<Push>();
+    }
+
+    QList<Push> pushes = m_pendingPushes;
+
+    if (!m_pushDAO.add(pushes)) {
+        return QList<Push>();
+    }
+
+    m_pendingPushes.clear();
+
+    m_pendingPushHistoryItems.append(m_unsavedPushHistoryItems);
+    m_unsavedPushHistoryItems.clear();
+
+    if (m_pendingPushHistoryItems.size() >= PUSH_HISTORY_BATCH_SIZE) {
+        flushPushHistory();
+    }
+
+    return pushes;
+}
+
 Push PushHandler::push(int pushSeqNum)
 {
     return m_pushDAO.push(pushSeqNum);
 }
 
+QByteArray PushHandler::pushContent(int pushSeqNum)
+{
+    return m_pushDAO.content(pushSeqNum);
+}
+
 QVariantList PushHandler::pushes()
 {
+    // The pushes are loaded at startup, so this is where the table is created and the statements are prepared
+    if (!m_pushDAO.createPushTable()) {
+        return QVariantList();
+    }
+
     return m_pushDAO.pushes();
 }
 
@@ -83,6 +184,14 @@ bool PushHandler::removeAll()
 
 bool PushHandler::removeAllPushHistory()
 {
+    m_pendingPushHistoryItems.clear();
+    m_unsavedPushHistoryItems.clear();
+    m_pushHistoryItemIds.clear();
+    m_pushHistoryOrder.clear();
+
+    // The table is dropped, so it has to be created again
+    m_pushHistoryLoaded = false;
+
     return m_pushHistoryDAO.removeAll();
 }
 
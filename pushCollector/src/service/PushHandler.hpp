@@ -20,24 +20,75 @@
 #include "../dao/PushDAO.hpp"
 #include "../dao/PushHistoryDAO.hpp"
 
+#include <QQueue>
+#include <QSet>
+
+// The default number of push item ids remembered to detect duplicate pushes
+#define PUSH_HISTORY_DEFAULT_CAPACITY 1000
+
+// The number of new push item ids collected before they are written to the persistent store
+#define PUSH_HISTORY_BATCH_SIZE 16
+
 class PushHandler
 {
 public:
     PushHandler();
+
+    /*!
+     * Writes the pending push item ids and pushes to the persistent store before the handler goes away
+     */
     virtual ~PushHandler();
 
     /*!
      * Checks if the specified push has already been received
+     *
+     * The check is done against the ids of the most recent pushes, which are kept in memory.
+     * A new id is only written to the persistent store once the queued push it belongs to
+     * has been saved by savePendingPushes(), so a push that is lost before it is saved is
+     * not treated as a duplicate when it is delivered again after a restart. The ids are
+     * written in batches, so the ids of up to PUSH_HISTORY_BATCH_SIZE - 1 pushes are lost
+     * if the app is killed.
      * @param pushHistoryItem
      */
     bool checkForDuplicate(const PushHistoryItem &pushHistoryItem);
 
+    /*!
+     * Sets the number of push item ids remembered to detect duplicate pushes
+     * @param capacity the number of ids, the default is PUSH_HISTORY_DEFAULT_CAPACITY
+     */
+    void setPushHistoryCapacity(int capacity);
+
+    /*!
+     * Writes the push item ids which are not stored yet to the persistent store
+     */
+    bool flushPushHistory();
+
     /*!
      * Saves the specified push to the persistent store
      * @param push the push that will be saved
      */
     int save(const Push &push);
 
+    /*!
+     * Queues the specified push to be saved with the next call to savePendingPushes()
+     * @param push the push that will be saved
+     */
+    void queue(const Push &push);
+
+    /*!
+     * Returns the number of pushes queued to be saved
+     */
+    int pendingPushCount() const;
+
+    /*!
+     * Saves all queued pushes to the persistent store in one transaction
+     *
+     * The pushes stay queued if they could not be saved. Once they are saved, the ids
+     * recorded for them by checkForDuplicate() are added to the push history.
+     * @return the saved pushes with their sequence numbers set
+     */
+    QList<Push> savePendingPushes();
+
     /*!
      * Retrieves the specified push from the persistent store
      * @param pushSeqNum the sequence number of the push that will be retrieved
@@ -45,7 +96,13 @@ public:
     Push push(int pushSeqNum);
 
     /*!
-     * Retrieves all pushes from the persistent store
+     * Retrieves the content of the specified push from the persistent store
+     * @param pushSeqNum the sequence number of the push whose content will be retrieved
+     */
+    QByteArray pushContent(int pushSeqNum);
+
+    /*!
+     * Retrieves all pushes from the persistent store, as list items without the full content
      */
     QVariantList pushes();
 
@@ -77,8 +134,27 @@ public:
     bool markAllAsRead();
 
 private:
+    bool loadPushHistory();
+    void rememberPushHistoryItem(const QString &itemId);
+
     PushDAO m_pushDAO;
     PushHistoryDAO m_pushHistoryDAO;
+
+    // The recent push item ids, as a set for the lookup and as a queue from oldest to newest
+    QSet<QString> m_pushHistoryItemIds;
+    QQueue<QString> m_pushHistoryOrder;
+
+    // The push history items which are not written to the persistent store yet
+    QList<PushHistoryItem> m_pendingPushHistoryItems;
+
+    // The push history items of the pushes which are not saved yet
+    QList<PushHistoryItem> m_unsavedPushHistoryItems;
+
+    // The pushes which are not written to the persistent store yet
+    QList<Push> m_pendingPushes;
+
+    int m_pushHistoryCapacity;
+    bool m_pushHistoryLoaded;
 };
 
 #endif
@@ -22,7 +22,11 @@ using namespace bb::network;
 PushNotificationService::PushNotificationService(QObject *parent)
     : QObject(parent)
     , m_pushService(0)
+    , m_ingestionRetrying(false)
 {
+    m_ingestionTimer.setSingleShot(true);
+    m_ingestionTimer.setInterval(PUSH_INGESTION_WINDOW);
+    connect(&m_ingestionTimer, SIGNAL(timeout()), this, SLOT(saveQueuedPushes()));
 }
 
 void PushNotificationService::createSession()
@@ -164,11 +168,65 @@ int PushNotificationService::savePush(const Push &push)
     return m_pushHandler.save(push);
 }
 
+void PushNotificationService::queuePush(const Push &push, const QString &payloadId, bool ackRequired)
+{
+    m_pushHandler.queue(push);
+
+    if (ackRequired) {
+        m_pendingAcceptIds.append(payloadId);
+    }
+
+    // While a failed save is retried, the retry timer is left to run
+    if (m_pushHandler.pendingPushCount() >= PUSH_INGESTION_BATCH_SIZE && !m_ingestionRetrying) {
+        saveQueuedPushes();
+    } else if (!m_ingestionTimer.isActive()) {
+        m_ingestionTimer.start();
+    }
+}
+
+void PushNotificationService::saveQueuedPushes()
+{
+    m_ingestionTimer.stop();
+
+    if (m_pushHandler.pendingPushCount() == 0) {
+        return;
+    }
+
+    const QList<Push> pushes = m_pushHandler.savePendingPushes();
+
+    if (pushes.isEmpty()) {
+        // The pushes stay queued and are not accepted, retry with twice the previous delay
+        const int delay = m_ingestionRetrying ? qMin(2 * m_ingestionTimer.interval(), PUSH_INGESTION_MAX_RETRY_DELAY)
+                                              : PUSH_INGESTION_WINDOW;
+        qWarning() << "Failed to save" << m_pushHandler.pendingPushCount() << "queued pushes, retrying in" << delay << "ms";
+        m_ingestionRetrying = true;
+        m_ingestionTimer.setInterval(delay);
+        m_ingestionTimer.start();
+        return;
+    }
+
+    m_ingestionRetrying = false;
+    m_ingestionTimer.setInterval(PUSH_INGESTION_WINDOW);
+
+    // Only accept the pushes once they are stored
+    for (int i = 0; i < m_pendingAcceptIds.size(); ++i) {
+        acceptPush(m_pendingAcceptIds.at(i));
+    }
+    m_pendingAcceptIds.clear();
+
+    emit pushesSaved(pushes);
+}
+
 Push PushNotificationService::push(int pushSeqNum)
 {
     return m_pushHandler.push(pushSeqNum);
 }
 
+QByteArray PushNotificationService::pushContent(int pushSeqNum)
+{
+    return m_pushHandler.pushContent(pushSeqNum);
+}
+
 QVariantList PushNotificationService::pushes()
 {
     return m_pushHandler.pushes();
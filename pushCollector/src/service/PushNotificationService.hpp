@@ -26,6 +26,8 @@
 #include <bb/network/PushStatus>
 
 #include <QObject>
+#include <QStringList>
+#include <QTimer>
 #include <QVariantList>
 
 // This needs to match the invoke target specified in bar-descriptor.xml
@@ -36,6 +38,16 @@
 // The Invoke target key when selecting a notification in the BlackBerry Hub
 #define INVOKE_TARGET_KEY_OPEN "com.example.pushCollector.invoke.open"
 
+// The time in milliseconds during which incoming pushes are collected to be saved together
+#define PUSH_INGESTION_WINDOW 50
+
+// The number of queued pushes which are saved right away, without waiting for the end of the window
+#define PUSH_INGESTION_BATCH_SIZE 64
+
+// The longest time in milliseconds to wait before retrying to save queued pushes after a failure,
+// the wait starts at PUSH_INGESTION_WINDOW and is doubled after each failure
+#define PUSH_INGESTION_MAX_RETRY_DELAY 30000
+
 /*!
  * Offers services related to the registering of a user to receive pushes, the
  * handling / processing of pushes, and the unregistering of a user from receiving pushes,
@@ -61,7 +73,9 @@ public:
     void rejectPush(const QString &payloadId);
     bool checkForDuplicatePush(const PushHistoryItem &pushHistoryItem);
     int savePush(const Push &push);
+    void queuePush(const Push &push, const QString &payloadId, bool ackRequired);
     Push push(int pushSeqNum);
+    QByteArray pushContent(int pushSeqNum);
     QVariantList pushes();
     bool removePush(int pushSeqNum);
     bool removeAllPushes();
@@ -70,6 +84,13 @@ public:
     bool markAllPushesAsRead();
     void handleSimChange();
 
+public Q_SLOTS:
+    /*!
+     * Saves the queued pushes in one transaction, accepts the ones which require an
+     * acknowledgement and emits pushesSaved()
+     */
+    void saveQueuedPushes();
+
 Q_SIGNALS:
     void createSessionCompleted(const bb::network::PushStatus &status);
     void createChannelCompleted(const bb::network::PushStatus &status, const QString &token);
@@ -83,6 +104,12 @@ Q_SIGNALS:
     void noPushServiceConnection();
     void allPushesRemoved();
 
+    /*!
+     * Emitted when queued pushes have been saved
+     * @param pushes the saved pushes with their sequence numbers set
+     */
+    void pushesSaved(const QList<Push> &pushes);
+
 private:
     ConfigurationService m_configurationService;
     bb::network::PushService *m_pushService;
@@ -94,6 +121,14 @@ private:
     // this one quietly suppresses the result of the unregister action
     UnregisterService m_simChangeUnregisterService;
     PushHandler m_pushHandler;
+
+    // Coalesces the pushes arriving within PUSH_INGESTION_WINDOW into one transaction,
+    // and retries to save them with a growing delay if that fails
+    QTimer m_ingestionTimer;
+    bool m_ingestionRetrying;
+
+    // The ids of the queued pushes which have to be accepted once they are saved
+    QStringList m_pendingAcceptIds;
 };
 
 #endif
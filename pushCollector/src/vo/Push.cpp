@@ -162,6 +162,33 @@ QVariantMap Push::toMap() const
     return map;
 }
 
+QVariantMap Push::toListItemMap() const
+{
+    QVariantMap map = toMap();
+    map["content"] = contentPreview();
+
+    return map;
+}
+
+QByteArray Push::contentPreview() const
+{
+    if (contentType() != CONTENT_TYPE_TEXT) {
+        return QByteArray();
+    }
+
+    if (m_content.size() <= CONTENT_PREVIEW_LENGTH) {
+        return m_content;
+    }
+
+    // Do not cut a multi-byte character in half, continuation bytes look like 10xxxxxx
+    int length = CONTENT_PREVIEW_LENGTH;
+    while (length > 0 && (m_content.at(length) & 0xC0) == 0x80) {
+        --length;
+    }
+
+    return m_content.left(length);
+}
+
 QString Push::pushContentType(const QString &contentTypeHeaderValue) const
 {
     if (contentTypeHeaderValue.indexOf("image") >= 0) {
@@ -34,6 +34,9 @@
 #define FILE_EXTENSION_GIF  ".gif"
 #define FILE_EXTENSION_PNG  ".png"
 
+// The number of content bytes of a text push shown in the push list
+#define CONTENT_PREVIEW_LENGTH 128
+
 /*!
  * Value object relating to a push.
  */
@@ -66,11 +69,23 @@ public:
 
     QVariantMap toMap() const;
 
+    /*!
+     * Returns the push as an item of the push list. Instead of the full content, the
+     * item only holds a preview of the content of a text push.
+     */
+    QVariantMap toListItemMap() const;
+
+    /*!
+     * Returns the start of the content of a text push, cut at a UTF-8 character boundary,
+     * or an empty array for other pushes.
+     */
+    QByteArray contentPreview() const;
+
 private:
     // The unique id of the push (to identify it in the database)
     int m_seqNum;
 
-    // The content/payload of the push as a base64-encoded string
+    // The content/payload of the push as raw bytes
     QByteArray m_content;
 
     // The content type (i.e. one of "image", "xml", "text")
@@ -6,6 +6,7 @@ device {
         SOURCES +=  $$quote($$BASEDIR/src/common/customsqldatasource.cpp) \
                  $$quote($$BASEDIR/src/common/emailcontroller.cpp) \
                  $$quote($$BASEDIR/src/common/globalsettings.cpp) \
+                 $$quote($$BASEDIR/src/common/imagepipeline.cpp) \
                  $$quote($$BASEDIR/src/main.cpp) \
                  $$quote($$BASEDIR/src/rundgang/audiocontroller.cpp) \
                  $$quote($$BASEDIR/src/rundgang/photocontroller.cpp) \
@@ -14,6 +15,7 @@ device {
         HEADERS +=  $$quote($$BASEDIR/src/common/customsqldatasource.h) \
                  $$quote($$BASEDIR/src/common/emailcontroller.h) \
                  $$quote($$BASEDIR/src/common/globalsettings.h) \
+                 $$quote($$BASEDIR/src/common/imagepipeline.h) \
                  $$quote($$BASEDIR/src/rundgang/audiocontroller.h) \
                  $$quote($$BASEDIR/src/rundgang/photocontroller.h) \
                  $$quote($$BASEDIR/src/rundgangapp.h)
@@ -23,6 +25,7 @@ device {
         SOURCES +=  $$quote($$BASEDIR/src/common/customsqldatasource.cpp) \
                  $$quote($$BASEDIR/src/common/emailcontroller.cpp) \
                  $$quote($$BASEDIR/src/common/globalsettings.cpp) \
+                 $$quote($$BASEDIR/src/common/imagepipeline.cpp) \
                  $$quote($$BASEDIR/src/main.cpp) \
                  $$quote($$BASEDIR/src/rundgang/audiocontroller.cpp) \
                  $$quote($$BASEDIR/src/rundgang/photocontroller.cpp) \
@@ -31,6 +34,7 @@ device {
         HEADERS +=  $$quote($$BASEDIR/src/common/customsqldatasource.h) \
                  $$quote($$BASEDIR/src/common/emailcontroller.h) \
                  $$quote($$BASEDIR/src/common/globalsettings.h) \
+                 $$quote($$BASEDIR/src/common/imagepipeline.h) \
                  $$quote($$BASEDIR/src/rundgang/audiocontroller.h) \
                  $$quote($$BASEDIR/src/rundgang/photocontroller.h) \
                  $$quote($$BASEDIR/src/rundgangapp.h)
@@ -42,6 +46,7 @@ simulator {
         SOURCES +=  $$quote($$BASEDIR/src/common/customsqldatasource.cpp) \
                  $$quote($$BASEDIR/src/common/emailcontroller.cpp) \
                  $$quote($$BASEDIR/src/common/globalsettings.cpp) \
+                 $$quote($$BASEDIR/src/common/imagepipeline.cpp) \
                  $$quote($$BASEDIR/src/main.cpp) \
                  $$quote($$BASEDIR/src/rundgang/audiocontroller.cpp) \
                  $$quote($$BASEDIR/src/rundgang/photocontroller.cpp) \
@@ -50,6 +55,7 @@ simulator {
         HEADERS +=  $$quote($$BASEDIR/src/common/customsqldatasource.h) \
                  $$quote($$BASEDIR/src/common/emailcontroller.h) \
                  $$quote($$BASEDIR/src/common/globalsettings.h) \
+                 $$quote($$BASEDIR/src/common/imagepipeline.h) \
                  $$quote($$BASEDIR/src/rundgang/audiocontroller.h) \
                  $$quote($$BASEDIR/src/rundgang/photocontroller.h) \
                  $$quote($$BASEDIR/src/rundgangapp.h)
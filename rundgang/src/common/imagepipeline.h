@@ -0,0 +1,90 @@
+/* Copyright (c) 2014 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef IMAGEPIPELINE_H_
+#define IMAGEPIPELINE_H_
+
+#include <QtCore/QSize>
+#include <QtCore/QString>
+#include <QtGui/QImage>
+#include <QtGui/QImageReader>
+
+/**
+ * ImagePipeline Description:
+ *
+ * Loads a camera photo rotated and scaled for display or saving.
+ *
+ * The image size and the EXIF orientation are read once, when the pipeline is
+ * created, without decoding the image. When the image is read, a JPEG is scaled
+ * down while it is decoded, so the full size image is never held in memory,
+ * and the rotation is done in one more pass that writes the final image. Images
+ * that can not be scaled while decoding are scaled in that same pass.
+ *
+ * The time and memory used by each stage are written to the debug log.
+ *
+ * This file is shared by the photobomber and rundgang samples
+ * and has to be kept the same in both.
+ */
+class ImagePipeline
+{
+public:
+    /**
+     * Creates a pipeline for the image file, and reads its size and EXIF orientation.
+     *
+     * @param filePath the path to the image file.
+     */
+    explicit ImagePipeline(const QString &filePath);
+
+    /**
+     * The size of the image as it is stored in the file, before any rotation.
+     */
+    QSize size() const;
+
+    /**
+     * The EXIF orientation of the image, 1 if the image has none.
+     */
+    int exifOrientation() const;
+
+    /**
+     * Returns the clockwise rotation in degrees that turns an image with the
+     * given EXIF orientation upright. Mirrored orientations are not rotated.
+     */
+    static int rotationForOrientation(int exifOrientation);
+
+    /**
+     * Decodes the image, scaled and rotated. A null image is returned if the
+     * image could not be read, see errorString().
+     *
+     * @param rotation the clockwise rotation in degrees, a multiple of 90.
+     * @param height the height of the image before it is rotated, the width is
+     *        scaled to keep the aspect ratio. 0 keeps the stored size.
+     */
+    QImage read(int rotation, int height = 0);
+
+    /**
+     * A description of the last error.
+     */
+    QString errorString() const;
+
+private:
+    Q_DISABLE_COPY(ImagePipeline)
+
+    QImageReader m_reader;
+    QSize m_size;
+    int m_exifOrientation;
+    QString m_errorString;
+};
+
+#endif /* IMAGEPIPELINE_H_ */
@@ -13,11 +13,11 @@
  * limitations under the License.
  */
 #include "photocontroller.h"
+#include "imagepipeline.h"
 #include <bb/cascades/DisplayDirection>
 #include <bb/cascades/OrientationSupport>
 #include <bb/cascades/multimedia/CameraSettings>
 #include <bb/device/DisplayInfo>
-#include <libexif/exif-data.h>
 
 using namespace bb::cascades;
 using namespace bb::cascades::multimedia;
@@ -100,18 +100,11 @@ void PhotoController::scaleImage(const QString imageFilePath, const float scaleF
 {
     // If the scaleFactor is one nothing is done, the image is at the correct scale already.
     if(scaleFactor != 1.0) {
-        //Load the image using QImage.
-        QImage originalImage = QImage(imageFilePath);
-
-        if (!originalImage.isNull()) {
-            ExifData *exifData = 0;
-            ExifEntry *exifEntry = 0;
-            int exifOrientation = 1;
-
-            // Create a scaled version of the image.
-            QImage scaledImage = originalImage.scaledToHeight(originalImage.height() * scaleFactor,
-                    Qt::SmoothTransformation);
+        // The pipeline reads the image size and exif data, the image is decoded later
+        // already scaled and rotated.
+        ImagePipeline pipeline(imageFilePath);
 
+        if (pipeline.size().isValid()) {
             // Since the image will loose its exif data when its opened in a QImage
             // it has to be manually rotated according to the exif in the image and device
             // orientation, this since the Camera control will not store the device orientation.
@@ -119,35 +112,19 @@ void PhotoController::scaleImage(const QString imageFilePath, const float scaleF
             // is taken, so we can assume this is the actual orientation.
             DisplayDirection::Type displayDirection = OrientationSupport::instance()->displayDirection();
 
-            // The exif data from the image at the imageFilePath.
-            exifData = exif_data_new_from_file(imageFilePath.toLatin1().data());
-
-            // Locate the orientation exif information.
-            if (exifData != NULL) {
-                for (int i = 0; i < EXIF_IFD_COUNT; i++) {
-                    exifEntry = exif_content_get_entry(exifData->ifd[i], EXIF_TAG_ORIENTATION);
-
-                    // If the entry corresponds to the orientation it will be a non zero pointer.
-                    if (exifEntry) {
-                        exifOrientation = exif_get_short(exifEntry->data, exif_data_get_byte_order(exifData));
-                        break;
-                    }
-                }
-            }
-
-            // A transform will be used to rotate the image according to device and exif orientation.
-            QTransform transform;
+            // The rotation in degrees to apply according to device and exif orientation.
+            int rotation = 0;
 
             // It's a bit tricky to get the correct orientation of the image. A combination of
             // the way the the device is oriented and what the actual exif data says has to be used
             // in order to rotate it in the correct way.
-            if(exifOrientation == 6) {
+            if(pipeline.exifOrientation() == 6) {
                 switch (displayDirection ) {
                     case DisplayDirection::North:
-                        transform.rotate(displayDirection + 90);
+                        rotation += displayDirection + 90;
                         break;
                     case DisplayDirection::West:
-                        transform.rotate(displayDirection - 90);
+                        rotation += displayDirection - 90;
                         break;
                     default:
                         // Do nothing for the other rotations
@@ -155,14 +132,14 @@ void PhotoController::scaleImage(const QString imageFilePath, const float scaleF
                 }
             } else {
                 // First rotate the image according to the display direction
-                transform.rotate(displayDirection);
+                rotation += displayDirection;
 
                 switch (displayDirection ) {
                     case DisplayDirection::East:
-                        transform.rotate(displayDirection + 90);
+                        rotation += displayDirection + 90;
                         break;
                     case DisplayDirection::West:
-                        transform.rotate(displayDirection - 90);
+                        rotation += displayDirection - 90;
                         break;
                     default:
                         // Do nothing for the other rotations
@@ -170,10 +147,10 @@ void PhotoController::scaleImage(const QString imageFilePath, const float scaleF
                 }
             }
 
-            // Perform the rotation of the image before its saved.
-            scaledImage = scaledImage.transformed(transform);
+            // Decode the scaled version of the image and rotate it before its saved.
+            const QImage scaledImage = pipeline.read(rotation, pipeline.size().height() * scaleFactor);
 
-            if (!scaledImage.save(imageFilePath)) {
+            if (scaledImage.isNull() || !scaledImage.save(imageFilePath)) {
                 qWarning() << "PhotoController::scaleImage: Failed to save image to path " << imageFilePath;
             }
         } else {
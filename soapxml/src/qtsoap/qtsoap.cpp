@@ -39,6 +39,9 @@
 
 #include "qtsoap.h"
 #include <QtCore/QSet>
+#include <QtCore/QThreadStorage>
+#include <QtCore/QVector>
+#include <QtCore/QXmlStreamReader>
 #include <QtNetwork/QNetworkRequest>
 #include <QtNetwork/QNetworkReply>
 
@@ -123,6 +126,9 @@ namespace {
     return tagName;
     }
 
+    // shared by every new QtSoapType instead of one string allocation each
+    Q_GLOBAL_STATIC_WITH_ARGS(QString, unknownErrorString, (QLatin1String("Unknown error")))
+
     QString prefix(const QString &tagName)
     {
     int pos;
@@ -301,6 +307,12 @@ bool operator <(const QtSoapQName &s1, const QtSoapQName &s2)
     by name. If the names are unknown, QtSoapStructIterator lets you
     iterate through all the items.
 
+    Structs with many items build a hash index of the item names on
+    the first lookup by name, so that looking up every item of a wide
+    struct does not scan the struct once per item. Items keep the
+    order in which they were inserted. Renaming an item in place
+    after a lookup is not seen by the index; insert it again instead.
+
     \code
     QtSoapType &helloItem = myStruct["Hello"];
     \endcode
@@ -473,9 +485,10 @@ bool operator <(const QtSoapQName &s1, const QtSoapQName &s2)
     Constructs a QtSoapType.
 */
 QtSoapType::QtSoapType()
+    : smartRef(0)
 {
     t = Other;
-    errorStr = "Unknown error";
+    errorStr = *unknownErrorString();
 }
 
 /*!
@@ -484,9 +497,9 @@ QtSoapType::QtSoapType()
     subclasses.
 */
 QtSoapType::QtSoapType(const QtSoapQName &name, Type type)
-    : t(type), n(name)
+    : t(type), n(name), smartRef(0)
 {
-    errorStr = "Unknown error";
+    errorStr = *unknownErrorString();
 }
 
 /*!
@@ -494,7 +507,7 @@ QtSoapType::QtSoapType(const QtSoapQName &name, Type type)
 */
 QtSoapType::QtSoapType(const QtSoapType &copy)
     : t(copy.t), errorStr(copy.errorStr), i(copy.i),
-      n(copy.n), u(copy.u), h(copy.h)
+      n(copy.n), u(copy.u), h(copy.h), smartRef(0)
 {
 }
 
@@ -1681,7 +1694,7 @@ bool QtSoapArrayIterator::operator == (const QtSoapArrayIterator &j) const
     Constructs an empty QtSoapStruct.
 */
 QtSoapStruct::QtSoapStruct()
-    : QtSoapType(QtSoapQName(), Struct)
+    : QtSoapType(QtSoapQName(), Struct), indexedCount(-1)
 {
 }
 
@@ -1690,7 +1703,7 @@ QtSoapStruct::QtSoapStruct()
     name) to \a name.
 */
 QtSoapStruct::QtSoapStruct(const QtSoapQName &name)
-    : QtSoapType(name, Struct)
+    : QtSoapType(name, Struct), indexedCount(-1)
 {
 }
 
@@ -1698,7 +1711,7 @@ QtSoapStruct::QtSoapStruct(const QtSoapQName &name)
     Constructs a QtSoapStruct that is a copy of \a copy.
 */
 QtSoapStruct::QtSoapStruct(const QtSoapStruct &copy)
-    : QtSoapType(copy)
+    : QtSoapType(copy), indexedCount(-1)
 {
     *this = copy;
 }
@@ -1716,6 +1729,7 @@ QtSoapStruct::~QtSoapStruct()
 void QtSoapStruct::clear()
 {
     dict.clear();
+    indexedCount = -1;
 }
 
 /*!
@@ -1733,6 +1747,9 @@ QtSoapStruct &QtSoapStruct::operator =(const QtSoapStruct &copy)
     h = copy.h;
     i = copy.i;
     dict = copy.dict;
+    nameIndex = copy.nameIndex;
+    qnameIndex = copy.qnameIndex;
+    indexedCount = copy.indexedCount;
 
     return *this;
 }
@@ -1784,6 +1801,7 @@ bool QtSoapStruct::parse(QDomNode node)
     QDomNodeList children = e.childNodes();
     int c = children.count();
     dict.clear();
+    indexedCount = -1;
 
     for (int i = 0; i < c; ++i) {
     QDomNode n = children.item(i);
@@ -1910,14 +1928,11 @@ QtSoapType &QtSoapStruct::at(const QtSoapQName &key)
 {
     static QtSoapType NIL;
 
-    QListIterator<QtSmartPtr<QtSoapType> > it(dict);
-    while (it.hasNext()) {
-        QtSoapType *ret = it.next().ptr();
-        if (ret->name() == key)
-            return *ret;
-    }
+    int pos = indexOf(key);
+    if (pos < 0)
+        return NIL;
 
-    return NIL;
+    return *dict[pos].ptr();
 }
 
 /*!
@@ -1931,11 +1946,73 @@ const QtSoapType &QtSoapStruct::at(const QtSoapQName &key) const
 {
     static QtSoapType NIL;
 
-    for (QtSoapStructIterator i(*const_cast<QtSoapStruct *>(this)); i.current(); ++i)
-    if (i.key() == key)
-        return *i.current();
+    int pos = indexOf(key);
+    if (pos < 0)
+        return NIL;
 
-    return NIL;
+    return *dict[pos].ptr();
+}
+
+// structs with fewer items are scanned; hashing their names costs more
+static const int QTSOAPSTRUCT_INDEX_THRESHOLD = 8;
+
+/*! \internal
+
+    Returns the position of the first item whose QName matches \a
+    key, the way operator==() compares QNames, or -1 if there is none.
+*/
+int QtSoapStruct::indexOf(const QtSoapQName &key) const
+{
+    if (dict.count() < QTSOAPSTRUCT_INDEX_THRESHOLD) {
+    for (int pos = 0; pos < dict.count(); ++pos) {
+        if (dict.at(pos)->name() == key)
+        return pos;
+    }
+    return -1;
+    }
+
+    // items appended through dict directly change the count
+    if (indexedCount != dict.count())
+    buildIndex();
+
+    QString name = key.name().toLower();
+    for (int attempt = 0; attempt < 2; ++attempt) {
+    int pos = key.uri() == ""
+          ? nameIndex.value(name, -1)
+          : qnameIndex.value(name + QLatin1Char(' ') + key.uri().toLower(), -1);
+    if (pos < 0 || dict.at(pos)->name() == key)
+        return pos;
+
+    // an item was replaced or renamed since the index was built
+    buildIndex();
+    }
+    return -1;
+}
+
+/*! \internal
+
+    Indexes the items by lower case name, and by lower case name and
+    URI. Only the first item with a given key is indexed, which is the
+    one a linear scan would find.
+*/
+void QtSoapStruct::buildIndex() const
+{
+    nameIndex.clear();
+    qnameIndex.clear();
+    nameIndex.reserve(dict.count());
+    qnameIndex.reserve(dict.count());
+
+    for (int pos = 0; pos < dict.count(); ++pos) {
+    QtSoapQName itemName = dict.at(pos)->name();
+    QString name = itemName.name().toLower();
+    if (!nameIndex.contains(name))
+        nameIndex.insert(name, pos);
+
+    QString qname = name + QLatin1Char(' ') + itemName.uri().toLower();
+    if (!qnameIndex.contains(qname))
+        qnameIndex.insert(qname, pos);
+    }
+    indexedCount = dict.count();
 }
 
 /*!
@@ -2146,6 +2223,22 @@ bool QtSoapSimpleType::parse(QDomNode node)
     QDomAttr typeattr = e.attributeNode("type");
     QString type = typeattr.isNull() ? QString("string") : localName(typeattr.value()).toLower();
 
+    if (!parseValue(type, e.text(), e.tagName()))
+    return false;
+
+    setName(QtSoapQName(localName(e.tagName()), e.namespaceURI()));
+    return true;
+}
+
+/*! \internal
+
+    Sets the type of this QtSoapSimpleType from the lower case local
+    type name \a type and converts \a text to the value. \a tagName
+    is only used in the error string. Returns false if \a text is not
+    valid for the type.
+*/
+bool QtSoapSimpleType::parseValue(const QString &type, const QString &text, const QString &tagName)
+{
     t = QtSoapType::nameToType(type);
     switch (t) {
     case Duration:
@@ -2172,13 +2265,13 @@ bool QtSoapSimpleType::parse(QDomNode node)
     case ID:
     case IDREF:
     case ENTITY:
-    v = QVariant(e.text());
+    v = QVariant(text);
     break;
     case Float:
-    v = QVariant(e.text().toFloat());
+    v = QVariant(text.toFloat());
     break;
     case Double:
-    v = QVariant(e.text().toDouble());
+    v = QVariant(text.toDouble());
     break;
     case Decimal:
     case Integer:
@@ -2194,16 +2287,16 @@ bool QtSoapSimpleType::parse(QDomNode node)
     case UnsignedInt:
     case UnsignedShort:
     case UnsignedByte:
-    if (e.text() == "" || (e.text() != "" && (e.text()[0].isNumber() || e.text()[0] == '-')))
-        v = QVariant(e.text().toInt());
+    if (text == "" || (text != "" && (text[0].isNumber() || text[0] == '-')))
+        v = QVariant(text.toInt());
     else {
-        errorStr = "Type error at element \"" + e.tagName() + "\"";
+        errorStr = "Type error at element \"" + tagName + "\"";
         return false;
     }
 
     break;
     case Boolean: {
-    QString val = e.text().trimmed().toLower();
+    QString val = text.trimmed().toLower();
     if (val == "false")
         v = QVariant(false);
     else if (val == "true")
@@ -2211,11 +2304,10 @@ bool QtSoapSimpleType::parse(QDomNode node)
     }
     break;
     default:
-    v = e.text();
+    v = text;
     break;
     }
 
-    setName(QtSoapQName(localName(e.tagName()), e.namespaceURI()));
     return true;
 }
 
@@ -2252,6 +2344,521 @@ QVariant QtSoapSimpleType::value() const
     return v;
 }
 
+/*! \internal
+    \class QtSoapArena
+
+    \brief The QtSoapArena class owns the QtSoapType items parsed into
+    a QtSoapMessage.
+
+    Items are constructed with placement new in blocks which grow from
+    4 KB to 256 KB, so a large response needs a few dozen allocations
+    for its items instead of one per item. An arena item is marked with
+    the ArenaOwned reference count, so QtSmartPtr, QtSoapStruct and
+    QtSoapArray never delete it. When the arena is destroyed, the
+    destructors of all its items run in one pass, in the order the
+    items were created, and the blocks are freed.
+
+    Copies of a message share its arena. Items of a parsed message
+    must not be kept, for example in a copied QtSoapStruct, after the
+    message and all its copies are gone.
+*/
+
+struct QtSoapArena::Block
+{
+    Block *next;
+};
+
+struct QtSoapArena::Node
+{
+    Node *next;
+    QtSoapType *item;
+};
+
+// the alignment of every allocation, enough for the members of any item
+static const size_t ArenaAlignment = 8;
+static const size_t ArenaFirstBlockSize = 4096;
+static const size_t ArenaMaxBlockSize = 256 * 1024;
+
+static inline size_t arenaAligned(size_t size)
+{
+    return (size + ArenaAlignment - 1) & ~(ArenaAlignment - 1);
+}
+
+struct QtSoapArenaSlot
+{
+    QtSoapArenaSlot() : arena(0) {}
+    QtSoapArena *arena;
+};
+
+static QThreadStorage<QtSoapArenaSlot *> currentArenas;
+
+/*! \internal
+
+    Constructs an empty arena. No memory is allocated until the first
+    item is created.
+*/
+QtSoapArena::QtSoapArena()
+    : blocks(0), pos(0), end(0), nextBlockSize(ArenaFirstBlockSize),
+      first(0), last(0), items(0), blockTotal(0)
+{
+}
+
+/*! \internal
+
+    Destroys all the items and frees the blocks. The items are
+    destroyed in the order they were created, so a struct or an array
+    goes before the items it holds, and the QtSmartPtrs it releases
+    only read the reference count of items which still exist.
+*/
+QtSoapArena::~QtSoapArena()
+{
+    for (Node *node = first; node; node = node->next)
+        node->item->~QtSoapType();
+
+    while (blocks) {
+    Block *next = blocks->next;
+    qFree(blocks);
+    blocks = next;
+    }
+}
+
+/*! \internal
+
+    Returns the number of items created in this arena.
+*/
+int QtSoapArena::itemCount() const
+{
+    return items;
+}
+
+/*! \internal
+
+    Returns the number of blocks allocated by this arena.
+*/
+int QtSoapArena::blockCount() const
+{
+    return blockTotal;
+}
+
+/*! \internal
+
+    Returns the arena which QtSoapTypeConstructor creates items in on
+    the calling thread, or 0 if items are created on the heap.
+*/
+QtSoapArena *QtSoapArena::current()
+{
+    return currentArenas.hasLocalData() ? currentArenas.localData()->arena : 0;
+}
+
+/*! \internal
+
+    Makes \a arena the arena that items are created in on the calling
+    thread; 0 creates them on the heap again.
+*/
+void QtSoapArena::setCurrent(QtSoapArena *arena)
+{
+    if (!currentArenas.hasLocalData())
+    currentArenas.setLocalData(new QtSoapArenaSlot());
+    currentArenas.localData()->arena = arena;
+}
+
+void *QtSoapArena::allocate(size_t size)
+{
+    size = arenaAligned(size);
+    if (size_t(end - pos) < size) {
+    const size_t header = arenaAligned(sizeof(Block));
+    const size_t blockSize = qMax(nextBlockSize, header + size);
+    Block *block = static_cast<Block *>(qMalloc(blockSize));
+    Q_CHECK_PTR(block);
+    block->next = blocks;
+    blocks = block;
+    pos = reinterpret_cast<char *>(block) + header;
+    end = reinterpret_cast<char *>(block) + blockSize;
+    nextBlockSize = qMin(nextBlockSize * 2, ArenaMaxBlockSize);
+    ++blockTotal;
+    }
+
+    void *memory = pos;
+    pos += size;
+    return memory;
+}
+
+void QtSoapArena::adopt(QtSoapType *item)
+{
+    item->smartRef = ArenaOwned;
+
+    Node *node = new (allocate(sizeof(Node))) Node;
+    node->next = 0;
+    node->item = item;
+    if (last)
+    last->next = node;
+    else
+    first = node;
+    last = node;
+    ++items;
+}
+
+// Makes items created by QtSoapTypeConstructor go to an arena while in scope
+class QtSoapArenaScope
+{
+public:
+    inline QtSoapArenaScope(QtSoapArena *arena)
+    : previous(QtSoapArena::current())
+    {
+    QtSoapArena::setCurrent(arena);
+    }
+
+    inline ~QtSoapArenaScope()
+    {
+    QtSoapArena::setCurrent(previous);
+    }
+
+private:
+    QtSoapArena *previous;
+};
+
+/*! \internal
+    \class QtSoapStreamParser
+
+    \brief The QtSoapStreamParser class builds the QtSoapType tree of
+    a SOAP message directly from XML tokens.
+
+    Data is read with QXmlStreamReader and can be added in chunks as
+    it arrives from the network. Structs, arrays and simple types are
+    created as soon as their elements end, using the same rules as
+    QtSoapTypeFactory::soapType(), so no QDomDocument is built and
+    walked a second time.
+
+    Only the built-in types are handled. Types with a registered
+    custom handler, documents which fail to parse or validate, and
+    the few constructs the DOM path treats differently make the
+    parser give up; QtSoapMessage then parses the received data with
+    QDomDocument, which also produces the exact errors and faults.
+*/
+class QtSoapStreamParser
+{
+public:
+    QtSoapStreamParser(QNetworkReply *reply = 0);
+    ~QtSoapStreamParser();
+
+    void addData(const QByteArray &data);
+    bool finish() const;
+    void takeEnvelope(QtSoapStruct *envelope);
+    QtSoapArena *itemArena() const;
+
+    QNetworkReply *reply() const;
+    QByteArray data() const;
+
+private:
+    enum Kind {
+    Undecided,
+    Struct,
+    Array,
+    Simple
+    };
+
+    struct Frame
+    {
+        Frame()
+            : kind(Undecided), item(0), hasType(false), hasPosition(false),
+              position(0), nextPosition(0), sawText(false), sawComment(false)
+        {
+        }
+
+        Kind kind;
+        QtSoapType *item;
+        QString tagName;
+        QtSoapQName name;
+        bool hasType;
+        // the lower case local name of the type attribute
+        QString type;
+        bool hasPosition;
+        int position;
+        int nextPosition;
+        QString text;
+        bool sawText;
+        bool sawComment;
+    };
+
+    void readTokens();
+    void startElement();
+    void endElement();
+    void characters();
+    bool decideComplex(Frame *frame);
+
+    QXmlStreamReader reader;
+    QByteArray buffer;
+    QPointer<QNetworkReply> rep;
+    QVector<Frame> stack;
+    // owns the items, including the root and those of an abandoned parse
+    QExplicitlySharedDataPointer<QtSoapArena> arena;
+    QtSoapStruct *root;
+    bool failed;
+};
+
+/*! \internal
+
+    Constructs a parser for the response data of \a reply.
+*/
+QtSoapStreamParser::QtSoapStreamParser(QNetworkReply *reply)
+    : rep(reply), arena(new QtSoapArena()), root(0), failed(false)
+{
+}
+
+/*! \internal
+
+    Destructs the parser. The types that were not handed over are
+    destroyed with the arena, unless a message has adopted it.
+*/
+QtSoapStreamParser::~QtSoapStreamParser()
+{
+}
+
+/*! \internal
+
+    Adds \a data to the document and builds as much of the message as
+    the data received so far allows. The data is also kept for the
+    QDomDocument fallback.
+*/
+void QtSoapStreamParser::addData(const QByteArray &data)
+{
+    buffer.append(data);
+    if (failed)
+        return;
+
+    reader.addData(data);
+    readTokens();
+}
+
+/*! \internal
+
+    Returns true if a complete envelope was built and it passes the
+    same checks as QtSoapMessage::isValidSoapMessage().
+*/
+bool QtSoapStreamParser::finish() const
+{
+    if (failed || !root || !stack.isEmpty())
+        return false;
+
+    if (root->name().name().toUpper() != "ENVELOPE" || root->name().uri() != SOAPv11_ENVELOPE)
+        return false;
+
+    int body = (root->count() > 0 && (*root)[0].name().name().toUpper() == "HEADER") ? 1 : 0;
+    return body < root->count() && (*root)[body].name().name().toUpper() == "BODY";
+}
+
+/*! \internal
+
+    Moves the content of the parsed envelope into \a envelope, the way
+    QtSoapStruct::parse() would have filled it.
+*/
+void QtSoapStreamParser::takeEnvelope(QtSoapStruct *envelope)
+{
+    envelope->dict = root->dict;
+    envelope->indexedCount = -1;
+    envelope->setName(root->name());
+    root->dict.clear();
+}
+
+/*! \internal
+
+    Returns the arena which owns the types built by this parser. A
+    message which takes the envelope must keep the arena.
+*/
+QtSoapArena *QtSoapStreamParser::itemArena() const
+{
+    return arena.data();
+}
+
+/*! \internal
+
+    Returns the network reply this parser reads, if any.
+*/
+QNetworkReply *QtSoapStreamParser::reply() const
+{
+    return rep;
+}
+
+/*! \internal
+
+    Returns all the data added so far.
+*/
+QByteArray QtSoapStreamParser::data() const
+{
+    return buffer;
+}
+
+void QtSoapStreamParser::readTokens()
+{
+    while (!failed) {
+    switch (reader.readNext()) {
+    case QXmlStreamReader::StartElement:
+        startElement();
+        break;
+    case QXmlStreamReader::EndElement:
+        endElement();
+        break;
+    case QXmlStreamReader::Characters:
+        characters();
+        break;
+    case QXmlStreamReader::Comment:
+        if (!stack.isEmpty()) {
+            stack.last().sawComment = true;
+        } else if (!root) {
+            // a comment before the envelope is left to the QDomDocument
+            // fallback, where isValidSoapMessage() rejects it
+            failed = true;
+        }
+        break;
+    case QXmlStreamReader::EntityReference:
+        // an entity QXmlStreamReader can not resolve
+        failed = true;
+        break;
+    case QXmlStreamReader::Invalid:
+        // without more data the reader stops with PrematureEndOfDocumentError
+        if (reader.error() != QXmlStreamReader::PrematureEndOfDocumentError)
+        failed = true;
+        return;
+    case QXmlStreamReader::EndDocument:
+        return;
+    default:
+        break;
+    }
+    }
+}
+
+void QtSoapStreamParser::startElement()
+{
+    if (!stack.isEmpty()) {
+    Frame &parent = stack.last();
+    if ((parent.kind == Undecided && !decideComplex(&parent)) || parent.kind == Simple) {
+        failed = true;
+        return;
+    }
+    } else if (root) {
+    failed = true;
+    return;
+    }
+
+    Frame frame;
+    frame.tagName = reader.qualifiedName().toString();
+    frame.name = QtSoapQName(reader.name().toString(), reader.namespaceUri().toString());
+
+    // QDomElement::attributeNode() matches the qualified name, so
+    // prefixed type and position attributes are ignored by the DOM
+    // path as well
+    QXmlStreamAttributes attributes = reader.attributes();
+    for (int i = 0; i < attributes.count(); ++i) {
+    const QXmlStreamAttribute &attribute = attributes.at(i);
+    if (attribute.qualifiedName() == QLatin1String("type")) {
+        frame.hasType = true;
+        frame.type = localName(attribute.value().toString()).toLower();
+    } else if (attribute.qualifiedName() == QLatin1String("position")) {
+        frame.hasPosition = true;
+        frame.position = attribute.value().toString().toInt();
+    }
+    }
+
+    if (stack.isEmpty()) {
+    // the envelope is always parsed as a struct
+    frame.kind = Struct;
+    frame.item = arena->create<QtSoapStruct>();
+    } else if (frame.hasType) {
+    const QHash<QString, QtSoapTypeConstructorBase *> &handlers = QtSoapTypeFactory::instance().typeHandlers;
+    QtSoapTypeConstructorBase *constructor = handlers.value(frame.type);
+    if (!constructor) {
+        // decided by the content, like an element without a type
+    } else if (constructor == handlers.value("struct")) {
+        frame.kind = Struct;
+        frame.item = arena->create<QtSoapStruct>();
+    } else if (constructor == handlers.value("array")) {
+        frame.kind = Array;
+        frame.item = arena->create<QtSoapArray>();
+    } else if (constructor == handlers.value("string")) {
+        frame.kind = Simple;
+    } else {
+        // a custom handler needs the QDomNode
+        failed = true;
+        return;
+    }
+    }
+
+    stack.append(frame);
+}
+
+void QtSoapStreamParser::endElement()
+{
+    Frame frame = stack.last();
+    stack.remove(stack.count() - 1);
+
+    if (frame.kind == Undecided || frame.kind == Simple) {
+    QtSoapSimpleType *simple = arena->create<QtSoapSimpleType>();
+    if (!simple->parseValue(frame.hasType ? frame.type : QString("string"), frame.text, frame.tagName)) {
+        failed = true;
+        return;
+    }
+    frame.item = simple;
+    }
+    frame.item->setName(frame.name);
+
+    if (stack.isEmpty()) {
+    root = static_cast<QtSoapStruct *>(frame.item);
+    return;
+    }
+
+    Frame &parent = stack.last();
+    QtSmartPtr<QtSoapType> item(frame.item);
+    if (parent.kind == Struct) {
+    static_cast<QtSoapStruct *>(parent.item)->dict.append(item);
+    } else {
+    if (frame.hasPosition)
+        parent.nextPosition = frame.position;
+    static_cast<QtSoapArray *>(parent.item)->array.insert(parent.nextPosition, item);
+    ++parent.nextPosition;
+    }
+}
+
+void QtSoapStreamParser::characters()
+{
+    // QDomDocument drops whitespace-only text
+    if (stack.isEmpty() || (reader.isWhitespace() && !reader.isCDATA()))
+    return;
+
+    Frame &frame = stack.last();
+    if (frame.kind == Struct || frame.kind == Array) {
+    failed = true;
+    return;
+    }
+    frame.sawText = true;
+    frame.text += reader.text();
+}
+
+/*! \internal
+
+    Makes \a frame a struct or an array when its first child element
+    starts, using the rules of QtSoapTypeFactory::soapType(). Returns
+    false if the DOM path would have decided on something else.
+*/
+bool QtSoapStreamParser::decideComplex(Frame *frame)
+{
+    // soapType() only looks at the first child node, which is the
+    // text or comment seen before this element
+    if (frame->sawText || frame->sawComment)
+    return false;
+
+    if (frame->name.name().toLower() == "array") {
+    // QtSoapArray::parse() rejects type names other than array
+    if (frame->hasType)
+        return false;
+    frame->kind = Array;
+    frame->item = arena->create<QtSoapArray>();
+    } else {
+    frame->kind = Struct;
+    frame->item = arena->create<QtSoapStruct>();
+    }
+    return true;
+}
+
 /*! \class QtSoapMessage qtsoap.h
     \brief The QtSoapMessage class provides easy access to SOAP
     messages.
@@ -2276,6 +2883,12 @@ QVariant QtSoapSimpleType::value() const
     message. clear() resets all content in the message, creating an
     empty SOAP message.
 
+    The items of a message parsed with setContent() are allocated
+    together and owned by the message; copies of the message share
+    them. Do not keep pointers or shallow copies of those items, such
+    as a copied QtSoapStruct, after the message and its copies are
+    destroyed or cleared.
+
     \code
     QtSoapMessage message;
 
@@ -2356,7 +2969,7 @@ QtSoapMessage::QtSoapMessage()
     Constructs a copy of \a copy.
 */
 QtSoapMessage::QtSoapMessage(const QtSoapMessage &copy)
-    : type(copy.type), envelope(copy.envelope), m(copy.m), margs(copy.margs),
+    : arena(copy.arena), type(copy.type), envelope(copy.envelope), m(copy.m), margs(copy.margs),
       errorStr(copy.errorStr)
 {
     init();
@@ -2391,6 +3004,8 @@ void QtSoapMessage::clear()
     m = QtSoapQName();
     margs.clear();
     errorStr = "Unknown error";
+    // nothing points into the parsed items any more
+    arena = 0;
 }
 
 /*!
@@ -2402,6 +3017,8 @@ QtSoapMessage &QtSoapMessage::operator =(const QtSoapMessage &copy)
     m = copy.m;
     margs = copy.margs;
     errorStr = copy.errorStr;
+    // replaced last, the old items may only be released once nothing points to them
+    arena = copy.arena;
     return *this;
 }
 
@@ -2421,6 +3038,9 @@ bool QtSoapMessage::setContent(QDomDocument &d)
         if (!node.isElement())
             node = node.nextSibling();
 
+    // the items of the envelope are created in the message's arena
+    arena = new QtSoapArena();
+    QtSoapArenaScope scope(arena.data());
     if (envelope.parse(node))
         return true;
     }
@@ -2435,11 +3055,44 @@ bool QtSoapMessage::setContent(QDomDocument &d)
     validates as a SOAP message. Any existing message content is
     replaced.
 
+    The message is built while the document is read, without an
+    intermediate QDomDocument. Documents using custom type handlers
+    are parsed with QDomDocument instead.
+
     If the import fails, this message becomes a Fault message.
 
     Returns true if the import succeeds, otherwise false.
 */
 bool QtSoapMessage::setContent(const QByteArray &buffer)
+{
+    QtSoapStreamParser parser;
+    parser.addData(buffer);
+    return setContent(parser);
+}
+
+/*! \internal
+
+    Imports the envelope built by \a parser. If the parser gave up on
+    the document, the data it received is parsed again with
+    QDomDocument.
+*/
+bool QtSoapMessage::setContent(QtSoapStreamParser &parser)
+{
+    if (parser.finish()) {
+    parser.takeEnvelope(&envelope);
+    arena = parser.itemArena();
+    return true;
+    }
+
+    return setDomContent(parser.data());
+}
+
+/*! \internal
+
+    Parses \a buffer into a QDomDocument and imports it if it
+    validates as a SOAP message.
+*/
+bool QtSoapMessage::setDomContent(const QByteArray &buffer)
 {
     int errorLine, errorColumn;
     QString errorMsg;
@@ -3095,7 +3748,7 @@ QString QtSoapTypeFactory::errorString() const
 */
 
 QtSoapHttpTransport::QtSoapHttpTransport(QObject *parent)
-    : QObject(parent), networkMgr(this)
+    : QObject(parent), networkMgr(this), streamParser(0)
 {
     bool ok = connect(&networkMgr, SIGNAL(finished(QNetworkReply *)),
                       SLOT(readResponse(QNetworkReply *)));
@@ -3108,6 +3761,7 @@ QtSoapHttpTransport::QtSoapHttpTransport(QObject *parent)
 */
 QtSoapHttpTransport::~QtSoapHttpTransport()
 {
+    delete streamParser;
 }
 
 /*!
@@ -3158,6 +3812,11 @@ void QtSoapHttpTransport::submitRequest(QtSoapMessage &request, const QString &p
 
     soapResponse.clear();
     networkRep = networkMgr.post(networkReq, request.toXmlString().toUtf8().constData());
+
+    // build the response while it arrives instead of after the reply has finished
+    delete streamParser;
+    streamParser = new QtSoapStreamParser(networkRep);
+    connect(networkRep, SIGNAL(readyRead()), SLOT(readResponseData()));
 }
 
 
@@ -3211,7 +3870,12 @@ void QtSoapHttpTransport::readResponse(QNetworkReply *reply)
     case QNetworkReply::ContentNotFoundError:
     case QNetworkReply::UnknownContentError:
         {
-            soapResponse.setContent(reply->readAll());
+            if (streamParser && streamParser->reply() == reply) {
+                streamParser->addData(reply->readAll());
+                soapResponse.setContent(*streamParser);
+            } else {
+                soapResponse.setContent(reply->readAll());
+            }
 
             int httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
             if (httpStatus != 200 && httpStatus != 100) {
@@ -3232,12 +3896,28 @@ void QtSoapHttpTransport::readResponse(QNetworkReply *reply)
         break;
     }
 
+    if (streamParser && streamParser->reply() == reply) {
+        delete streamParser;
+        streamParser = 0;
+    }
+
     emit responseReady();
     emit responseReady(soapResponse);
 
     reply->deleteLater();
 }
 
+/*! \internal
+
+    Passes the response data received so far to the stream parser.
+*/
+void QtSoapHttpTransport::readResponseData()
+{
+    QNetworkReply *reply = qobject_cast<QNetworkReply *>(sender());
+    if (reply && streamParser && streamParser->reply() == reply)
+        streamParser->addData(reply->readAll());
+}
+
 /*! \class QtSoapNamespaces qtsoap.h
 
     \brief The QtSoapNamespaces class provides a registry for XML
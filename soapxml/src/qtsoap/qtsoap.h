@@ -47,6 +47,9 @@
 #include <QtCore/QHash>
 #include <QtCore/QLinkedList>
 #include <QtCore/QPointer>
+#include <QtCore/QSharedData>
+
+#include <new>
 
 #if defined(Q_WS_WIN)
 #  if !defined(QT_QTSOAP_EXPORT) && !defined(QT_QTSOAP_IMPORT)
@@ -72,6 +75,10 @@
 #define XML_SCHEMA_INSTANCE "http://www.w3.org/1999/XMLSchema-instance"
 #define XML_NAMESPACE       "http://www.w3.org/XML/1998/namespace"
 
+// The reference count lives in the pointed-to object (T::smartRef), so
+// no counter is allocated next to every item. A negative count marks an
+// object which is never deleted here: -1 for one handed out by
+// releasedPtr(), and QtSoapArena::ArenaOwned for one owned by an arena.
 template <class T>
 class QtSmartPtr
 {
@@ -79,43 +86,32 @@ public:
     inline QtSmartPtr(T *data = 0)
     {
     d = data;
-    r = new int;
-    *r = 1;
+    if (d && d->smartRef >= 0)
+        ++d->smartRef;
     }
 
     inline QtSmartPtr(const QtSmartPtr &copy)
     {
-    if (*copy.r != 0)
-        ++(*copy.r);
-
-    r = copy.r;
     d = copy.d;
+    if (d && d->smartRef >= 0)
+        ++d->smartRef;
     }
 
     inline ~QtSmartPtr()
     {
-        if ((*r) == 0)
-            delete r;
-    else if ((*r) != 0 && --(*r) == 0) {
-        delete r;
-        if (d) delete d;
-    }
+    if (d && d->smartRef > 0 && --d->smartRef == 0)
+        delete d;
     }
 
     inline QtSmartPtr &operator =(const QtSmartPtr &copy)
     {
-    if (*copy.r != 0)
-        ++(*copy.r);
-
-        if ((*r) == 0)
-            delete r;
-    else if ((*r) != 0 && --(*r) == 0) {
-        delete r;
-        if (d) delete d;
-    }
-
-    r = copy.r;
+    T *old = d;
     d = copy.d;
+    if (d && d->smartRef >= 0)
+        ++d->smartRef;
+
+    if (old && old->smartRef > 0 && --old->smartRef == 0)
+        delete old;
     return *this;
     }
 
@@ -141,7 +137,8 @@ public:
 
     inline T *releasedPtr() const
     {
-    (*r) = 0;
+    if (d && d->smartRef >= 0)
+        d->smartRef = -1;
     return d;
     }
 
@@ -151,10 +148,14 @@ public:
     }
 
 private:
-    int *r;
     T *d;
 };
 
+class QtSoapType;
+
+// a single pointer, so QList and QHash can store it inline
+Q_DECLARE_TYPEINFO(QtSmartPtr<QtSoapType>, Q_MOVABLE_TYPE);
+
 class QT_QTSOAP_EXPORT QtSoapQName
 {
 public:
@@ -238,9 +239,78 @@ protected:
     QtSoapQName n;
     QString u;
     QString h;
+
+private:
+    template <class T> friend class QtSmartPtr;
+    friend class QtSoapArena;
+
+    // not copied with the type; see QtSmartPtr
+    mutable int smartRef;
+};
+
+// Owns the QtSoapType items parsed into one QtSoapMessage. The items are
+// constructed in large blocks instead of one allocation each, and they
+// are all destroyed in one pass, followed by freeing the blocks, when the
+// last message sharing the arena is destroyed.
+class QT_QTSOAP_EXPORT QtSoapArena : public QSharedData
+{
+public:
+    enum { ArenaOwned = -2 };
+
+    QtSoapArena();
+    ~QtSoapArena();
+
+    template <class T>
+    inline T *create()
+    {
+    T *item = new (allocate(sizeof(T))) T();
+    adopt(item);
+    return item;
+    }
+
+    int itemCount() const;
+    int blockCount() const;
+
+    // The arena used by createItem() on this thread, if any
+    static QtSoapArena *current();
+    static void setCurrent(QtSoapArena *arena);
+
+    // Creates an item in the current arena, or on the heap if there is none
+    template <class T>
+    static inline T *createItem()
+    {
+    QtSoapArena *arena = current();
+    return arena ? arena->create<T>() : new T();
+    }
+
+    // Deletes a heap item; an arena item is left to its arena
+    static inline void destroyItem(QtSoapType *item)
+    {
+    if (item && item->smartRef != ArenaOwned)
+        delete item;
+    }
+
+private:
+    struct Block;
+    struct Node;
+
+    void *allocate(size_t size);
+    void adopt(QtSoapType *item);
+
+    Block *blocks;
+    char *pos;
+    char *end;
+    size_t nextBlockSize;
+    Node *first;
+    Node *last;
+    int items;
+    int blockTotal;
+
+    Q_DISABLE_COPY(QtSoapArena)
 };
 
 class QtSoapArrayIterator;
+class QtSoapStreamParser;
 
 class QT_QTSOAP_EXPORT QtSoapArray : public QtSoapType
 {
@@ -287,6 +357,7 @@ public:
     QDomElement toDomElement(QDomDocument doc) const;
 
     friend class QtSoapArrayIterator;
+    friend class QtSoapStreamParser;
 
 protected:
     QString arraySizeString() const;
@@ -360,9 +431,18 @@ public:
     QDomElement toDomElement(QDomDocument doc) const;
 
     friend class QtSoapStructIterator;
+    friend class QtSoapStreamParser;
 
 protected:
     QList<QtSmartPtr<QtSoapType> > dict;
+
+private:
+    int indexOf(const QtSoapQName &key) const;
+    void buildIndex() const;
+
+    mutable QHash<QString, int> nameIndex;
+    mutable QHash<QString, int> qnameIndex;
+    mutable int indexedCount;
 };
 
 class QT_QTSOAP_EXPORT QtSoapStructIterator
@@ -408,13 +488,18 @@ public:
 
     QDomElement toDomElement(QDomDocument doc) const;
 
+    friend class QtSoapStreamParser;
+
 protected:
+    bool parseValue(const QString &type, const QString &text, const QString &tagName);
+
     QVariant v;
 };
 
 class QT_QTSOAP_EXPORT QtSoapMessage
 {
     friend class QtSoapHttpServer;
+    friend class QtSoapHttpTransport;
 
 public:
     QtSoapMessage();
@@ -479,6 +564,12 @@ protected:
     void init();
 
 private:
+    bool setContent(QtSoapStreamParser &parser);
+    bool setDomContent(const QByteArray &buffer);
+
+    // the parsed items; declared first so it outlives the structs pointing into it
+    QExplicitlySharedDataPointer<QtSoapArena> arena;
+
     MessageType type;
 
     mutable QtSoapStruct envelope;
@@ -515,12 +606,12 @@ public:
 
     QtSoapType *createObject(QDomNode node)
     {
-    T *t = new T();
+    T *t = QtSoapArena::createItem<T>();
     if (t->parse(node)) {
         return t;
     } else {
         errorStr = t->errorString();
-        delete t;
+        QtSoapArena::destroyItem(t);
         return 0;
     }
     }
@@ -550,6 +641,8 @@ public:
 
     QString errorString() const;
 
+    friend class QtSoapStreamParser;
+
 private:
     mutable QString errorStr;
     QHash<QString, QtSoapTypeConstructorBase *> typeHandlers;
@@ -592,6 +685,7 @@ Q_SIGNALS:
 
 private Q_SLOTS:
     void readResponse(QNetworkReply *reply);
+    void readResponseData();
 
 private:
     QNetworkAccessManager networkMgr;
@@ -599,6 +693,7 @@ private:
     QUrl url;
     QString soapAction;
     QtSoapMessage soapResponse;
+    QtSoapStreamParser *streamParser;
 };
 
 #endif
@@ -85,13 +85,17 @@ config_pri_source_group1 {
     SOURCES += \
         $$quote($$BASEDIR/src/applicationui.cpp) \
         $$quote($$BASEDIR/src/droidlistener.cpp) \
+        $$quote($$BASEDIR/src/droidloadtest.cpp) \
         $$quote($$BASEDIR/src/main.cpp) \
-        $$quote($$BASEDIR/src/xandos.cpp)
+        $$quote($$BASEDIR/src/xandos.cpp) \
+        $$quote($$BASEDIR/src/xandosprotocol.cpp)
 
     HEADERS += \
         $$quote($$BASEDIR/src/applicationui.hpp) \
         $$quote($$BASEDIR/src/droidlistener.hpp) \
-        $$quote($$BASEDIR/src/xandos.hpp)
+        $$quote($$BASEDIR/src/droidloadtest.hpp) \
+        $$quote($$BASEDIR/src/xandos.hpp) \
+        $$quote($$BASEDIR/src/xandosprotocol.hpp)
 }
 
 INCLUDEPATH += $$quote($$BASEDIR/src)
@@ -16,6 +16,7 @@
 #include "applicationui.hpp"
 #include "xandos.hpp"
 #include "droidlistener.hpp"
+#include "droidloadtest.hpp"
 
 #include <bb/cascades/Application>
 #include <bb/cascades/QmlDocument>
@@ -41,9 +42,34 @@ ApplicationUI::ApplicationUI()
     // created the server socket listener
     droidlistener *listener = new droidlistener(this);
 
-    ok = connect(listener, SIGNAL(droidSelection(const QString)), tac, SLOT(droidSelection(const QString)));
+    ok = connect(listener, SIGNAL(droidSelection(int, int)), tac, SLOT(droidSelection(int, int)));
     Q_ASSERT(ok);
-    ok = connect(tac, SIGNAL(sendSelection(const int)), listener, SLOT(readyWrite(const int)));
+    ok = connect(listener, SIGNAL(droidReady(int)), tac, SLOT(droidSessionReady(int)));
+    Q_ASSERT(ok);
+    ok = connect(listener, SIGNAL(droidDisconnected()), tac, SLOT(droidDisconnected()));
+    Q_ASSERT(ok);
+    ok = connect(tac, SIGNAL(sendSelection(int, int)), listener, SLOT(sendSelection(int, int)));
+    Q_ASSERT(ok);
+    ok = connect(tac, SIGNAL(sendReset(int)), listener, SLOT(sendReset(int)));
+    Q_ASSERT(ok);
+    ok = connect(tac, SIGNAL(sendGameOver(int, int)), listener, SLOT(sendGameOver(int, int)));
+    Q_ASSERT(ok);
+
+    // The load test plays its games over the same droid connection, in its own sessions
+    droidloadtest *loadTest = new droidloadtest(this);
+    ok = connect(loadTest, SIGNAL(droidRequired()), tac, SLOT(launchDroid()));
+    Q_ASSERT(ok);
+    ok = connect(listener, SIGNAL(droidSelection(int, int)), loadTest, SLOT(droidSelection(int, int)));
+    Q_ASSERT(ok);
+    ok = connect(listener, SIGNAL(droidReady(int)), loadTest, SLOT(droidReady(int)));
+    Q_ASSERT(ok);
+    ok = connect(listener, SIGNAL(droidGameOver(int)), loadTest, SLOT(droidGameOver(int)));
+    Q_ASSERT(ok);
+    ok = connect(loadTest, SIGNAL(sendSelection(int, int)), listener, SLOT(sendSelection(int, int)));
+    Q_ASSERT(ok);
+    ok = connect(loadTest, SIGNAL(sendReset(int)), listener, SLOT(sendReset(int)));
+    Q_ASSERT(ok);
+    ok = connect(loadTest, SIGNAL(sendGameOver(int, int)), listener, SLOT(sendGameOver(int, int)));
     Q_ASSERT(ok);
     Q_UNUSED(ok);
     // Start listening for connections on the server socket
@@ -56,6 +82,7 @@ ApplicationUI::ApplicationUI()
     // Create root object for the UI
     AbstractPane *root = qml->createRootObject<AbstractPane>();
     qml->setContextProperty("_xandos", tac);
+    qml->setContextProperty("_droidLoadTest", loadTest);
     // Set created root object as the application scene
     Application::instance()->setScene(root);
 }
@@ -21,7 +21,7 @@
 
 //! [0]
 droidlistener::droidlistener(QObject *parent)
-    : QObject(parent), m_port(9876)
+    : QObject(parent), m_port(9876), m_socket(0)
 {
     m_server = new QTcpServer(this);
     // Connect into the signal/slot mechanism to invoke this class method when a new connection
@@ -35,7 +35,6 @@ droidlistener::~droidlistener()
 {
     if (m_socket) {
         disconnected();
-        m_socket->deleteLater();
     }
     m_server->close();
     m_server->deleteLater();
@@ -51,10 +50,16 @@ void droidlistener::listen()
 //! [2]
 void droidlistener::newConnection()
 {
+    if (m_socket) {
+        // only one droid is connected at a time, the newest one is used
+        disconnected();
+    }
     m_socket = m_server->nextPendingConnection();
     if (m_socket->state() == QTcpSocket::ConnectedState) {
         qDebug() << "xandos: New connection established.";
     }
+    // the messages are small and each one is waited for, so do not delay them
+    m_socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
     // Make connections for reveiving disconnect and read ready signals for the
     // new connection socket
     bool ok = connect(m_socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
@@ -62,22 +67,62 @@ void droidlistener::newConnection()
     ok = connect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
     Q_ASSERT(ok);
     Q_UNUSED(ok);
+    // write the messages sent before the droid connected
+    if (!m_pending.isEmpty()) {
+        m_socket->write(m_pending);
+        m_pending.clear();
+    }
 }
 //! [2]
 //! [3]
 void droidlistener::readyRead()
 {
-    QByteArray ba = m_socket->read(20);
-    // Emit the droid selection when finished reading in the
-    // data from the droid client socket
-    Q_EMIT droidSelection(QString(ba));
+    // The data read may hold several messages or only part of one
+    m_reader.append(m_socket->readAll());
+    XandosMessage message;
+    while (m_reader.next(&message)) {
+        switch (message.type) {
+            case XandosMessage::Move:
+                Q_EMIT droidSelection(message.session, message.value);
+                break;
+            case XandosMessage::Ack:
+                Q_EMIT droidReady(message.session);
+                break;
+            case XandosMessage::GameOver:
+                Q_EMIT droidGameOver(message.session);
+                break;
+            default:
+                qDebug() << "xandos: unexpected message type " << message.type;
+                break;
+        }
+    }
+}
+
+void droidlistener::sendSelection(int session, int index)
+{
+    send(XandosMessage(XandosMessage::Move, session, index));
+}
+
+void droidlistener::sendReset(int session)
+{
+    send(XandosMessage(XandosMessage::Reset, session));
+}
+
+void droidlistener::sendGameOver(int session, int winner)
+{
+    send(XandosMessage(XandosMessage::GameOver, session, winner));
 }
 
-void droidlistener::readyWrite(const int code)
+void droidlistener::send(const XandosMessage &message)
 {
     if (m_socket && m_socket->state() == QTcpSocket::ConnectedState) {
-        m_socket->write(QByteArray::number(code));
-        m_socket->flush();
+        // the socket buffers the data and writes it from the event loop,
+        // so the messages sent in one go are written together
+        QByteArray data;
+        message.appendTo(&data);
+        m_socket->write(data);
+    } else {
+        message.appendTo(&m_pending);
     }
 }
 //! [3]
@@ -88,5 +133,9 @@ void droidlistener::disconnected()
     disconnect(m_socket, SIGNAL(disconnected()), this, SLOT(disconnected()));
     disconnect(m_socket, SIGNAL(readyRead()), this, SLOT(readyRead()));
     m_socket->close();
+    m_socket->deleteLater();
+    m_socket = 0;
+    m_reader.clear();
+    Q_EMIT droidDisconnected();
 }
 //! [4]
@@ -17,6 +17,8 @@
 #ifndef DROIDLISTENER_HPP_
 #define DROIDLISTENER_HPP_
 
+#include "xandosprotocol.hpp"
+
 #include <QObject>
 
 class QTcpServer;
@@ -27,6 +29,8 @@ class QTcpSocket;
  * for client connection(s). The client being a the droid
  * in this situation. It serves as a communication line
  * to exchange grid selections between the user and the droid.
+ * The connection is kept across games, and the messages of
+ * several game sessions can be sent over it at the same time.
  */
 //! [0]
 class droidlistener: public QObject
@@ -55,10 +59,13 @@ public Q_SLOTS:
     void readyRead();
 
     /**
-     * This method is used in order to write data out
-     * to the socket.
+     * These methods are used in order to write the messages
+     * of a game session out to the socket. Messages sent before
+     * the droid has connected are written once it connects.
      */
-    void readyWrite(const int code);
+    void sendSelection(int session, int index);
+    void sendReset(int session);
+    void sendGameOver(int session, int winner);
 
     /**
      * This method is invoked when the socket connection disconnects.
@@ -70,14 +77,42 @@ Q_SIGNALS:
      * Signal used to inform the listening parties
      * of the selection made by the droid.
      */
-    void droidSelection(const QString choice);
+    void droidSelection(int session, int index);
+
+    /*
+     * Signal emitted when the droid is ready to play
+     * the game session after it was reset.
+     */
+    void droidReady(int session);
+
+    /*
+     * Signal emitted when the droid has ended a game
+     * session, e.g. since it does not know the session.
+     */
+    void droidGameOver(int session);
+
+    /*
+     * Signal emitted when the droid connection has been
+     * closed, so the droid has to be started again.
+     */
+    void droidDisconnected();
 private:
+    /**
+     * Writes the message to the socket, or keeps it
+     * until the droid connects.
+     */
+    void send(const XandosMessage &message);
+
     // The port used for the server socket
     int m_port;
     //The server socket variable
     QTcpServer *m_server;
     //The socket that is created when a connection with the client is made
     QTcpSocket *m_socket;
+    // Splits the bytes read from the socket into messages
+    XandosMessageReader m_reader;
+    // The messages sent while the droid was not connected
+    QByteArray m_pending;
 };
 //! [0]
 #endif /* DROIDLISTENER_HPP_ */
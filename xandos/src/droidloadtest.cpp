@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "droidloadtest.hpp"
+#include <QDebug>
+
+// All 9 cells selected
+static const quint16 FullBoard = 0x1ff;
+
+// The winning lines {D1,H1,H2,H3,V1,V2,V3,D2} as grid masks
+static const quint16 WinMasks[8] = { 0x111, 0x007, 0x038, 0x1c0, 0x049, 0x092, 0x124, 0x054 };
+
+droidloadtest::droidloadtest(QObject *parent)
+    : QObject(parent)
+    , m_gamesToStart(0)
+    , m_gamesFinished(0)
+    , m_gamesTotal(0)
+{
+}
+
+droidloadtest::~droidloadtest()
+{
+}
+
+//! [0]
+void droidloadtest::start(int sessions, int games)
+{
+    if (!m_games.isEmpty()) {
+        qDebug() << "XandOs: load test already running";
+        return;
+    }
+    qDebug() << "XandOs: load test playing" << games << "games in" << sessions << "sessions";
+    Q_EMIT droidRequired();
+    m_gamesToStart = games;
+    m_gamesFinished = 0;
+    m_gamesTotal = games;
+    m_timer.start();
+    for (int i = 0; i < sessions && m_gamesToStart > 0; i++) {
+        startGame(FirstSession + i);
+    }
+}
+
+void droidloadtest::startGame(int session)
+{
+    if (0 == m_gamesToStart) {
+        return;
+    }
+    m_gamesToStart--;
+    const Game game = { 0, 0 };
+    m_games.insert(session, game);
+    Q_EMIT sendReset(session);
+}
+//! [0]
+//! [1]
+void droidloadtest::droidReady(int session)
+{
+    if (m_games.contains(session)) {
+        // the user always makes the first move
+        play(session);
+    }
+}
+
+void droidloadtest::droidSelection(int session, int index)
+{
+    QHash<int, Game>::iterator game = m_games.find(session);
+    if (game == m_games.end()) {
+        return;
+    }
+    game->droid |= 1 << index;
+    if (isWin(game->droid)) {
+        endGame(session, -1);
+    } else if ((game->user | game->droid) == FullBoard) {
+        endGame(session, -2);
+    } else {
+        play(session);
+    }
+}
+
+void droidloadtest::droidGameOver(int session)
+{
+    if (m_games.contains(session)) {
+        qDebug() << "XandOs: droid ended load test session" << session;
+        finishGame(session);
+    }
+}
+
+void droidloadtest::play(int session)
+{
+    Game &game = m_games[session];
+    const quint16 taken = game.user | game.droid;
+    // pick a random free cell
+    int free = 0;
+    for (int i = 0; i < 9; i++) {
+        if (!(taken & (1 << i))) {
+            free++;
+        }
+    }
+    int choice = qrand() % free;
+    int index = 0;
+    for (; index < 9; index++) {
+        if (!(taken & (1 << index)) && 0 == choice--) {
+            break;
+        }
+    }
+    game.user |= 1 << index;
+    if (isWin(game.user)) {
+        endGame(session, 1);
+    } else if ((game.user | game.droid) == FullBoard) {
+        endGame(session, -2);
+    } else {
+        Q_EMIT sendSelection(session, index);
+    }
+}
+
+void droidloadtest::endGame(int session, int winner)
+{
+    Q_EMIT sendGameOver(session, winner);
+    finishGame(session);
+}
+
+void droidloadtest::finishGame(int session)
+{
+    m_games.remove(session);
+    m_gamesFinished++;
+    if (m_gamesFinished == m_gamesTotal) {
+        const qint64 elapsed = qMax(qint64(1), m_timer.elapsed());
+        qDebug() << "XandOs: load test played" << m_gamesTotal << "games in" << elapsed << "ms,"
+                 << (m_gamesTotal * 1000 / elapsed) << "games per second";
+        Q_EMIT finished(m_gamesTotal, elapsed);
+    } else {
+        // reuse the session for the next game
+        startGame(session);
+    }
+}
+//! [1]
+
+bool droidloadtest::isWin(quint16 board)
+{
+    for (int i = 0; i < 8; i++) {
+        if ((board & WinMasks[i]) == WinMasks[i]) {
+            return true;
+        }
+    }
+    return false;
+}
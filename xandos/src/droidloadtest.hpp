@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef DROIDLOADTEST_HPP_
+#define DROIDLOADTEST_HPP_
+
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+
+/**
+ * This class plays many games against the droid at the same
+ * time, each one in its own session over the droid connection,
+ * to measure how many games per second the two processes can
+ * play. The user moves are picked at random.
+ */
+//! [0]
+class droidloadtest: public QObject
+{
+    Q_OBJECT
+public:
+    droidloadtest(QObject *parent = 0);
+    virtual ~droidloadtest();
+
+    /**
+     * Plays the number of games, with up to sessions games
+     * being played at the same time. The session ids used
+     * start at FirstSession, so they do not clash with the
+     * game played in the UI.
+     */
+    Q_INVOKABLE void start(int sessions = 64, int games = 10000);
+
+    static const int FirstSession = 1000;
+
+public Q_SLOTS:
+    /**
+     * Methods invoked through the signal/slot mechanism
+     * for the messages received from the droid.
+     */
+    void droidSelection(int session, int index);
+    void droidReady(int session);
+    void droidGameOver(int session);
+
+Q_SIGNALS:
+    /**
+     * Signal emitted to make sure the droid is running.
+     */
+    void droidRequired();
+
+    /**
+     * Signals emitting the messages sent to the droid.
+     */
+    void sendSelection(int session, int index);
+    void sendReset(int session);
+    void sendGameOver(int session, int winner);
+
+    /**
+     * Signal emitted when all games have been played.
+     */
+    void finished(int games, int milliseconds);
+
+private:
+    // The grid of a game, as one bit per cell for each player
+    struct Game
+    {
+        quint16 user;
+        quint16 droid;
+    };
+
+    void startGame(int session);
+    void play(int session);
+    void endGame(int session, int winner);
+    void finishGame(int session);
+    static bool isWin(quint16 board);
+
+    // The games being played, by session
+    QHash<int, Game> m_games;
+    int m_gamesToStart;
+    int m_gamesFinished;
+    int m_gamesTotal;
+    QElapsedTimer m_timer;
+};
+//! [0]
+#endif /* DROIDLOADTEST_HPP_ */
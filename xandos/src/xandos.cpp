@@ -38,6 +38,8 @@ xandos::xandos(QObject *parent)
     , m_size(sizeof(m_possibilities) / sizeof(m_possibilities[0]))
     , m_gameMatrix({ 0, 0, 0, 0, 0, 0, 0, 0 })
     , m_invokeManager(new bb::system::InvokeManager(this))
+    , m_session(1)
+    , m_droidStarted(false)
 {
 }
 //! [1]
@@ -61,7 +63,8 @@ void xandos::select(int index, int player, bool send)
         if (0 != m_gameMatrix[i] && m_gameMatrix[i] % 3 == 0) {
             // emit wining signal if any matrix value equals 3
             Q_EMIT won(m_gameMatrix[i] / 3);
-            stopDroid();
+            // the droid keeps running for the next game
+            Q_EMIT sendGameOver(m_session, m_gameMatrix[i] / 3);
             return;
         }
     }
@@ -70,11 +73,11 @@ void xandos::select(int index, int player, bool send)
         // since there is only two players (1,-1) that means -2
         // represents a tie
         Q_EMIT won(-2);
-        stopDroid();
+        Q_EMIT sendGameOver(m_session, -2);
         return;
     }
     if (send) {
-        Q_EMIT sendSelection(index);
+        Q_EMIT sendSelection(m_session, index);
     }
 }
 //! [2]
@@ -92,7 +95,19 @@ void xandos::resetGame()
 //! [3]
 void xandos::startDroid()
 {
+    launchDroid();
+    // the reset is sent once the droid has connected, and the
+    // droid answers it when it is ready to play
+    Q_EMIT sendReset(m_session);
+}
+
+void xandos::launchDroid()
+{
+    if (m_droidStarted) {
+        return;
+    }
     qDebug() << "requesting to start droid";
+    m_droidStarted = true;
     bb::system::InvokeRequest request;
     request.setTarget("com.example.xandos.droid");
     request.setAction("bb.action.START");
@@ -118,24 +133,35 @@ void xandos::stopDroid()
 }
 //! [3]
 //! [4]
-void xandos::droidSelection(const QString choice)
+void xandos::droidSelection(int session, int index)
 {
-    // the first droid choice being a -1 that represents
-    // the droid establishing communication and is in ready state to play
-    if (-1 == choice.toInt()) {
-        qDebug() << "XandOs: emit droid ready";
-        Q_EMIT droidReady();
+    if (session != m_session) {
         return;
     }
     // Find the droid grid choice and set it to 0
+    const QString choice = QString::number(index);
     bb::cascades::ImageView * image = bb::cascades::Application::instance()->findChild<bb::cascades::ImageView*>(choice);
     if (image) {
         image->setImageSource(QUrl("asset:///images/o.png"));
-        select(choice.toInt(), -1, false);
+        select(index, -1, false);
     } else {
         qDebug() << "XandOs: failed to find ImageView: " << choice;
     }
 }
+
+void xandos::droidSessionReady(int session)
+{
+    // the droid has reset the game and is in ready state to play
+    if (session == m_session) {
+        qDebug() << "XandOs: emit droid ready";
+        Q_EMIT droidReady();
+    }
+}
+
+void xandos::droidDisconnected()
+{
+    m_droidStarted = false;
+}
 //! [4]
 
 //! [6]
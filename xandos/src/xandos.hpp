@@ -58,10 +58,17 @@ public Q_SLOTS:
     void resetGame();
 
     /**
-     * Start the droid for playing
+     * Start a new game with the droid, launching the
+     * droid first if it is not running yet
      */
     void startDroid();
 
+    /**
+     * Launch the droid if it is not running yet. The droid
+     * stays connected across games until the app exits.
+     */
+    void launchDroid();
+
     /**
      * Terminate the droid
      */
@@ -71,7 +78,17 @@ public Q_SLOTS:
      * Method invoked by the signal/slot mechanism when
      * the droid has communicated it's selection to us
      */
-    void droidSelection(const QString choice);
+    void droidSelection(int session, int index);
+
+    /**
+     * Method invoked when the droid is ready to play the game session
+     */
+    void droidSessionReady(int session);
+
+    /**
+     * Method invoked when the droid connection has been closed
+     */
+    void droidDisconnected();
 
 Q_SIGNALS:
     /**
@@ -91,7 +108,17 @@ Q_SIGNALS:
      * to the droid, in order to keep in synce both
      * game matrices.
      */
-    void sendSelection(int index);
+    void sendSelection(int session, int index);
+
+    /**
+     * Signal emitted to start a new game with the droid.
+     */
+    void sendReset(int session);
+
+    /**
+     * Signal emitted to tell the droid that the game is over.
+     */
+    void sendGameOver(int session, int winner);
 
 private:
 
@@ -109,6 +136,10 @@ private:
     int m_gameMatrix[8];
     // Invoke manager to start/stop the headless droid
     bb::system::InvokeManager *m_invokeManager;
+    // The session of the game played in the UI
+    int m_session;
+    // Whether the droid has been launched and not disconnected since
+    bool m_droidStarted;
 };
 //! [0]
 #endif /* XANDOS_HPP_ */
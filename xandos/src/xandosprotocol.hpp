@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XANDOSPROTOCOL_HPP_
+#define XANDOSPROTOCOL_HPP_
+
+#include <QByteArray>
+#include <QtGlobal>
+
+/**
+ * A message exchanged between the game UI and the droid.
+ * Every message belongs to a game session, so several games
+ * can be played over the same socket connection.
+ *
+ * On the socket each message is framed as a 16 bit big-endian
+ * length followed by that many bytes: the 8 bit type, the 16 bit
+ * big-endian session id and the 8 bit value. Bytes after the
+ * known fields are skipped, so fields can be added later.
+ *
+ * This file is shared by the xandos and xandosdroid projects
+ * and has to be kept the same in both.
+ */
+//! [0]
+struct XandosMessage
+{
+    enum Type
+    {
+        // A grid selection, the value is the cell index
+        Move = 1,
+        // The droid is ready to play the session after a Reset
+        Ack = 2,
+        // Start a new game in the session
+        Reset = 3,
+        // The game of the session is over, the value is the winner
+        // (1 user, -1 droid, -2 tie, or 0 if the droid does not know
+        // the session) and the session can be freed
+        GameOver = 4
+    };
+
+    XandosMessage(Type type = Move, int session = 0, int value = -1);
+
+    /**
+     * Appends the framed message to data, so several
+     * messages can be written to the socket at once.
+     */
+    void appendTo(QByteArray *data) const;
+
+    Type type;
+    quint16 session;
+    qint8 value;
+};
+//! [0]
+
+/**
+ * Splits the bytes read from the socket into messages. The
+ * bytes may hold several messages or only part of one; the
+ * bytes of an incomplete message are kept until the rest is
+ * appended.
+ */
+//! [1]
+class XandosMessageReader
+{
+public:
+    XandosMessageReader();
+
+    /**
+     * Appends the bytes read from the socket.
+     */
+    void append(const QByteArray &data);
+
+    /**
+     * Takes the next complete message. Returns false
+     * if there is no complete message left.
+     */
+    bool next(XandosMessage *message);
+
+    /**
+     * Drops all buffered bytes, e.g. when the connection is closed.
+     */
+    void clear();
+
+private:
+    QByteArray m_buffer;
+    // The offset of the first unread byte in the buffer
+    int m_position;
+};
+//! [1]
+#endif /* XANDOSPROTOCOL_HPP_ */
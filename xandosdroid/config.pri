@@ -82,11 +82,15 @@ config_pri_source_group1 {
     SOURCES += \
         $$quote($$BASEDIR/src/applicationheadless.cpp) \
         $$quote($$BASEDIR/src/main.cpp) \
-        $$quote($$BASEDIR/src/xandosdroid.cpp)
+        $$quote($$BASEDIR/src/xandosdroid.cpp) \
+        $$quote($$BASEDIR/src/xandosengine.cpp) \
+        $$quote($$BASEDIR/src/xandosprotocol.cpp)
 
     HEADERS += \
         $$quote($$BASEDIR/src/applicationheadless.hpp) \
-        $$quote($$BASEDIR/src/xandosdroid.hpp)
+        $$quote($$BASEDIR/src/xandosdroid.hpp) \
+        $$quote($$BASEDIR/src/xandosengine.hpp) \
+        $$quote($$BASEDIR/src/xandosprotocol.hpp)
 }
 
 INCLUDEPATH += $$quote($$BASEDIR/src)
@@ -22,17 +22,9 @@
 #include <cstdlib>
 #include <time.h>
 
-//! [0]
-// Grid selections with possible winning scenarios
-int xandosdroid::m_possibilities[9][9] = { { 1, 1, 0, 0, 1, 0, 0, 0, 0 }, { 0, 1, 0, 0, 0, 1, 0, 0, 0 }, { 0, 1, 0, 0, 0, 0, 1, 1, 0 },
-                                           { 0, 0, 1, 0, 1, 0, 0, 0, 0 }, { 1, 0, 1, 0, 0, 1, 0, 1, 0 }, { 0, 0, 1, 0, 0, 0, 1, 0, 0 },
-                                           { 0, 0, 0, 1, 1, 0, 0, 1, 0 }, { 0, 0, 0, 1, 0, 1, 0, 0, 0 }, { 1, 0, 0, 1, 0, 0, 1, 0, 0 } };
-//! [0]
 //! [1]
 xandosdroid::xandosdroid()
     : QObject()
-    , m_size(sizeof(m_possibilities) / sizeof(m_possibilities[0]))
-    , m_gameMatrix({ 0, 0, 0, 0, 0, 0, 0, 0 }), m_nextMove(-1)
     , m_port(9876)
     , m_invokeManager(new bb::system::InvokeManager(this))
     , m_clientSocket(new QTcpSocket(this))
@@ -69,7 +61,7 @@ void xandosdroid::onInvoked(const bb::system::InvokeRequest& request)
 {
     if (request.action().compare("bb.action.START") == 0) {
         qDebug() << "XandOsDroid : start requested";
-        // once the headless is started, communicate back to ui that its ready to play
+        // once the headless is started, connect to the ui which then starts a game session
         connectToServer();
     } else if (request.action().compare("bb.action.STOP") == 0) {
         qDebug() << "XandOsDroid: stop requested";
@@ -81,43 +73,59 @@ void xandosdroid::onInvoked(const bb::system::InvokeRequest& request)
 }
 //! [2]
 //! [3]
-void xandosdroid::select(int index, int player)
+void xandosdroid::handleMessage(const XandosMessage &message)
 {
-    if (0 > index || 8 < index) {
-        qDebug() << "XandOsDroid: invalid index -> " << index;
-        return;
-    }
-    // update the grid matrix with the selection
-    m_possibilities[index][8] = 1;
-    for (int i = 0; i < 8; i++) {
-        // update game matrix based on the selection
-        m_gameMatrix[i] += m_possibilities[index][i] * player;
-        // verify if droid has 3 in a row sequences and terminate if so.
-        if (0 != m_gameMatrix[i] && m_gameMatrix[i] % 3 == 0) {
-            qDebug() << "XandOsDroid: droid has won";
-            disconnected();
+    switch (message.type) {
+        case XandosMessage::Reset:
+            // start a new game in the session, and tell the ui that we are ready to play
+            m_sessions[message.session].reset();
+            send(XandosMessage(XandosMessage::Ack, message.session));
+            break;
+        case XandosMessage::Move: {
+            QHash<int, XandosEngine>::iterator engine = m_sessions.find(message.session);
+            if (engine == m_sessions.end()) {
+                qDebug() << "XandOsDroid: move for unknown session " << message.session;
+                send(XandosMessage(XandosMessage::GameOver, message.session, 0));
+                break;
+            }
+            // mark the user selection in the session grid
+            if (!engine->select(message.value, XandosEngine::User)) {
+                qDebug() << "XandOsDroid: invalid index -> " << message.value;
+                send(XandosMessage(XandosMessage::GameOver, message.session, 0));
+                m_sessions.erase(engine);
+                break;
+            }
+            // verify there are still moves available
+            if (engine->isGameOver()) {
+                m_sessions.erase(engine);
+                break;
+            }
+            const int nextM = nextMove(*engine);
+            engine->select(nextM, XandosEngine::Droid);
+            // send your next selection to the UI.
+            send(XandosMessage(XandosMessage::Move, message.session, nextM));
+            if (engine->isGameOver()) {
+                m_sessions.erase(engine);
+            }
+            break;
         }
+        case XandosMessage::GameOver:
+            m_sessions.remove(message.session);
+            break;
+        default:
+            qDebug() << "XandOsDroid: unexpected message type " << message.type;
+            break;
     }
 }
 //! [3]
-//! [4]
-QList<int> xandosdroid::availableChoices(int index)
-{
-    QList<int> choices;
-    for (int i = 0; i < m_size; i++) {
-        // Check the selections, and base the result on the cell index if index is set.
-        if (0 == m_possibilities[i][8] && (index == -1 || 1 == m_possibilities[i][index])) {
-            choices << i;
-        }
-    }
-    return choices;
-}
-//! [4]
 
-void xandosdroid::sendSelection(const int index)
+void xandosdroid::send(const XandosMessage &message)
 {
-    m_nextMove = index;
-    connectToServer();
+    // the socket buffers the data and writes it from the event loop,
+    // so the replies to the messages read in one go are written together
+    QByteArray data;
+    message.appendTo(&data);
+    m_clientSocket->write(data);
 }
 //![5]
 void xandosdroid::connectToServer()
@@ -130,43 +138,24 @@ void xandosdroid::connectToServer()
         ok = connect(m_clientSocket, SIGNAL(readyRead()), this, SLOT(readyRead()));
         Q_ASSERT(ok);
         Q_UNUSED(ok);
-    } else {
-        connected();
     }
 }
 
 void xandosdroid::connected()
 {
-    qWarning() << "XandOsDroid: writing to socket.";
-    m_clientSocket->write(QByteArray::number(m_nextMove));
-    m_clientSocket->flush();
-    select(m_nextMove, -1);
+    qDebug() << "XandOsDroid: connected to server socket.";
+    // the messages are small and each one is waited for, so do not delay them
+    m_clientSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
 }
 
 void xandosdroid::readyRead()
 {
-    QByteArray ba = m_clientSocket->read(20);
-    qDebug() << "XandOsDroid: received move from user: " << ba;
-    const int choice = ba.toInt();
-    // mark the user selection in the grid matrix and update the
-    // game matrix state
-    select(choice, 1);
-    // verify there are still moves available
-    if (availableChoices().isEmpty()) {
-        qDebug() << "XandOsDroid: game over!";
-        disconnected();
-        return;
-    }
-    // Check whether you have any two in a row sequences
-    int nextM = nextMove(-2);
-    // If no, than block the user based on his possible selections for
-    // a consecutive sequence
-    if (-1 == nextM) {
-        nextM = nextMove(1);
+    // The data read may hold several messages or only part of one
+    m_reader.append(m_clientSocket->readAll());
+    XandosMessage message;
+    while (m_reader.next(&message)) {
+        handleMessage(message);
     }
-    qDebug() << "XandOsDroid: droid selection: " << nextM;
-    // send your next selection to the UI.
-    sendSelection(nextM);
 }
 
 void xandosdroid::disconnected()
@@ -176,39 +165,14 @@ void xandosdroid::disconnected()
 }
 //! [5]
 //! [6]
-int xandosdroid::nextMove(int player)
+int xandosdroid::nextMove(XandosEngine &engine)
 {
-    QList<int> moves;
-    bool blockUserWin = false;
-    for (int i = 0; i < 8; i++) {
-        // check for next move based on players
-        // current existing 2 sequences, otherwise
-        // block player's 1 sequence selections.
-        if ((1 * player) == m_gameMatrix[i] && !blockUserWin) {
-            moves << availableChoices(i);
-        } else if ((2 * player) == m_gameMatrix[i]) {
-            if (!blockUserWin) {
-                moves.clear();
-                blockUserWin = true;
-            }
-            moves << availableChoices(i);
-        }
-    }
+    // the moves which win the soonest, or else draw or lose the latest
+    const QList<int> moves = engine.bestMoves(XandosEngine::Droid);
     if (moves.isEmpty()) {
         return -1;
     }
-    // return move based on a random selection of possible next move choices
+    // return move based on a random selection of the equally good moves
     return moves.at(rand() % moves.size());
 }
 //! [6]
-
-void xandosdroid::resetGame()
-{
-    for (int i = 0; i < 9; i++) {
-        m_possibilities[i][8] = 0;
-        if (i < 8) {
-            m_gameMatrix[i] = 0;
-        }
-    }
-    m_nextMove = -1;
-}
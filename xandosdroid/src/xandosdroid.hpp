@@ -17,6 +17,10 @@
 #ifndef XANDOSDROID_HPP_
 #define XANDOSDROID_HPP_
 
+#include "xandosengine.hpp"
+#include "xandosprotocol.hpp"
+
+#include <QHash>
 #include <QObject>
 #include <QtNetwork/QTcpSocket>
 
@@ -30,10 +34,11 @@ namespace bb
 }
 
 /**
- * This class represents the game droid player. Basically
- * containing the same matrices as it's UI counterpart in order
- * to keep the game in-sync. The difference is that this one
- * has logic to choose the next move based on the user selections.
+ * This class represents the game droid player. It keeps
+ * the games in-sync with it's UI counterpart and uses the
+ * XandosEngine to choose the next move based on the user selections.
+ * The connection to the UI is kept across games, and every game
+ * session sent over it has its own engine.
  */
 //! [0]
 class xandosdroid: public QObject
@@ -43,21 +48,13 @@ public:
     xandosdroid();
     virtual ~xandosdroid();
 
-    /**
-     * This method marks the selection based on the player.
-     * When invoked it updates the game matrix based on the
-     * selection and player. Matrix row additions are perfomed
-     * is selection made by user, and row subtraction if made
-     * by droid.
-     */
-    void select(int index, int player);
-
     /**
      * Method containing the logic to dictate
      * the droids next grid selection based on the
-     * current grid state.
+     * current grid state. The move is picked randomly
+     * among the moves with the best score under perfect play.
      */
-    int nextMove(int player);
+    static int nextMove(XandosEngine &engine);
 
 public Q_SLOTS:
     /**
@@ -79,7 +76,8 @@ public Q_SLOTS:
     void connected();
 
     /**
-     * This method is invoked when the socket disconnects.
+     * This method is invoked when the socket disconnects,
+     * that is when the UI has exited.
      */
     void disconnected();
     /**
@@ -88,16 +86,14 @@ public Q_SLOTS:
     void init();
 private:
     /**
-     * Method which returns the choices available
-     * to the droid. The selections can be filtered
-     * based on the cell that you are looking for.
+     * Method to act on a message received from the UI.
      */
-    QList<int> availableChoices(int i = -1);
+    void handleMessage(const XandosMessage &message);
 
     /**
-     * Method to transmit the droid selection back to the UI.
+     * Method to transmit a message back to the UI.
      */
-    void sendSelection(const int index = -1);
+    void send(const XandosMessage &message);
 
     /**
      * Method to establish the socket connection with
@@ -105,19 +101,11 @@ private:
      */
     void connectToServer();
 
-    void resetGame();
-
-    // The grid matrix containing the winning possibilities for each cell
-    static int m_possibilities[9][9];
-
-    // The size of the grid matrix
-    int m_size;
-
-    // The game matrix representing the current game state
-    int m_gameMatrix[8];
+    // The engines holding the state of each game session
+    QHash<int, XandosEngine> m_sessions;
 
-    // place holder for the next move to be sent back to UI
-    int m_nextMove;
+    // Splits the bytes read from the socket into messages
+    XandosMessageReader m_reader;
 
     // The port on which to establish socket connection with server.
     int m_port;
@@ -0,0 +1,317 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "xandosengine.hpp"
+
+// All 9 cells selected
+static const quint16 FullBoard = 0x1ff;
+
+// The board of the player to move when the key is at or above this value
+static const int DroidToMoveKey = 19683;
+
+//! [0]
+// The winning lines {D1,H1,H2,H3,V1,V2,V3,D2} as board masks
+const quint16 XandosEngine::s_winMasks[8] = { 0x111, 0x007, 0x038, 0x1c0, 0x049, 0x092, 0x124, 0x054 };
+
+const int XandosEngine::s_moveOrder[9] = { 4, 0, 2, 6, 8, 1, 3, 5, 7 };
+
+const int XandosEngine::s_keyWeights[9] = { 1, 3, 9, 27, 81, 243, 729, 2187, 6561 };
+
+// Zero initialized, so all entries start out Empty
+XandosEngine::Entry XandosEngine::s_table[XandosEngine::TableSize];
+//! [0]
+
+static int bitCount(quint16 board)
+{
+    int count = 0;
+    for (; board; board &= board - 1) {
+        count++;
+    }
+    return count;
+}
+
+XandosEngine::XandosEngine()
+    : m_nodeCount(0)
+{
+    reset();
+}
+
+void XandosEngine::reset()
+{
+    m_boards[User] = 0;
+    m_boards[Droid] = 0;
+}
+
+bool XandosEngine::select(int index, Player player)
+{
+    if (0 > index || 8 < index || isGameOver()) {
+        return false;
+    }
+    const quint16 cell = 1 << index;
+    if ((m_boards[User] | m_boards[Droid]) & cell) {
+        return false;
+    }
+    m_boards[player] |= cell;
+    return true;
+}
+
+quint16 XandosEngine::board(Player player) const
+{
+    return m_boards[player];
+}
+
+bool XandosEngine::hasWon(Player player) const
+{
+    return isWin(m_boards[player]);
+}
+
+bool XandosEngine::isGameOver() const
+{
+    return isWin(m_boards[User]) || isWin(m_boards[Droid]) || (m_boards[User] | m_boards[Droid]) == FullBoard;
+}
+
+QList<int> XandosEngine::availableChoices() const
+{
+    QList<int> choices;
+    const quint16 taken = m_boards[User] | m_boards[Droid];
+    for (int i = 0; i < 9; i++) {
+        if (!(taken & (1 << i))) {
+            choices << i;
+        }
+    }
+    return choices;
+}
+
+//! [1]
+int XandosEngine::score(Player player)
+{
+    const Player opponent = player == User ? Droid : User;
+    return negamax(m_boards[player], m_boards[opponent], key(player), -WinScore, WinScore);
+}
+
+int XandosEngine::bestMove(Player player)
+{
+    int bestScore;
+    const QList<int> scores = rootScores(player, &bestScore);
+    for (int i = 0; i < 9; i++) {
+        if (scores.at(s_moveOrder[i]) == bestScore) {
+            return s_moveOrder[i];
+        }
+    }
+    return -1;
+}
+
+QList<int> XandosEngine::bestMoves(Player player)
+{
+    int bestScore;
+    const QList<int> scores = rootScores(player, &bestScore);
+    QList<int> moves;
+    for (int i = 0; i < 9; i++) {
+        if (scores.at(i) == bestScore) {
+            moves << i;
+        }
+    }
+    return moves;
+}
+
+/**
+ * Scores every move of the player with a full window, so the
+ * scores are exact and equally good moves can be told apart.
+ * Cells which cannot be selected score below any real move.
+ */
+QList<int> XandosEngine::rootScores(Player player, int *bestScore)
+{
+    QList<int> scores;
+    *bestScore = -WinScore - 1;
+    const Player opponent = player == User ? Droid : User;
+    const quint16 mine = m_boards[player];
+    const quint16 theirs = m_boards[opponent];
+    for (int i = 0; i < 9; i++) {
+        const quint16 cell = 1 << i;
+        if (isGameOver() || ((mine | theirs) & cell)) {
+            scores << -WinScore - 1;
+            continue;
+        }
+        const int childKey = key(opponent) + s_keyWeights[i] * (player == User ? 1 : 2);
+        const int childScore = -negamax(theirs, mine | cell, childKey, -WinScore, WinScore);
+        scores << childScore;
+        *bestScore = qMax(*bestScore, childScore);
+    }
+    return scores;
+}
+
+/**
+ * Returns the score of the position for the player to move,
+ * who owns the mine board. key identifies the position in the
+ * transposition table.
+ */
+int XandosEngine::negamax(quint16 mine, quint16 theirs, int key, int alpha, int beta)
+{
+    m_nodeCount++;
+
+    const quint16 taken = mine | theirs;
+    // the opponent made the last move, so only the opponent can have won
+    if (isWin(theirs)) {
+        return -(1 + 9 - bitCount(taken));
+    }
+    if (taken == FullBoard) {
+        return 0;
+    }
+
+    Entry &entry = s_table[key];
+    if (entry.flag == Exact) {
+        return entry.score;
+    } else if (entry.flag == LowerBound) {
+        alpha = qMax(alpha, int(entry.score));
+    } else if (entry.flag == UpperBound) {
+        beta = qMin(beta, int(entry.score));
+    }
+    if (entry.flag != Empty && alpha >= beta) {
+        return entry.score;
+    }
+
+    const int originalAlpha = alpha;
+    const bool userToMove = key < DroidToMoveKey;
+    // the child key has the cell set for the player to move and the other player to move
+    const int childKey = userToMove ? key + DroidToMoveKey : key - DroidToMoveKey;
+    const int cellValue = userToMove ? 1 : 2;
+
+    int bestScore = -WinScore - 1;
+    int bestMove = -1;
+    // search the best move of an earlier search first, since it most likely cuts off
+    for (int i = -1; i < 9; i++) {
+        const int move = i < 0 ? entry.move - 1 : s_moveOrder[i];
+        if (move < 0 || (i >= 0 && move == entry.move - 1)) {
+            continue;
+        }
+        const quint16 cell = 1 << move;
+        if (taken & cell) {
+            continue;
+        }
+        const int childScore = -negamax(theirs, mine | cell, childKey + s_keyWeights[move] * cellValue, -beta, -alpha);
+        if (childScore > bestScore) {
+            bestScore = childScore;
+            bestMove = move;
+        }
+        alpha = qMax(alpha, childScore);
+        if (alpha >= beta) {
+            break;
+        }
+    }
+
+    entry.score = bestScore;
+    entry.move = bestMove + 1;
+    if (bestScore <= originalAlpha) {
+        entry.flag = UpperBound;
+    } else if (bestScore >= beta) {
+        entry.flag = LowerBound;
+    } else {
+        entry.flag = Exact;
+    }
+    return bestScore;
+}
+//! [1]
+
+//! [2]
+quint64 XandosEngine::perft(int depth, Player player) const
+{
+    const Player opponent = player == User ? Droid : User;
+    return perft(m_boards[player], m_boards[opponent], depth);
+}
+
+quint64 XandosEngine::perft(quint16 mine, quint16 theirs, int depth)
+{
+    if (depth == 0) {
+        return 1;
+    }
+    const quint16 taken = mine | theirs;
+    if (isWin(theirs) || taken == FullBoard) {
+        return 0;
+    }
+    quint64 count = 0;
+    for (int i = 0; i < 9; i++) {
+        const quint16 cell = 1 << i;
+        if (!(taken & cell)) {
+            count += perft(theirs, mine | cell, depth - 1);
+        }
+    }
+    return count;
+}
+
+XandosGameCount XandosEngine::countGames(Player player) const
+{
+    XandosGameCount count;
+    const Player opponent = player == User ? Droid : User;
+    countGames(m_boards[player], m_boards[opponent], player == User, &count);
+    return count;
+}
+
+void XandosEngine::countGames(quint16 mine, quint16 theirs, bool userToMove, XandosGameCount *count)
+{
+    const quint16 taken = mine | theirs;
+    if (isWin(theirs)) {
+        count->games++;
+        if (userToMove) {
+            count->droidWins++;
+        } else {
+            count->userWins++;
+        }
+        return;
+    }
+    if (taken == FullBoard) {
+        count->games++;
+        count->draws++;
+        return;
+    }
+    for (int i = 0; i < 9; i++) {
+        const quint16 cell = 1 << i;
+        if (!(taken & cell)) {
+            countGames(theirs, mine | cell, !userToMove, count);
+        }
+    }
+}
+//! [2]
+
+quint64 XandosEngine::nodeCount() const
+{
+    return m_nodeCount;
+}
+
+bool XandosEngine::isWin(quint16 board)
+{
+    for (int i = 0; i < 8; i++) {
+        if ((board & s_winMasks[i]) == s_winMasks[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Returns the transposition table key of the current grid
+ * with the player to move.
+ */
+int XandosEngine::key(Player player) const
+{
+    int key = player == User ? 0 : DroidToMoveKey;
+    for (int i = 0; i < 9; i++) {
+        if (m_boards[User] & (1 << i)) {
+            key += s_keyWeights[i];
+        } else if (m_boards[Droid] & (1 << i)) {
+            key += 2 * s_keyWeights[i];
+        }
+    }
+    return key;
+}
@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef XANDOSENGINE_HPP_
+#define XANDOSENGINE_HPP_
+
+#include <QList>
+#include <QtGlobal>
+
+/**
+ * The number of games, and how they ended, found when
+ * playing out every possible continuation of a position.
+ */
+struct XandosGameCount
+{
+    XandosGameCount()
+        : games(0)
+        , userWins(0)
+        , droidWins(0)
+        , draws(0)
+    {
+    }
+
+    quint64 games;
+    quint64 userWins;
+    quint64 droidWins;
+    quint64 draws;
+};
+
+/**
+ * This class is the game engine of the droid player. It keeps
+ * the grid as one 9 bit board per player, with bit i set when
+ * the player has selected cell i (cells numbered row by row),
+ * and finds the best move with a negamax search using alpha-beta
+ * pruning and a transposition table.
+ *
+ * The transposition table is shared by all engines, since its
+ * entries do not depend on the game, so an engine per game is
+ * cheap. The engines must all be used from the same thread.
+ *
+ * The engine only depends on QtCore, so it can be used and tested
+ * without the invocation framework.
+ */
+//! [0]
+class XandosEngine
+{
+public:
+    enum Player
+    {
+        User = 0, Droid = 1
+    };
+
+    // The score of a position which is won by the player to move;
+    // quicker wins score higher, up to WinScore.
+    static const int WinScore = 10;
+
+    XandosEngine();
+
+    /**
+     * Clears the grid.
+     */
+    void reset();
+
+    /**
+     * Marks the selection of the cell at index by the player.
+     * Returns false if the index is invalid, the cell is
+     * already selected or the game is over.
+     */
+    bool select(int index, Player player);
+
+    /**
+     * Returns the board of the player.
+     */
+    quint16 board(Player player) const;
+
+    /**
+     * Returns true if the player has 3 in a row.
+     */
+    bool hasWon(Player player) const;
+
+    /**
+     * Returns true if one of the players has won or no cell is left.
+     */
+    bool isGameOver() const;
+
+    /**
+     * Returns the cells which are not selected yet.
+     */
+    QList<int> availableChoices() const;
+
+    /**
+     * Returns the score of the current position for the player
+     * to move, under perfect play from both sides: positive if
+     * the player wins, 0 for a draw and negative if the player loses.
+     */
+    int score(Player player);
+
+    /**
+     * Returns the best move for the player, or -1 if the game is over.
+     * Of the equally good moves the first one in search order is returned.
+     */
+    int bestMove(Player player);
+
+    /**
+     * Returns all the moves for the player which keep the best
+     * score, so a caller can vary its play between games.
+     */
+    QList<int> bestMoves(Player player);
+
+    /**
+     * Returns the number of positions at the given depth below
+     * the current position, with the player to move first.
+     * Games which are over are not continued.
+     */
+    quint64 perft(int depth, Player player) const;
+
+    /**
+     * Plays out every possible continuation of the current
+     * position, with the player to move first.
+     */
+    XandosGameCount countGames(Player player) const;
+
+    /**
+     * Returns the number of positions visited by the searches.
+     */
+    quint64 nodeCount() const;
+
+    /**
+     * Returns true if the board has 3 in a row.
+     */
+    static bool isWin(quint16 board);
+
+private:
+    // A transposition table entry; flag is one of Empty, Exact, LowerBound or UpperBound
+    struct Entry
+    {
+        qint8 score;
+        qint8 flag;
+        qint8 move;
+    };
+
+    enum Flag
+    {
+        Empty = 0, Exact, LowerBound, UpperBound
+    };
+
+    int negamax(quint16 mine, quint16 theirs, int key, int alpha, int beta);
+    QList<int> rootScores(Player player, int *bestScore);
+    int key(Player player) const;
+
+    static quint64 perft(quint16 mine, quint16 theirs, int depth);
+    static void countGames(quint16 mine, quint16 theirs, bool userToMove, XandosGameCount *count);
+
+    // The 8 winning lines as board masks
+    static const quint16 s_winMasks[8];
+
+    // The order in which the cells are searched: center, corners, edges
+    static const int s_moveOrder[9];
+
+    // The powers of 3 used to compute the transposition table key
+    static const int s_keyWeights[9];
+
+    // The size of the transposition table, one entry for every
+    // grid and player to move
+    static const int TableSize = 2 * 19683;
+
+    // The transposition table shared by all engines
+    static Entry s_table[TableSize];
+
+    quint16 m_boards[2];
+    quint64 m_nodeCount;
+};
+//! [0]
+#endif /* XANDOSENGINE_HPP_ */
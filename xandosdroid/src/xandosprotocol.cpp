@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2013 BlackBerry Limited.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include "xandosprotocol.hpp"
+
+// The size of the length prefix
+static const int HeaderSize = 2;
+
+// The size of the type, session and value fields
+static const int BodySize = 4;
+
+XandosMessage::XandosMessage(Type type, int session, int value)
+    : type(type)
+    , session(session)
+    , value(value)
+{
+}
+
+//! [0]
+void XandosMessage::appendTo(QByteArray *data) const
+{
+    char frame[HeaderSize + BodySize];
+    frame[0] = 0;
+    frame[1] = BodySize;
+    frame[2] = type;
+    frame[3] = session >> 8;
+    frame[4] = session & 0xff;
+    frame[5] = value;
+    data->append(frame, sizeof(frame));
+}
+//! [0]
+
+XandosMessageReader::XandosMessageReader()
+    : m_position(0)
+{
+}
+
+void XandosMessageReader::append(const QByteArray &data)
+{
+    // drop the bytes already read before growing the buffer
+    if (m_position > 0) {
+        m_buffer.remove(0, m_position);
+        m_position = 0;
+    }
+    m_buffer.append(data);
+}
+
+//! [1]
+bool XandosMessageReader::next(XandosMessage *message)
+{
+    const uchar *bytes = reinterpret_cast<const uchar*>(m_buffer.constData()) + m_position;
+    const int available = m_buffer.size() - m_position;
+    if (available < HeaderSize) {
+        return false;
+    }
+    const int length = (bytes[0] << 8) | bytes[1];
+    if (available < HeaderSize + length) {
+        // wait for the rest of the message
+        return false;
+    }
+    m_position += HeaderSize + length;
+    if (length < BodySize) {
+        // too short to be a message, skip it
+        return next(message);
+    }
+    message->type = XandosMessage::Type(bytes[2]);
+    message->session = (bytes[3] << 8) | bytes[4];
+    message->value = qint8(bytes[5]);
+    return true;
+}
+//! [1]
+
+void XandosMessageReader::clear()
+{
+    m_buffer.clear();
+    m_position = 0;
+}